@@ -2,6 +2,7 @@
 #define STB_IMAGE_IMPLEMENTATION  
 #include "../Dependencies/stb_image.h"
 #include "Example.h"
+#include <cstdio>
 class CheckerBoardVS: public VertexShader
 {
 public:
@@ -24,9 +25,31 @@ class CheckerBoardPS: public PixelShader
 {
     virtual bool execute(const PSRegisters& varyings, SystemValue& sv)
     {
-        sv.targets[sv.targetIndex] = /*varyings[PSRegisterI::COLOR]*/ tex2D(0).sample(0,varyings[PSRegisterI::TEX_UV0].uv());
+        const auto uv = varyings[PSRegisterI::TEX_UV0].uv();
+        sv.targets[sv.targetIndex] = /*varyings[PSRegisterI::COLOR]*/ tex2D(0).sampleGrad(0, uv, sv.ddx(PSRegisterI::TEX_UV0).uv(), sv.ddy(PSRegisterI::TEX_UV0).uv());
         return true;
     }
+    // pixelһβ
+    virtual uint32_t executeBatch(const PSRegisters* const varyings[PS_BATCH_SIZE], SystemValue sv[PS_BATCH_SIZE], uint32_t mask) override
+    {
+        Vec2 uvs[PS_BATCH_SIZE], ddx[PS_BATCH_SIZE], ddy[PS_BATCH_SIZE];
+        Vec4 colors[PS_BATCH_SIZE];
+        for(uint32_t i = 0; i < PS_BATCH_SIZE; ++i)
+        {
+            if(!(mask & (1u << i)))
+                continue;
+            uvs[i] = (*varyings[i])[PSRegisterI::TEX_UV0].uv();
+            ddx[i] = sv[i].ddx(PSRegisterI::TEX_UV0).uv();
+            ddy[i] = sv[i].ddy(PSRegisterI::TEX_UV0).uv();
+        }
+        tex2D(0).sampleGrad8(0, uvs, ddx, ddy, colors, mask);
+        for(uint32_t i = 0; i < PS_BATCH_SIZE; ++i)
+        {
+            if(mask & (1u << i))
+                sv[i].targets[sv[i].targetIndex] = colors[i];
+        }
+        return mask;
+    }
 };
 class CheckerBoard: public Renderable
 {
@@ -41,7 +64,10 @@ public:
         : Renderable(ex)
         , m_extent(extent)
     {
-        // texture
+        // texture: ֱӳѺ決õ.rltex(ȫmip), ûʱtga決һ
+        if(auto file = TextureFile::open(RLEXAMPLE_CACHE_PATH("CheckerBoard.rltex")))
+            m_texture = std::make_unique<Texture2D>(std::move(file));
+        else
         {
             int width, height, nChannel;
             auto mem = stbi_loadf(RLEXAMPLE_PATH("CheckerBoard.tga"), &width, &height, &nChannel,4);
@@ -56,6 +82,9 @@ public:
             }
             m_texture = std::make_unique<Texture2D>(desc);
             stbi_image_free(mem);
+            // 決ʧܲӰ챾, ֻ´tga
+            if(!TextureFile::save(RLEXAMPLE_CACHE_PATH("CheckerBoard.rltex"), *m_texture))
+                std::fprintf(stderr, "Unable to save %s\n", RLEXAMPLE_CACHE_PATH("CheckerBoard.rltex"));
         }
         //
         InputElement inputElements[] =
@@ -117,7 +146,7 @@ public:
             m_pshader->setInputResource(0, m_texture.get());
             SamplerState ss;
             {
-
+                ss.filter = FilterType::MIN_MAG_MIP_LINEAR;
             }
             m_pshader->setSamplerState(0, ss);
         }
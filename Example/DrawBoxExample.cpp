@@ -13,9 +13,10 @@ private:
         output[PSRegisterI::COLOR] = input[VSRegisterI::COLOR];//vertex color
     }
 };
-class BoxPS: public PixelShader
+class BoxPS: public PixelShaderT<BoxPS>
 {
-    virtual bool execute(const PSRegisters& varyings, SystemValue& sv)
+public:
+    virtual bool execute(const PSRegisters& varyings, SystemValue& sv) override
     {
         sv.targets[sv.targetIndex] = varyings[PSRegisterI::COLOR];
         return true;
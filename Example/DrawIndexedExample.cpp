@@ -8,26 +8,62 @@ public:
     {
     }
 private:
+    virtual void preamble() override
+    {
+        this->uniform(ShaderUniformI::WVP_MATRIX, this->uniform<Mat4>(ShaderUniformI::WORLD_MATRIX) *
+                                                  this->uniform<Mat4>(ShaderUniformI::VIEW_MATRIX)  *
+                                                  this->uniform<Mat4>(ShaderUniformI::PROJECTION_MATRIX));
+        auto scale = this->uniform<Vec4>(ShaderUniformI::SCALE).xyz();
+        this->uniform(ShaderUniformI::NORMAL_MATRIX, this->uniform<Mat4>(ShaderUniformI::WORLD_MATRIX) * Transform::scale(1.0f/scale.x, 1.0f/scale.y, 1.0f/scale.z));
+    }
+public:
+    // Pipeline::draw<VS, PS>ֱ(), Ϊpublic
     virtual void execute(const VSRegisters& input, PSRegisters& output, SystemValue& sv) override
     {
-        auto wvp = this->uniform<Mat4>(ShaderUniformI::WORLD_MATRIX) *   
-                   this->uniform<Mat4>(ShaderUniformI::VIEW_MATRIX)  *
-                   this->uniform<Mat4>(ShaderUniformI::PROJECTION_MATRIX);
-        sv.position = input[VSRegisterI::POSITION] * wvp;
+        sv.position = input[VSRegisterI::POSITION] * this->uniform<Mat4>(ShaderUniformI::WVP_MATRIX);
 
-        auto scale  = this->uniform<Vec4>(ShaderUniformI::SCALE).xyz();
-        auto rot    = this->uniform<Mat4>(ShaderUniformI::WORLD_MATRIX) * Transform::scale(1.0f/scale.x, 1.0f/scale.y, 1.0f/scale.z);
-        auto normWS = Transform::transformVector(input[VSRegisterI::NORMAL].xyz(), rot);
+        auto normWS = Transform::transformVector(input[VSRegisterI::NORMAL].xyz(), this->uniform<Mat4>(ShaderUniformI::NORMAL_MATRIX));
 
         auto light =              this->uniform<Vec4>(ShaderUniformI::LIGHT_INTENSITY).xyz() * 
                       normWS.dot(-this->uniform<Vec4>(ShaderUniformI::LIGHT_DIRECTION).xyz());
 
         output[PSRegisterI::COLOR] = Vec4(light, 1.0f) + Vec4(0.1f, 0.1f, 0.1f, 0.0f);// *input[VSRegisterI::COLOR];
     }
+    // executeͬļ, ÿδSIMD_LANE_COUNTvertex
+    virtual void executeBatch(const VSRegisters* const inputs[VS_BATCH_SIZE], PSRegisters* const outputs[VS_BATCH_SIZE], SystemValue sv[VS_BATCH_SIZE], uint32_t mask) override
+    {
+        const auto&  wvp          = this->uniform<Mat4>(ShaderUniformI::WVP_MATRIX);
+        const auto&  normalMatrix = this->uniform<Mat4>(ShaderUniformI::NORMAL_MATRIX);
+        const Vec3xN intensity    =  this->uniform<Vec4>(ShaderUniformI::LIGHT_INTENSITY).xyz();
+        const Vec3xN lightDir     = -this->uniform<Vec4>(ShaderUniformI::LIGHT_DIRECTION).xyz();
+        for(uint32_t base = 0; base < VS_BATCH_SIZE && (mask >> base); base += SIMD_LANE_COUNT)
+        {
+            // ЧlaneΪ0
+            Vec4xN position(Vec4(0.0f, 0.0f, 0.0f, 0.0f)), normal = position;
+            for(uint32_t i = 0; i < SIMD_LANE_COUNT; ++i)
+            {
+                if(!(mask & (1u << (base + i))))
+                    continue;
+                position.setLane(i, (*inputs[base + i])[VSRegisterI::POSITION]);
+                normal.setLane(i, (*inputs[base + i])[VSRegisterI::NORMAL]);
+            }
+            const auto positionCS = position * wvp;
+            const auto normWS     = (Vec4xN(normal.xyz(), floatN(0.0f)) * normalMatrix).xyz();
+            const auto color      = Vec4xN(intensity * dot(normWS, lightDir), floatN(1.0f)) + Vec4xN(Vec4(0.1f, 0.1f, 0.1f, 0.0f));
+            for(uint32_t i = 0; i < SIMD_LANE_COUNT; ++i)
+            {
+                if(!(mask & (1u << (base + i))))
+                    continue;
+                sv[base + i].position = positionCS.getLane(i);
+                (*outputs[base + i])[PSRegisterI::COLOR] = color.getLane(i);
+            }
+        }
+    }
 };
-class DrawIndexedPS: public PixelShader
+class DrawIndexedPS: public PixelShaderT<DrawIndexedPS>
 {
-    virtual bool execute(const PSRegisters& varyings, SystemValue& sv)
+public:
+    virtual bool execute(const PSRegisters& varyings, SystemValue& sv) override
     {
         sv.targets[sv.targetIndex] = varyings[PSRegisterI::COLOR];
         return true;
@@ -163,7 +199,7 @@ private:
                            Transform::scale(m_scaling, m_scaling, m_scaling)*
                            Transform::translate(0, 0, 0));
 
-        m_pipeline->drawIndexed(m_context, m_indexCount, 0/*indexStart*/, 0/*baseVertexIndex*/);
+        m_pipeline->drawIndexed<DrawIndexedVS, DrawIndexedPS>(m_context, m_indexCount, 0/*indexStart*/, 0/*baseVertexIndex*/);
     }
 
     uint32_t m_indexCount;
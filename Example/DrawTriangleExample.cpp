@@ -13,9 +13,10 @@ private:
         output[PSRegisterI::COLOR] = input[VSRegisterI::COLOR];//vertex color
     }
 };
-class TrianglePS: public PixelShader
+class TrianglePS: public PixelShaderT<TrianglePS>
 {
-    virtual bool execute(const PSRegisters& varyings, SystemValue& sv)
+public:
+    virtual bool execute(const PSRegisters& varyings, SystemValue& sv) override
     {
         sv.targets[sv.targetIndex] = varyings[PSRegisterI::COLOR];
         return true;
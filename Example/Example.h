@@ -5,6 +5,8 @@
 using namespace rl;
 using namespace rlx;
 #define RLEXAMPLE_PATH(fileName) "../../../../Asset/"fileName
+// ʱɵĻ(決.rltex)дĿ¼, Output/Exe/$(Platform)/$(Configuration), дAsset
+#define RLEXAMPLE_CACHE_PATH(fileName) fileName
 struct ShaderUniformI
 {
     enum EnumMat4: uint8_t
@@ -13,6 +15,7 @@ struct ShaderUniformI
         VIEW_MATRIX ,
         PROJECTION_MATRIX ,
         WVP_MATRIX,
+        NORMAL_MATRIX, // world matrixȥ, ڱ任
     };
     enum EnumVec4: uint8_t
     {
@@ -48,23 +48,17 @@ void PresentSurface(Pixelizer* pxlzr, Surface* color)
     const auto nFloats = color->getFormatFloatCount();
     const auto width   = color->getWidth();
     const auto height  = color->getHeight();
-    const auto pitch   = color->getWidth() * color->getFormatFloatCount();
-
-    auto dataptr = color->lock();
+    const auto& kernels = rl::kernels();
+    std::vector<uint32_t> rowPixels(width);
+    auto locked = color->lock(nullptr, LockMode::READ_ONLY);
     for(uint32_t h = 0; h < height; ++h)
     {
+        // 整行打包为0x00RRGGBB
+        kernels.packRGB8(locked.row(h), nFloats, width, rowPixels.data());
         for(uint32_t w = 0; w < width; ++w)
-        {
-            Float* colorData = dataptr + (h * pitch + w*nFloats);
-
-            auto colorVal =
-                (rl::clamp(rl::float2int_fast(colorData[0] * 255.0f), 0, 255) << 16) |  //r
-                (rl::clamp(rl::float2int_fast(colorData[1] * 255.0f), 0, 255) << 8) |   //g
-                (rl::clamp(rl::float2int_fast(colorData[2] * 255.0f), 0, 255));         //b
-            pxlzr->putPixel(w, h, colorVal);
-        }
+            pxlzr->putPixel(w, h, rowPixels[w]);
     }
-    color->unlock();
+    color->unlock(locked);
 }
 class InputSDL: public rlx::Input
 {
@@ -98,6 +92,7 @@ int main(int argc, char* argv[])
     std::cout <<"4: Draw Holographic" << std::endl;
     std::cout <<"5: CheckerBoard" << std::endl;
     std::cout <<"8: Ground" << std::endl;
+    std::cout <<"SIMD kernels: " << rl::simd_level_name(rl::kernels().level) << " (RASLITE_SIMD to override)" << std::endl;
 
     auto example = ExampleCreate(0);
     auto input   = std::make_unique<InputSDL>();
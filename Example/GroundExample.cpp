@@ -7,19 +7,23 @@ public:
     {
     }
 private:
+    virtual void preamble() override
+    {
+        uniform(ShaderUniformI::WVP_MATRIX, uniform<Mat4>(ShaderUniformI::WORLD_MATRIX) *
+                                            uniform<Mat4>(ShaderUniformI::VIEW_MATRIX)  *
+                                            uniform<Mat4>(ShaderUniformI::PROJECTION_MATRIX));
+    }
     virtual void execute(const VSRegisters& input, PSRegisters& output, SystemValue& sv) override
     {
-        auto wvp = uniform<Mat4>(ShaderUniformI::WORLD_MATRIX) *   
-                   uniform<Mat4>(ShaderUniformI::VIEW_MATRIX)  *
-                   uniform<Mat4>(ShaderUniformI::PROJECTION_MATRIX);
-        sv.position = input[VSRegisterI::POSITION] * wvp;
+        sv.position = input[VSRegisterI::POSITION] * uniform<Mat4>(ShaderUniformI::WVP_MATRIX);
 
         output[PSRegisterI::COLOR] = input[VSRegisterI::COLOR];
     }
 };
-class GridPS: public PixelShader
+class GridPS: public PixelShaderT<GridPS>
 {
-    virtual bool execute(const PSRegisters& varyings, SystemValue& sv)
+public:
+    virtual bool execute(const PSRegisters& varyings, SystemValue& sv) override
     {
         sv.targets[sv.targetIndex] = varyings[PSRegisterI::COLOR];
         return true;
@@ -148,19 +152,23 @@ public:
     {
     }
 private:
+    virtual void preamble() override
+    {
+        uniform(ShaderUniformI::WVP_MATRIX, uniform<Mat4>(ShaderUniformI::WORLD_MATRIX) *
+                                            uniform<Mat4>(ShaderUniformI::VIEW_MATRIX)  *
+                                            uniform<Mat4>(ShaderUniformI::PROJECTION_MATRIX));
+    }
     virtual void execute(const VSRegisters& input, PSRegisters& output, SystemValue& sv) override
     {
-        auto wvp = uniform<Mat4>(ShaderUniformI::WORLD_MATRIX) *
-                   uniform<Mat4>(ShaderUniformI::VIEW_MATRIX)  *
-                   uniform<Mat4>(ShaderUniformI::PROJECTION_MATRIX);
-        sv.position = input[VSRegisterI::POSITION] * wvp;
+        sv.position = input[VSRegisterI::POSITION] * uniform<Mat4>(ShaderUniformI::WVP_MATRIX);
 
         output[PSRegisterI::COLOR] = input[VSRegisterI::COLOR];
     }
 };
-class FloorPS: public PixelShader
+class FloorPS: public PixelShaderT<FloorPS>
 {
-    virtual bool execute(const PSRegisters& varyings, SystemValue& sv)
+public:
+    virtual bool execute(const PSRegisters& varyings, SystemValue& sv) override
     {
         sv.targets[sv.targetIndex] = varyings[PSRegisterI::COLOR];
         return true;
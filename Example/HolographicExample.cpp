@@ -4,15 +4,19 @@
 /////////////////////////////////////////////////////////////////////////
 class HolographicVS: public VertexShader
 {
+    virtual void preamble() override
+    {
+        this->uniform(ShaderUniformI::WVP_MATRIX, this->uniform<Mat4>(ShaderUniformI::WORLD_MATRIX) *
+                                                  this->uniform<Mat4>(ShaderUniformI::VIEW_MATRIX)  *
+                                                  this->uniform<Mat4>(ShaderUniformI::PROJECTION_MATRIX));
+        auto scale = this->uniform<Vec4>(ShaderUniformI::SCALE).xyz();
+        this->uniform(ShaderUniformI::NORMAL_MATRIX, this->uniform<Mat4>(ShaderUniformI::WORLD_MATRIX) * Transform::scale(1.0f/scale.x, 1.0f/scale.y, 1.0f/scale.z));
+    }
     virtual void execute(const VSRegisters& input, PSRegisters& output, SystemValue& sv) override
     {
-        auto wvp = this->uniform<Mat4>(ShaderUniformI::WORLD_MATRIX) *   
-                   this->uniform<Mat4>(ShaderUniformI::VIEW_MATRIX)  *
-                   this->uniform<Mat4>(ShaderUniformI::PROJECTION_MATRIX);
-        sv.position = input[VSRegisterI::POSITION] * wvp;
+        sv.position = input[VSRegisterI::POSITION] * this->uniform<Mat4>(ShaderUniformI::WVP_MATRIX);
 
-        auto scale  = this->uniform<Vec4>(ShaderUniformI::SCALE).xyz();
-        auto rot    = this->uniform<Mat4>(ShaderUniformI::WORLD_MATRIX) * Transform::scale(1.0f/scale.x, 1.0f/scale.y, 1.0f/scale.z);
+        auto& rot   = this->uniform<Mat4>(ShaderUniformI::NORMAL_MATRIX);
         // World Normal
         output[PSRegisterI::NORMAL] = Transform::transformVector(input[VSRegisterI::NORMAL].xyz(), rot);
     }
@@ -3,8 +3,13 @@
 
 #include "RasliteMath.h"
 #include "RasliteCommon.h"
+#include "RasliteKernels.h"
 #include "RasliteData.h"
+#include "RasliteBC.h"
+#include "RasliteVirtualTexture.h"
+#include "RasliteTextureFile.h"
 #include "RasliteShader.h"
+#include "RasliteRaster.h"
 #include "RaslitePipeline.h"
 
 #endif //RASTLITE_H
\ No newline at end of file
@@ -0,0 +1,338 @@
+#include "RasliteBC.h"
+#include <cstring>
+
+namespace rl {
+    namespace detail
+    {
+        inline Float unorm8(uint32_t v)
+        {
+            return Float(v) * (Float(1) / Float(255));
+        }
+        // RGB565 -> 8bit
+        inline void unpack565(uint16_t c, uint32_t rgbOut[3])
+        {
+            const uint32_t r = (c >> 11) & 0x1f, g = (c >> 5) & 0x3f, b = c & 0x1f;
+            rgbOut[0] = (r << 3) | (r >> 2);
+            rgbOut[1] = (g << 2) | (g >> 4);
+            rgbOut[2] = (b << 3) | (b >> 2);
+        }
+        inline uint16_t read16(const uint8_t* p)
+        {
+            return uint16_t(p[0] | (p[1] << 8));
+        }
+        inline uint32_t read32(const uint8_t* p)
+        {
+            return uint32_t(p[0]) | (uint32_t(p[1]) << 8) | (uint32_t(p[2]) << 16) | (uint32_t(p[3]) << 24);
+        }
+        // BC1ɫblock; forceFourColor: BC2/BC3еɫblock4ɫģʽ
+        static void decodeColorBlock(const uint8_t* block, bool forceFourColor, Vec4 texelsOut[16])
+        {
+            const auto c0 = read16(block), c1 = read16(block + 2);
+            uint32_t rgb0[3], rgb1[3];
+            unpack565(c0, rgb0);
+            unpack565(c1, rgb1);
+
+            Vec4 palette[4];
+            palette[0] = Vec4(unorm8(rgb0[0]), unorm8(rgb0[1]), unorm8(rgb0[2]), 1);
+            palette[1] = Vec4(unorm8(rgb1[0]), unorm8(rgb1[1]), unorm8(rgb1[2]), 1);
+            if(forceFourColor || c0 > c1)
+            {
+                palette[2] = (palette[0] * 2 + palette[1]) / 3;
+                palette[3] = (palette[0] + palette[1] * 2) / 3;
+            }
+            else
+            {
+                palette[2] = (palette[0] + palette[1]) * Float(0.5);
+                palette[3] = Vec4::zero(); // ͸
+            }
+            const auto indices = read32(block + 4);
+            for(uint32_t i = 0; i < 16; ++i)
+                texelsOut[i] = palette[(indices >> (i * 2)) & 0x3];
+        }
+    }
+    void decode_bc1(const uint8_t* block, Vec4 texelsOut[16])
+    {
+        detail::decodeColorBlock(block, false, texelsOut);
+    }
+    void decode_bc3(const uint8_t* block, Vec4 texelsOut[16])
+    {
+        detail::decodeColorBlock(block + 8, true, texelsOut);
+
+        const uint32_t a0 = block[0], a1 = block[1];
+        Float alphas[8] = { detail::unorm8(a0), detail::unorm8(a1) };
+        if(a0 > a1)
+        {
+            for(uint32_t k = 1; k < 7; ++k)
+                alphas[k + 1] = detail::unorm8(((7 - k) * a0 + k * a1) / 7);
+        }
+        else
+        {
+            for(uint32_t k = 1; k < 5; ++k)
+                alphas[k + 1] = detail::unorm8(((5 - k) * a0 + k * a1) / 5);
+            alphas[6] = Float(0);
+            alphas[7] = Float(1);
+        }
+        // 163bit, 48bit
+        uint64_t indices = 0;
+        for(uint32_t i = 0; i < 6; ++i)
+            indices |= uint64_t(block[2 + i]) << (i * 8);
+        for(uint32_t i = 0; i < 16; ++i)
+            texelsOut[i].a = alphas[(indices >> (i * 3)) & 0x7];
+    }
+    //////////////////////////////////////////////////////////////////////////////////////////
+    // BC7
+    //////////////////////////////////////////////////////////////////////////////////////////
+    namespace detail
+    {
+        struct BC7Mode
+        {
+            uint8_t subsetCount;
+            uint8_t partitionBits;
+            uint8_t rotationBits;
+            uint8_t indexSelectionBits;
+            uint8_t colorBits;
+            uint8_t alphaBits;
+            uint8_t endpointPBits;
+            uint8_t sharedPBits;
+            uint8_t indexBits;
+            uint8_t secondaryIndexBits;
+        };
+        static const BC7Mode BC7_MODES[8] =
+        {
+            { 3, 4, 0, 0, 4, 0, 1, 0, 3, 0 },
+            { 2, 6, 0, 0, 6, 0, 0, 1, 3, 0 },
+            { 3, 6, 0, 0, 5, 0, 0, 0, 2, 0 },
+            { 2, 6, 0, 0, 7, 0, 1, 0, 2, 0 },
+            { 1, 0, 2, 1, 5, 6, 0, 0, 2, 3 },
+            { 1, 0, 2, 0, 7, 8, 0, 0, 2, 2 },
+            { 1, 0, 0, 0, 7, 7, 1, 0, 4, 0 },
+            { 2, 6, 0, 0, 5, 5, 1, 0, 2, 0 },
+        };
+        // ÿtexel 2bit, ʾsubset
+        static const uint32_t BC7_PARTITIONS2[64] =
+        {
+            0x50505050, 0x40404040, 0x54545454, 0x54505040, 0x50404000, 0x55545450, 0x55545040, 0x54504000,
+            0x50400000, 0x55555450, 0x55544000, 0x54400000, 0x55555440, 0x55550000, 0x55555500, 0x55000000,
+            0x55150100, 0x00004054, 0x15010000, 0x00405054, 0x00004050, 0x15050100, 0x05010000, 0x40505054,
+            0x00404050, 0x05010100, 0x14141414, 0x05141450, 0x01155440, 0x00555500, 0x15014054, 0x05414150,
+            0x44444444, 0x55005500, 0x11441144, 0x05055050, 0x05500550, 0x11114444, 0x41144114, 0x44111144,
+            0x15055054, 0x01055040, 0x05041050, 0x05455150, 0x14414114, 0x50050550, 0x41411414, 0x00141400,
+            0x00041504, 0x00105410, 0x10541000, 0x04150400, 0x50410514, 0x41051450, 0x05415014, 0x14054150,
+            0x41050514, 0x41505014, 0x40011554, 0x54150140, 0x50505500, 0x00555050, 0x15151010, 0x54540404
+        };
+        static const uint32_t BC7_PARTITIONS3[64] =
+        {
+            0xAA685050, 0x6A5A5040, 0x5A5A4200, 0x5450A0A8, 0xA5A50000, 0xA0A05050, 0x5555A0A0, 0x5A5A5050,
+            0xAA550000, 0xAA555500, 0xAAAA5500, 0x90909090, 0x94949494, 0xA4A4A4A4, 0xA9A59450, 0x2A0A4250,
+            0xA5945040, 0x0A425054, 0xA5A5A500, 0x55A0A0A0, 0xA8A85454, 0x6A6A4040, 0xA4A45000, 0x1A1A0500,
+            0x0050A4A4, 0xAAA59090, 0x14696914, 0x69691400, 0xA08585A0, 0xAA821414, 0x50A4A450, 0x6A5A0200,
+            0xA9A58000, 0x5090A0A8, 0xA8A09050, 0x24242424, 0x00AA5500, 0x24924924, 0x24499224, 0x50A50A50,
+            0x500AA550, 0xAAAA4444, 0x66660000, 0xA5A0A5A0, 0x50A050A0, 0x69286928, 0x44AAAA44, 0x66666600,
+            0xAA444444, 0x54A854A8, 0x95809580, 0x96969600, 0xA85454A8, 0x80959580, 0xAA141414, 0x96960000,
+            0xAAAA1414, 0xA05050A0, 0xA0A5A5A0, 0x96000000, 0x40804080, 0xA9A8A9A8, 0xAAAAAA44, 0x2A4A5254
+        };
+        // anchor texel: λΪ0
+        static const uint8_t BC7_ANCHORS2_1[64] =
+        {
+            15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15,
+            15,  2,  8,  2,  2,  8,  8, 15,  2,  8,  2,  2,  8,  8,  2,  2,
+            15, 15,  6,  8,  2,  8, 15, 15,  2,  8,  2,  2,  2, 15, 15,  6,
+             6,  2,  6,  8, 15, 15,  2,  2, 15, 15, 15, 15, 15,  2,  2, 15
+        };
+        static const uint8_t BC7_ANCHORS3_1[64] =
+        {
+             3,  3, 15, 15,  8,  3, 15, 15,  8,  8,  6,  6,  6,  5,  3,  3,
+             3,  3,  8, 15,  3,  3,  6, 10,  5,  8,  8,  6,  8,  5, 15, 15,
+             8, 15,  3,  5,  6, 10,  8, 15, 15,  3, 15,  5, 15, 15, 15, 15,
+             3, 15,  5,  5,  5,  8,  5, 10,  5, 10,  8, 13, 15, 12,  3,  3
+        };
+        static const uint8_t BC7_ANCHORS3_2[64] =
+        {
+            15,  8,  8,  3, 15, 15,  3,  8, 15, 15, 15, 15, 15, 15, 15,  8,
+            15,  8, 15,  3, 15,  8, 15,  8,  3, 15,  6, 10, 15, 15, 10,  8,
+            15,  3, 15, 10, 10,  8,  9, 10,  6, 15,  8, 15,  3,  6,  6,  8,
+            15,  3, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15,  3, 15, 15,  8
+        };
+        static const uint8_t BC7_WEIGHTS2[4]  = { 0, 21, 43, 64 };
+        static const uint8_t BC7_WEIGHTS3[8]  = { 0, 9, 18, 27, 37, 46, 55, 64 };
+        static const uint8_t BC7_WEIGHTS4[16] = { 0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64 };
+
+        // 128bitblock, ӵλʼ
+        class BitReader
+        {
+        public:
+            explicit BitReader(const uint8_t* block)
+            {
+                std::memcpy(m_bits, block, sizeof(m_bits));
+            }
+            uint32_t read(uint32_t count)
+            {
+                uint32_t v = 0;
+                for(uint32_t i = 0; i < count; ++i, ++m_pos)
+                    v |= uint32_t((m_bits[m_pos >> 6] >> (m_pos & 63)) & 1) << i;
+                return v;
+            }
+        private:
+            uint64_t m_bits[2];
+            uint32_t m_pos = 0;
+        };
+        inline uint32_t bc7Subset(uint32_t subsetCount, uint32_t partition, uint32_t texel)
+        {
+            switch(subsetCount)
+            {
+            case 2:
+                return (BC7_PARTITIONS2[partition] >> (texel * 2)) & 0x3;
+            case 3:
+                return (BC7_PARTITIONS3[partition] >> (texel * 2)) & 0x3;
+            default:
+                return 0;
+            }
+        }
+        inline bool bc7IsAnchor(uint32_t subsetCount, uint32_t partition, uint32_t texel)
+        {
+            if(texel == 0)
+                return true;
+            switch(subsetCount)
+            {
+            case 2:
+                return texel == BC7_ANCHORS2_1[partition];
+            case 3:
+                return texel == BC7_ANCHORS3_1[partition] || texel == BC7_ANCHORS3_2[partition];
+            default:
+                return false;
+            }
+        }
+        inline uint32_t bc7Interpolate(uint32_t e0, uint32_t e1, uint32_t index, uint32_t indexBits)
+        {
+            const uint8_t* weights = indexBits == 2 ? BC7_WEIGHTS2 : (indexBits == 3 ? BC7_WEIGHTS3 : BC7_WEIGHTS4);
+            const uint32_t w = weights[index];
+            return ((64 - w) * e0 + w * e1 + 32) >> 6;
+        }
+        // bitsλֵչΪ8bit
+        inline uint32_t bc7Expand(uint32_t v, uint32_t bits)
+        {
+            v <<= (8 - bits);
+            return v | (v >> bits);
+        }
+    }
+    void decode_bc7(const uint8_t* block, Vec4 texelsOut[16])
+    {
+        uint32_t modei = 0;
+        while(modei < 8 && !(block[0] & (1 << modei)))
+            ++modei;
+        if(modei == 8)
+        {// Ƿmode: 淶0
+            for(uint32_t i = 0; i < 16; ++i)
+                texelsOut[i] = Vec4::zero();
+            return;
+        }
+        const auto& mode = detail::BC7_MODES[modei];
+        detail::BitReader bits(block);
+        bits.read(modei + 1);
+
+        const auto partition = bits.read(mode.partitionBits);
+        const auto rotation  = bits.read(mode.rotationBits);
+        const auto indexSel  = bits.read(mode.indexSelectionBits);
+
+        // endpoints[subset*2 + e][channel]
+        uint32_t endpoints[6][4] = {};
+        const auto nEndpoint = mode.subsetCount * 2u;
+        for(uint32_t c = 0; c < 3; ++c)
+            for(uint32_t e = 0; e < nEndpoint; ++e)
+                endpoints[e][c] = bits.read(mode.colorBits);
+        if(mode.alphaBits)
+        {
+            for(uint32_t e = 0; e < nEndpoint; ++e)
+                endpoints[e][3] = bits.read(mode.alphaBits);
+        }
+        // P-bits
+        uint32_t colorBits = mode.colorBits, alphaBits = mode.alphaBits;
+        if(mode.endpointPBits || mode.sharedPBits)
+        {
+            uint32_t pbits[6];
+            if(mode.endpointPBits)
+            {
+                for(uint32_t e = 0; e < nEndpoint; ++e)
+                    pbits[e] = bits.read(1);
+            }
+            else
+            {
+                for(uint32_t s = 0; s < mode.subsetCount; ++s)
+                    pbits[s * 2] = pbits[s * 2 + 1] = bits.read(1);
+            }
+            for(uint32_t e = 0; e < nEndpoint; ++e)
+                for(uint32_t c = 0; c < 4; ++c)
+                    endpoints[e][c] = (endpoints[e][c] << 1) | pbits[e];
+            ++colorBits;
+            if(alphaBits)
+                ++alphaBits;
+        }
+        for(uint32_t e = 0; e < nEndpoint; ++e)
+        {
+            for(uint32_t c = 0; c < 3; ++c)
+                endpoints[e][c] = detail::bc7Expand(endpoints[e][c], colorBits);
+            endpoints[e][3] = alphaBits ? detail::bc7Expand(endpoints[e][3], alphaBits) : 255;
+        }
+        // : anchor texel1bit
+        uint32_t indices[16], secondaryIndices[16] = {};
+        for(uint32_t i = 0; i < 16; ++i)
+            indices[i] = bits.read(mode.indexBits - (detail::bc7IsAnchor(mode.subsetCount, partition, i) ? 1 : 0));
+        if(mode.secondaryIndexBits)
+        {
+            for(uint32_t i = 0; i < 16; ++i)
+                secondaryIndices[i] = bits.read(mode.secondaryIndexBits - (i == 0 ? 1 : 0));
+        }
+        for(uint32_t i = 0; i < 16; ++i)
+        {
+            const auto s   = detail::bc7Subset(mode.subsetCount, partition, i);
+            const auto& e0 = endpoints[s * 2], &e1 = endpoints[s * 2 + 1];
+
+            // mode 4/5: coloralphaһ; mode 4indexSel
+            auto colorIndex = indices[i], colorIndexBits = uint32_t(mode.indexBits);
+            auto alphaIndex = indices[i], alphaIndexBits = uint32_t(mode.indexBits);
+            if(mode.secondaryIndexBits)
+            {
+                alphaIndex = secondaryIndices[i];
+                alphaIndexBits = mode.secondaryIndexBits;
+                if(indexSel)
+                {
+                    std::swap(colorIndex, alphaIndex);
+                    std::swap(colorIndexBits, alphaIndexBits);
+                }
+            }
+            uint32_t rgba[4];
+            for(uint32_t c = 0; c < 3; ++c)
+                rgba[c] = detail::bc7Interpolate(e0[c], e1[c], colorIndex, colorIndexBits);
+            rgba[3] = detail::bc7Interpolate(e0[3], e1[3], alphaIndex, alphaIndexBits);
+            // rotation: 1,2,3ֱalphar,g,b
+            if(rotation)
+                std::swap(rgba[3], rgba[rotation - 1]);
+
+            texelsOut[i] = Vec4(detail::unorm8(rgba[0]), detail::unorm8(rgba[1]), detail::unorm8(rgba[2]), detail::unorm8(rgba[3]));
+        }
+    }
+    //////////////////////////////////////////////////////////////////////////////////////////
+    void decode_block(Format fmt, const void* block, Vec4 texelsOut[16])
+    {
+        const auto p = reinterpret_cast<const uint8_t*>(block);
+        switch(fmt)
+        {
+        case Format::BC1_UNORM:
+            decode_bc1(p, texelsOut);
+            break;
+        case Format::BC3_UNORM:
+            decode_bc3(p, texelsOut);
+            break;
+        case Format::BC7_UNORM:
+            decode_bc7(p, texelsOut);
+            break;
+        default:
+            assert(false && "֧!");
+        }
+    }
+    DecodedBlockCache& DecodedBlockCache::local()
+    {
+        static thread_local DecodedBlockCache cache;
+        return cache;
+    }
+}//ns rl
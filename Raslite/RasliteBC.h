@@ -0,0 +1,49 @@
+#ifndef RASLITE_BC_H
+#define RASLITE_BC_H
+#include "RasliteCommon.h"
+namespace rl {
+    /////////////////////////////////////////////////////////////////
+    // Block Compression: 4x4 texelһblock, ΪRGBA(16texel)
+    /////////////////////////////////////////////////////////////////
+    void decode_bc1(const uint8_t* block, Vec4 texelsOut[16]);
+    void decode_bc3(const uint8_t* block, Vec4 texelsOut[16]);
+    void decode_bc7(const uint8_t* block, Vec4 texelsOut[16]);
+    void decode_block(Format fmt, const void* block, Vec4 texelsOut[16]);
+    /////////////////////////////////////////////////////////////////
+    // ÿ߳һݵѽblock cache, direct-mapped
+    class DecodedBlockCache
+    {
+    public:
+        static constexpr uint32_t CAPACITY = 64;
+        static DecodedBlockCache& local();
+        // version: Surfaceݰ汾, ֱд·ڴ
+        const Vec4* fetch(Format fmt, const void* block, uint32_t version);
+    private:
+        struct Entry
+        {
+            const void* block   = nullptr;
+            uint32_t    version = 0;
+            Vec4        texels[16];
+        };
+        Entry m_entries[CAPACITY];
+    };
+}//ns rl
+/////////////////////////////////////////////////////////////////
+// 
+/////////////////////////////////////////////////////////////////
+namespace rl {
+    inline const Vec4* DecodedBlockCache::fetch(Format fmt, const void* block, uint32_t version)
+    {
+        const auto key = uint32_t(reinterpret_cast<uintptr_t>(block) >> 3);
+        auto& entry = m_entries[(key * 0x9E3779B1u) >> 26];
+        static_assert(CAPACITY == 64, "hash64entry");
+        if(entry.block != block || entry.version != version)
+        {
+            decode_block(fmt, block, entry.texels);
+            entry.block   = block;
+            entry.version = version;
+        }
+        return entry.texels;
+    }
+}//ns rl
+#endif //RASLITE_BC_H
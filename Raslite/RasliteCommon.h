@@ -1,6 +1,8 @@
 #ifndef RASLITE_COMMON_H
 #define RASLITE_COMMON_H
+#include <array>
 #include <cassert>
+#include <cmath>
 #include <cstdint>
 #include "RasliteMath.h"
 namespace rl {
@@ -14,10 +16,18 @@ namespace rl {
 	constexpr uint32_t VERTEX_STREAM_COUNT = 8;
 
     constexpr uint8_t RENDER_TARGET_COUNT = 8;
+    // multisampled Surfacesample
+    constexpr uint32_t MAX_SAMPLE_COUNT = 8;
 
     constexpr uint8_t SIMULTANEOUS_RENDER_TARGET_COUNT = 8;
     constexpr uint8_t SAMPLER_STATE_COUNT = 8;
     constexpr uint8_t SHADER_INPUT_RESOURCE_COUNT = 128;
+    constexpr uint8_t SHADER_CONSTANT_BUFFER_COUNT = 8;
+    // PixelShader::executeBatchһദpixel, Tex2D::sample8laneһ
+    constexpr uint32_t PS_BATCH_SIZE = 8;
+    // VertexShader::executeBatchһദvertex, СfloatNlane(AVX-512)
+    constexpr uint32_t VS_BATCH_SIZE = 16;
+    static_assert(VS_BATCH_SIZE * 2 <= VERTEX_CACHE_CAPACITY, "һvertex滻cacheеǰprimitivevertex");
 
 	enum class Format
 	{//׺: float,sint,uint,snorm,unorm,typeless,sRGB...
@@ -30,6 +40,21 @@ namespace rl {
         R16_SINT,
         R32_UINT,
         R32_SINT,
+        // Block Compression: 4x4 texelһblock
+        BC1_UNORM,
+        BC3_UNORM,
+        BC7_UNORM,
+        // 8-bit UNORM: ÿ1ֽ, ʱfilterתΪFloat
+        R8_UNORM,
+        R8G8_UNORM,
+        R8G8B8A8_UNORM,
+        R8G8B8A8_UNORM_SRGB, // rgbsRGB, alphaΪ
+        // ѹĶʽ: ֻInputElement, fetchʱչΪfloat
+        R16G16_SNORM,
+        R16G16B16A16_SNORM,
+        R16G16_FLOAT,
+        R16G16B16A16_FLOAT,
+        R10G10B10A2_UNORM,
 
         INDEX16 = R16_UINT,
         INDEX32 = R32_UINT,
@@ -147,6 +172,13 @@ namespace rl {
         SOLID,
         WIRE_FRAME
     };
+    // coarse pixel shading: ÿrate x rateblockִֻһPixelShader; ֵΪrate
+    enum class ShadingRate: uint8_t
+    {
+        _1X1 = 1,
+        _2X2 = 2,
+        _4X4 = 4,
+    };
 
     enum class StencilOp
     {
@@ -266,6 +298,107 @@ namespace rl
                 return 0;
         }
     }
+    inline bool is_block_compressed(Format fmt)
+    {
+        return fmt == Format::BC1_UNORM || fmt == Format::BC3_UNORM || fmt == Format::BC7_UNORM;
+    }
+    // ÿ4x4 blockֽ
+    inline uint32_t block_byte_count(Format fmt)
+    {
+        switch(fmt)
+        {
+        case Format::BC1_UNORM:
+            return 8;
+        case Format::BC3_UNORM:
+        case Format::BC7_UNORM:
+            return 16;
+        default:
+            assert(false && "ѹʽ!");
+            return 0;
+        }
+    }
+    inline bool is_unorm8(Format fmt)
+    {
+        return Format::R8_UNORM <= fmt && fmt <= Format::R8G8B8A8_UNORM_SRGB;
+    }
+    inline bool is_srgb(Format fmt)
+    {
+        return fmt == Format::R8G8B8A8_UNORM_SRGB;
+    }
+    // 8-bit UNORMʽÿtexelֽ
+    inline uint32_t unorm8_byte_count(Format fmt)
+    {
+        switch(fmt)
+        {
+        case Format::R8_UNORM:
+            return 1;
+        case Format::R8G8_UNORM:
+            return 2;
+        case Format::R8G8B8A8_UNORM:
+        case Format::R8G8B8A8_UNORM_SRGB:
+            return 4;
+        default:
+            assert(false && "8-bitʽ!");
+            return 0;
+        }
+    }
+    // һռFloat; ѹʽʱΪһblock, 8-bitʽʱ4ֽȡ
+    inline uint32_t surface_pitch(uint32_t width, Format fmt)
+    {
+        if(is_block_compressed(fmt))
+            return ((width + 3) >> 2) * block_byte_count(fmt) / sizeof(Float);
+        if(is_unorm8(fmt))
+            return (width * unorm8_byte_count(fmt) + sizeof(Float) - 1) / sizeof(Float);
+        return width * float_count(fmt);
+    }
+    // һwidth x heightSurfaceռFloat; ѹʽʱblockȡ
+    inline uint32_t surface_float_count(uint32_t width, uint32_t height, Format fmt)
+    {
+        if(is_block_compressed(fmt))
+            return surface_pitch(width, fmt) * ((height + 3) >> 2);
+        return surface_pitch(width, fmt) * height;
+    }
+    // sRGB -> ԵĲұ, 256
+    inline const Float* srgb_to_linear_table()
+    {
+        static const auto table = []
+        {
+            std::array<Float, 256> t;
+            for(uint32_t i = 0; i < 256; ++i)
+            {
+                const auto c = Float(i) / Float(255);
+                t[i] = c <= Float(0.04045) ? c / Float(12.92) : std::pow((c + Float(0.055)) / Float(1.055), Float(2.4));
+            }
+            return t;
+        }();
+        return table.data();
+    }
+    inline uint8_t float_to_unorm8(Float c)
+    {
+        return uint8_t(saturate(c) * Float(255) + Float(0.5));
+    }
+    inline uint8_t linear_to_srgb8(Float c)
+    {
+        c = saturate(c);
+        return float_to_unorm8(c <= Float(0.0031308) ? c * Float(12.92) : Float(1.055) * std::pow(c, Float(1) / Float(2.4)) - Float(0.055));
+    }
+    // FilterTypeD3D11λ: MIP(0x1), MAG(0x4), MIN(0x10), COMPARISON(0x80)
+    inline bool is_mip_linear(FilterType f)
+    {
+        return (uint32_t(f) & 0x1) != 0;
+    }
+    inline bool is_mag_linear(FilterType f)
+    {
+        return (uint32_t(f) & 0x4) != 0;
+    }
+    inline bool is_min_linear(FilterType f)
+    {
+        return (uint32_t(f) & 0x10) != 0;
+    }
+    inline bool is_comparison(FilterType f)
+    {
+        return (uint32_t(f) & 0x80) != 0;
+    }
     inline uint32_t byte_count(Format fmt)
     {
         switch(fmt)
@@ -274,24 +407,51 @@ namespace rl
             return 2;
         case Format::INDEX32:
             return 4;
+        case Format::R8_UNORM:
+        case Format::R8G8_UNORM:
+        case Format::R8G8B8A8_UNORM:
+        case Format::R8G8B8A8_UNORM_SRGB:
+            return unorm8_byte_count(fmt);
+        case Format::R16G16_SNORM:
+        case Format::R16G16_FLOAT:
+        case Format::R10G10B10A2_UNORM:
+            return 4;
+        case Format::R16G16B16A16_SNORM:
+        case Format::R16G16B16A16_FLOAT:
+            return 8;
         default:
             return float_count(fmt) * sizeof(float);
         }
     }
+    // InputElementĸʽ
+    inline bool is_vertex_format(Format fmt)
+    {
+        return fmt <= Format::R32G32B32A32_FLOAT
+            || (Format::R8_UNORM <= fmt && fmt <= Format::R8G8B8A8_UNORM)
+            || (Format::R16G16_SNORM <= fmt && fmt <= Format::R10G10B10A2_UNORM);
+    }
     inline ShaderRegisterType ToShaderRegisterType(Format t)
     {
         switch(t)
         {
             case Format::FLOAT32:
+            case Format::R8_UNORM:
                 return ShaderRegisterType::FLOAT32;
                 break;
             case Format::VECTOR2:
+            case Format::R8G8_UNORM:
+            case Format::R16G16_SNORM:
+            case Format::R16G16_FLOAT:
                 return ShaderRegisterType::VECTOR2;
                 break;
             case Format::VECTOR3:
                 return ShaderRegisterType::VECTOR3;
                 break;
             case Format::VECTOR4:
+            case Format::R8G8B8A8_UNORM:
+            case Format::R16G16B16A16_SNORM:
+            case Format::R16G16B16A16_FLOAT:
+            case Format::R10G10B10A2_UNORM:
                 return ShaderRegisterType::VECTOR4;
                 break;
             default:
@@ -312,6 +472,12 @@ namespace rl
             case PrimitiveTopology::TRIANGLE_LIST:
                 return nPrimitive * 3;
                 break;
+            case PrimitiveTopology::LINE_STRIP:
+                return nPrimitive + 1;
+                break;
+            case PrimitiveTopology::LINE_LIST:
+                return nPrimitive * 2;
+                break;
             default:
                 assert(false && "֧!");
                 return nPrimitive;
@@ -330,6 +496,12 @@ namespace rl
             case PrimitiveTopology::TRIANGLE_LIST:
                 return nVertex / 3;
                 break;
+            case PrimitiveTopology::LINE_STRIP:
+                return nVertex - 1;
+                break;
+            case PrimitiveTopology::LINE_LIST:
+                return nVertex / 2;
+                break;
             default:
                 assert(false);
         }
@@ -1,4 +1,14 @@
 #include "RasliteData.h"
+#include "RasliteBC.h"
+#include "RasliteKernels.h"
+#include "RasliteSIMD.h"
+#include "RasliteTextureFile.h"
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
 namespace rl {
     IndexBuffer::IndexBuffer(uint32_t indexCount, Format fmt)
         : m_length(indexCount*byte_count(fmt))
@@ -43,18 +53,93 @@ namespace rl {
     {
     }
     ///////////////////////////////////////////////////////////
+    //ConstantBuffer
+    ///////////////////////////////////////////////////////////
+    ConstantBuffer::ConstantBuffer(uint32_t vec4Count)
+        : m_data(std::make_shared<std::vector<Vec4>>(vec4Count, Vec4::zero()))
+        , m_vec4Count(vec4Count)
+    {
+        assert(vec4Count > 0);
+    }
+    ConstantBuffer::~ConstantBuffer()
+    {
+    }
+    ConstantBuffer::Snapshot ConstantBuffer::snapshot()
+    {
+        std::lock_guard<std::mutex> guard(m_mutex);
+        m_shared = true;
+        m_dirty  = false;
+        return m_data;
+    }
+    void ConstantBuffer::_write(uint32_t offset, const void* src, uint32_t bytes)
+    {
+        assert(offset + (bytes + sizeof(Vec4) - 1) / sizeof(Vec4) <= m_vec4Count && "ConstantBufferԽ!");
+        std::lock_guard<std::mutex> guard(m_mutex);
+        // ѽsnapshot: ƺд, snapshotֲ. use_count, ߳̿ڸƻͷsnapshot
+        if(m_shared)
+        {
+            m_data   = std::make_shared<std::vector<Vec4>>(*m_data);
+            m_shared = false;
+        }
+        if(!m_dirty)
+        {
+            ++m_version;
+            m_dirty = true;
+        }
+        std::memcpy(&(*m_data)[offset], src, bytes);
+    }
+    ///////////////////////////////////////////////////////////
     //Surface
     ///////////////////////////////////////////////////////////
     namespace detail {
-        template <typename T>
-        static inline void assign(Float* data, uint32_t width, const Rect& rect, const T& val)
+        // samples: multisampledʱÿpixelsample
+        // floatCount: ÿsampleȡvalǰfloatCount, floatʽͨһ
+        static inline void assign(const LockedRect& locked, const ColorValue& val, uint32_t floatCount, uint32_t samples = 1)
+        {
+            const auto& k = kernels();
+            const auto w = locked.rect.getWidth() * samples * floatCount, h = locked.rect.getHeight();
+            const Float pattern[4] = { val.r, val.g, val.b, val.a };
+            for(uint32_t y = 0; y < h; ++y)
+                k.fill(locked.row(y), w, pattern, floatCount);
+        }
+        // 8-bit UNORM texelĽ/; sRGBrgbɲұתԿռ, alphaΪ
+        static inline ColorValue decodeUnorm8(Format fmt, const uint8_t* p)
         {
-            auto bridge = width - rect.getWidth();
-            auto ptr    = &reinterpret_cast<T*>(data)[rect.top * width + rect.left];
-            for(auto y = rect.top; y < rect.bottom; ++y, ptr += bridge)
+            const auto k = Float(1) / Float(255);
+            switch(fmt)
             {
-                for(auto x = rect.left; x < rect.right; ++x, ++ptr)
-                    *ptr = val;
+            case Format::R8_UNORM:
+                return ColorValue(p[0] * k, 0, 0, 1);
+            case Format::R8G8_UNORM:
+                return ColorValue(p[0] * k, p[1] * k, 0, 1);
+            case Format::R8G8B8A8_UNORM:
+                return ColorValue(p[0] * k, p[1] * k, p[2] * k, p[3] * k);
+            default:
+                {
+                    assert(fmt == Format::R8G8B8A8_UNORM_SRGB && "8-bitʽ!");
+                    const auto lut = srgb_to_linear_table();
+                    return ColorValue(lut[p[0]], lut[p[1]], lut[p[2]], p[3] * k);
+                }
+            }
+        }
+        static inline void encodeUnorm8(Format fmt, const ColorValue& val, uint8_t* p)
+        {
+            const auto srgb = is_srgb(fmt);
+            const Float channels[4] = { val.r, val.g, val.b, val.a };
+            for(uint32_t i = 0, n = unorm8_byte_count(fmt); i < n; ++i)
+                p[i] = (srgb && i < 3) ? linear_to_srgb8(channels[i]) : float_to_unorm8(channels[i]);
+        }
+        static inline void assignUnorm8(const LockedRect& locked, Format fmt, const ColorValue& val)
+        {
+            uint8_t texel[4];
+            encodeUnorm8(fmt, val, texel);
+            const auto n = unorm8_byte_count(fmt);
+            const auto w = locked.rect.getWidth(), h = locked.rect.getHeight();
+            for(uint32_t y = 0; y < h; ++y)
+            {
+                auto ptr = reinterpret_cast<uint8_t*>(locked.row(y));
+                for(uint32_t x = 0; x < w; ++x)
+                    std::memcpy(ptr + x * n, texel, n);
             }
         }
         template <typename T>
@@ -87,122 +172,168 @@ namespace rl {
             auto row2 = lerpPixel<T>(data, width, x1Pixel, y2Pixel, x2Pixel, y2Pixel, factor1);
             return lerp(row1, row2, factor2);
         }
+
+        // Surface, ֤ͬSurfaceversionҲͬ
+        static inline uint32_t nextSurfaceVersion()
+        {
+            static std::atomic<uint32_t> s_version(0);
+            return ++s_version;
+        }
     }//ns detail
     Surface::Surface(uint32_t width, uint32_t height, Format fmt)
         : m_width(width)
         , m_height(height)
-        , m_allLocked(false)
-        , m_lockedData(0)
         , m_format(fmt)
-        , m_data(std::make_unique<Float[]>(m_width * m_height * float_count(m_format)))
+        , m_storage(std::make_unique<Float[]>(surface_float_count(width, height, fmt)))
+        , m_data(m_storage.get())
+        , m_version(detail::nextSurfaceVersion())
     {
         assert(width > 0 && height > 0);
     }
+    Surface::Surface(uint32_t width, uint32_t height, Format fmt, Float* data)
+        : m_width(width)
+        , m_height(height)
+        , m_format(fmt)
+        , m_data(data)
+        , m_version(detail::nextSurfaceVersion())
+    {
+        assert(width > 0 && height > 0);
+        assert(data);
+    }
+    std::unique_ptr<Surface> Surface::createMultisample(uint32_t width, uint32_t height, Format fmt, uint32_t sampleCount)
+    {
+        return std::unique_ptr<Surface>(new Surface(width, height, fmt, sampleCount, MultisampleTag()));
+    }
+    Surface::Surface(uint32_t width, uint32_t height, Format fmt, uint32_t sampleCount, MultisampleTag)
+        : m_width(width)
+        , m_height(height)
+        , m_sampleCount(sampleCount)
+        , m_format(fmt)
+        , m_storage(std::make_unique<Float[]>(surface_float_count(width, height, fmt) * sampleCount))
+        , m_data(m_storage.get())
+        , m_version(detail::nextSurfaceVersion())
+    {
+        assert(width > 0 && height > 0);
+        assert((sampleCount == 1 || sampleCount == 2 || sampleCount == 4 || sampleCount == 8) && "sampleΪ1,2,48!");
+        assert((sampleCount == 1 || (Format::R32_FLOAT <= fmt && fmt <= Format::R32G32B32A32_FLOAT)) && "multisampledֻ֧Floatʽ!");
+    }
     Surface::~Surface()
     {
     }
 
     void Surface::clear(const ColorValue& colorVal, const Rect *rect/*= nullptr*/)
     {
-        Rect clearingRect(0, 0, m_width, m_height);
-        {
-            assert(!(rect && rect->isNormal()));
-            if(rect)
-                clearingRect = *rect;
-            assert(this->getRect().contains(clearingRect));
-        }
-        auto data = this->lock();
+        assert(!rect || rect->isNormal());
+        auto locked = this->lock(rect);
         switch(m_format)
         {
         case Format::R32_FLOAT:
-            detail::assign(data, m_width, clearingRect, Float(colorVal.r));
+            detail::assign(locked, colorVal, 1, m_sampleCount);
             break;
         case Format::R32G32_FLOAT:
-            detail::assign(data, m_width, clearingRect, Vec2(colorVal));
+            detail::assign(locked, colorVal, 2, m_sampleCount);
             break;
         case Format::R32G32B32_FLOAT:
-            detail::assign(data, m_width, clearingRect, Vec3(colorVal));
+            detail::assign(locked, colorVal, 3, m_sampleCount);
             break;
         case Format::R32G32B32A32_FLOAT:
-            detail::assign(data, m_width, clearingRect, colorVal);
+            detail::assign(locked, colorVal, 4, m_sampleCount);
+            break;
+        case Format::R8_UNORM:
+        case Format::R8G8_UNORM:
+        case Format::R8G8B8A8_UNORM:
+        case Format::R8G8B8A8_UNORM_SRGB:
+            detail::assignUnorm8(locked, m_format, colorVal);
             break;
         default:
             assert(false && "֧!");
         }
-        this->unlock();
+        this->unlock(locked);
     }
-    Float* Surface::lock(const Rect *rect /*= nullptr*/)
+    LockedRect Surface::lock(const Rect *rect /*= nullptr*/, LockMode mode /*= LockMode::READ_WRITE*/)
     {
-        assert(!m_allLocked && !m_lockedData && "ѾLocked!");
-        if(!rect)
+        LockedRect locked;
+        locked.rect  = rect ? *rect : this->getRect();
+        locked.mode  = mode;
+        locked.pitch = this->getPitch();
+        assert(locked.rect.isNormal() && "ǷRect!");
+        assert(this->getRect().contains(locked.rect) && "Χ!");
+        // ֱָm_data,ٿ
+        if(is_block_compressed(m_format))
         {
-            m_allLocked = true;
-            return m_data.get();
+            assert(locked.rect.left % 4 == 0 && locked.rect.top % 4 == 0 && "ѹʽRect밴block!");
+            assert((locked.rect.right  % 4 == 0 || locked.rect.right  == m_width)  && "ѹʽRect밴block!");
+            assert((locked.rect.bottom % 4 == 0 || locked.rect.bottom == m_height) && "ѹʽRect밴block!");
+            const auto blockFloats = block_byte_count(m_format) / sizeof(Float);
+            locked.data = &m_data[(locked.rect.top >> 2) * locked.pitch + (locked.rect.left >> 2) * blockFloats];
         }
-        assert(rect->isNormal() && "ǷRect!");
-        assert(this->getRect().contains(*rect) && "Χ!");
-
-        m_lockedRect = *rect;
-
-        const auto w = m_lockedRect.getWidth(),
-                   h = m_lockedRect.getHeight(),
-              nFloat = this->getFormatFloatCount();
-
-        m_lockedData = std::make_unique<Float[]>(w * h * nFloat);
-
-        auto dst = m_lockedData.get();
-        for(auto y = m_lockedRect.top; y < m_lockedRect.bottom; ++y)
+        else if(is_unorm8(m_format))
+            locked.data = reinterpret_cast<Float*>(reinterpret_cast<uint8_t*>(&m_data[locked.rect.top * locked.pitch]) + locked.rect.left * unorm8_byte_count(m_format));
+        else
+            locked.data = &m_data[locked.rect.top * locked.pitch + locked.rect.left * this->getFormatFloatCount() * m_sampleCount];
+#ifdef _DEBUG
         {
-            auto src = &m_data[(y * m_width + m_lockedRect.left) * nFloat];
-            std::memcpy(dst, src, sizeof(Float) * nFloat * w);
-            dst += nFloat * w;
+            std::lock_guard<std::mutex> guard(m_lockMutex);
+            for(auto& other : m_locks)
+            {
+                const auto bothRead = mode == LockMode::READ_ONLY && other.mode == LockMode::READ_ONLY;
+                assert((bothRead || !other.rect.intersects(locked.rect)) && "ѾLocked!");
+            }
+            m_locks.push_back(locked);
         }
-        return m_lockedData.get();
+#endif
+        return locked;
     }
-    void Surface::unlock()
+    void Surface::unlock(const LockedRect& locked)
     {
-        assert(m_allLocked || m_lockedData);
-        if(m_allLocked)
+#ifdef _DEBUG
+        std::lock_guard<std::mutex> guard(m_lockMutex);
+        auto iter = std::find_if(m_locks.begin(), m_locks.end(), [&locked](const LockedRect& l)
         {
-            m_allLocked = false;
-            return;
-        }
-        const auto w = m_lockedRect.getWidth(),
-              nFloat = this->getFormatFloatCount();
-        auto src = m_lockedData.get();
-        for(auto y = m_lockedRect.top; y < m_lockedRect.bottom; ++y)
-        {
-            auto dst = &m_data[(y * m_width + m_lockedRect.left) * nFloat];
-            std::memcpy(dst, src, sizeof(Float) * nFloat * w);
-            src += nFloat * w;
-        }
-        m_lockedData = nullptr;
+            return l.data == locked.data && l.rect == locked.rect && l.mode == locked.mode;
+        });
+        assert(iter != m_locks.end() && "δLocked!");
+        if(iter != m_locks.end())
+            m_locks.erase(iter);
+#endif
+        if(locked.mode == LockMode::READ_WRITE)
+            m_version = detail::nextSurfaceVersion();
     }
     ColorValue Surface::getElement(uint32_t x, uint32_t y) const
     {
+        assert(m_sampleCount == 1 && "multisampledresolve!");
+        if(is_block_compressed(m_format))
+        {
+            const auto block = reinterpret_cast<const uint8_t*>(&m_data[(y >> 2) * this->getPitch()]) + (x >> 2) * block_byte_count(m_format);
+            Vec4 texels[16];
+            decode_block(m_format, block, texels);
+            return texels[(y & 3) * 4 + (x & 3)];
+        }
+        if(is_unorm8(m_format))
+            return detail::decodeUnorm8(m_format, reinterpret_cast<const uint8_t*>(&m_data[y * this->getPitch()]) + x * unorm8_byte_count(m_format));
         switch(m_format)
         {
         case Format::R32_FLOAT:
             {
-                auto& p = detail::pointPixel<Float>(m_data.get(), x, y, m_width);
+                auto& p = detail::pointPixel<Float>(m_data, x, y, m_width);
                 return ColorValue(p, 0, 0, 1);
             }
             break;
         case Format::R32G32_FLOAT:
             {
-                auto& p = detail::pointPixel<Vec2>(m_data.get(), x, y, m_width);
+                auto& p = detail::pointPixel<Vec2>(m_data, x, y, m_width);
                 return ColorValue(p.x, p.y, 0, 1);
             }
             break;
         case Format::R32G32B32_FLOAT:
             {
-                auto& p = detail::pointPixel<Vec3>(m_data.get(), x, y, m_width);
+                auto& p = detail::pointPixel<Vec3>(m_data, x, y, m_width);
                 return ColorValue(p.x, p.y, p.z, 1);
             }
             break;
         case Format::R32G32B32A32_FLOAT:
             {
-                return detail::pointPixel<ColorValue>(m_data.get(), x, y, m_width);
+                return detail::pointPixel<ColorValue>(m_data, x, y, m_width);
             }
             break;
         default:
@@ -213,29 +344,32 @@ namespace rl {
     }
     ColorValue Surface::getElement(uint32_t index)  const
     {
+        // 8-bitʽа4ֽڶ, ֱӰindexѰַ
+        if(is_unorm8(m_format))
+            return this->getElement(index % m_width, index / m_width);
         switch(m_format)
         {
         case Format::R32_FLOAT:
             {
-                auto& p = detail::pointPixel<Float>(m_data.get(),index);
+                auto& p = detail::pointPixel<Float>(m_data,index);
                 return ColorValue(p, 0, 0, 1);
             }
             break;
         case Format::R32G32_FLOAT:
             {
-                auto& p = detail::pointPixel<Vec2>(m_data.get(),index);
+                auto& p = detail::pointPixel<Vec2>(m_data,index);
                 return ColorValue(p.x, p.y, 0, 1);
             }
             break;
         case Format::R32G32B32_FLOAT:
             {
-                auto& p = detail::pointPixel<Vec3>(m_data.get(),index);
+                auto& p = detail::pointPixel<Vec3>(m_data,index);
                 return ColorValue(p.x, p.y, p.z, 1);
             }
             break;
         case Format::R32G32B32A32_FLOAT:
             {
-                return detail::pointPixel<ColorValue>(m_data.get(),index);
+                return detail::pointPixel<ColorValue>(m_data,index);
             }
             break;
         default:
@@ -269,26 +403,26 @@ namespace rl {
         {
             case Format::R32_FLOAT:
             {
-                auto p = detail::bilerpPixel<Float>(m_data.get(), m_width, x1Pixel, y1Pixel, x2Pixel, y2Pixel, factors[0], factors[1]);
+                auto p = detail::bilerpPixel<Float>(m_data, m_width, x1Pixel, y1Pixel, x2Pixel, y2Pixel, factors[0], factors[1]);
                 return ColorValue(p, 0, 0, 1);
             }
             break;
             case Format::R32G32_FLOAT:
             {
-                auto p = detail::bilerpPixel<Vec2>(m_data.get(), m_width, x1Pixel, y1Pixel, x2Pixel, y2Pixel, factors[0], factors[1]);
+                auto p = detail::bilerpPixel<Vec2>(m_data, m_width, x1Pixel, y1Pixel, x2Pixel, y2Pixel, factors[0], factors[1]);
                 return ColorValue(p.x, p.y, 0, 1);
 
             }
             break;
             case Format::R32G32B32_FLOAT:
             {
-                auto p = detail::bilerpPixel<Vec3>(m_data.get(), m_width, x1Pixel, y1Pixel, x2Pixel, y2Pixel, factors[0], factors[1]);
+                auto p = detail::bilerpPixel<Vec3>(m_data, m_width, x1Pixel, y1Pixel, x2Pixel, y2Pixel, factors[0], factors[1]);
                 return ColorValue(p.x, p.y, p.z, 1);
             }
             break;
             case Format::R32G32B32A32_FLOAT:
             {
-                return detail::bilerpPixel<Vec4>(m_data.get(), m_width, x1Pixel, y1Pixel, x2Pixel, y2Pixel, factors[0], factors[1]);
+                return detail::bilerpPixel<Vec4>(m_data, m_width, x1Pixel, y1Pixel, x2Pixel, y2Pixel, factors[0], factors[1]);
             }
             break;
             default:
@@ -300,23 +434,26 @@ namespace rl {
     void Surface::copyTo(const Rect *srcRect, Surface *dstSurface, const Rect *destRect, FilterType filterType)
     {
         assert(dstSurface);
-        assert(filterType == FilterType::POINT && filterType == FilterType::LINEAR);
+        assert(filterType == FilterType::POINT || filterType == FilterType::LINEAR);
+        assert(!is_block_compressed(m_format) && !is_block_compressed(dstSurface->getFormat()) && "֧!");
+        assert(!is_unorm8(m_format) && !is_unorm8(dstSurface->getFormat()) && "֧!");
+        assert(m_sampleCount == 1 && dstSurface->getSampleCount() == 1 && "multisampledresolve!");
 
         Rect sRect(0, 0, m_width, m_height);
         {
-            assert(!(srcRect&&srcRect->isNormal()));
+            assert(!srcRect || srcRect->isNormal());
             if(srcRect)
                 sRect = *srcRect;
             assert(this->getRect().contains(sRect));
         }
         Rect dRest(0, 0, dstSurface->getWidth(), dstSurface->getHeight());
         {
-            assert(!(destRect&&destRect->isNormal()));
+            assert(!destRect || destRect->isNormal());
             if(destRect)
                 dRest = *destRect;
             assert(dstSurface->getRect().contains(dRest));
         }
-        auto pDestData = dstSurface->lock(destRect);
+        auto destLocked = dstSurface->lock(&dRest);
         const auto iDestFloats = dstSurface->getFormatFloatCount(),
             iDestWidth = dRest.getWidth(),
             iDestHeight = dRest.getHeight();
@@ -327,8 +464,8 @@ namespace rl {
             && iDestWidth == m_width
             && iDestHeight == m_height)
         {
-            std::memcpy(pDestData, m_data.get(), sizeof(Float) * iDestFloats * iDestWidth * iDestHeight);
-            dstSurface->unlock();
+            std::memcpy(destLocked.data, m_data, sizeof(Float) * iDestFloats * iDestWidth * iDestHeight);
+            dstSurface->unlock(destLocked);
             return;
         }
 
@@ -339,6 +476,7 @@ namespace rl {
         for(uint32_t y = 0; y < iDestHeight; ++y, vsrc += vstep)
         {
             Float usrc = sRect.left * ustep;
+            auto pDestData = destLocked.row(y);
             for(uint32_t x = 0; x < iDestWidth; ++x, usrc += ustep, pDestData += iDestFloats)
             {
                 auto vSrcColor =
@@ -346,45 +484,411 @@ namespace rl {
                 vSrcColor.copyTo(pDestData, iDestFloats);
             }
         }
-        dstSurface->unlock();
+        dstSurface->unlock(destLocked);
     }
     //
     //
     //
     namespace detail
     {
-        template <typename T>
-        static void filterTexel(const Float* src, uint32_t width, uint32_t height, Float* dstOut)
+        // һά²filter: ÿdst texelӦtapCountsrc texel(clampԵ)Ȩ(Ϊ1)
+        struct FilterTaps
+        {
+            uint32_t              tapCount = 0;
+            std::vector<uint32_t> indices;
+            std::vector<Float>    weights;
+        };
+        // һBesselI0, չ
+        static Float besselI0(Float x)
+        {
+            Float sum = 1, term = 1;
+            const auto xSqQuarter = x * x * Float(0.25);
+            for(uint32_t k = 1; k < 32 && term > sum * Float(1e-7); ++k)
+            {
+                term *= xSqQuarter / Float(k * k);
+                sum  += term;
+            }
+            return sum;
+        }
+        static Float sinc(Float x)
+        {
+            if(std::fabs(x) < Float(1e-5))
+                return Float(1);
+            const auto px = Float(3.14159265358979) * x;
+            return std::sin(px) / px;
+        }
+        static FilterTaps buildFilterTaps(uint32_t srcSize, uint32_t dstSize, MipFilter filter)
+        {
+            // Kaiser: dst texelΪλİ뾶alpha
+            const Float KAISER_RADIUS = 2, KAISER_ALPHA = 4;
+
+            const auto scale = Float(srcSize) / Float(dstSize);
+            std::vector<std::vector<std::pair<int32_t, Float>>> perDst(dstSize);
+            for(uint32_t i = 0; i < dstSize; ++i)
+            {
+                auto& taps = perDst[i];
+                if(filter == MipFilter::BOX)
+                {// dst texelǷΧ[i*scale, (i+1)*scale)ص
+                    const auto lo = i * scale, hi = (i + 1) * scale;
+                    for(auto j = int32_t(std::floor(lo)); Float(j) < hi; ++j)
+                    {
+                        const auto overlap = std::min(hi, Float(j + 1)) - std::max(lo, Float(j));
+                        if(overlap > Float(1e-6))
+                            taps.emplace_back(j, overlap / scale);
+                    }
+                }
+                else
+                {
+                    const auto center = (i + Float(0.5)) * scale;
+                    const auto radius = KAISER_RADIUS * scale;
+                    Float sum = 0;
+                    for(auto j = int32_t(std::ceil(center - radius - Float(0.5))); Float(j) + Float(0.5) < center + radius; ++j)
+                    {
+                        const auto t = (Float(j) + Float(0.5) - center) / scale;  // dst texelΪλ
+                        const auto r = t / KAISER_RADIUS;
+                        if(std::fabs(r) >= Float(1))
+                            continue;
+                        const auto w = sinc(t) * besselI0(KAISER_ALPHA * std::sqrt(1 - r * r)) / besselI0(KAISER_ALPHA);
+                        taps.emplace_back(j, w);
+                        sum += w;
+                    }
+                    for(auto& tap : taps)
+                        tap.second /= sum;
+                }
+            }
+            FilterTaps result;
+            for(auto& taps : perDst)
+                result.tapCount = std::max(result.tapCount, uint32_t(taps.size()));
+            result.indices.assign(dstSize * result.tapCount, 0);
+            result.weights.assign(dstSize * result.tapCount, Float(0));
+            for(uint32_t i = 0; i < dstSize; ++i)
+            {
+                for(uint32_t k = 0; k < perDst[i].size(); ++k)
+                {
+                    result.indices[i * result.tapCount + k] = uint32_t(clamp<int32_t>(perDst[i][k].first, 0, int32_t(srcSize) - 1));
+                    result.weights[i * result.tapCount + k] = perDst[i][k].second;
+                }
+            }
+            return result;
+        }
+        // mipõĳפ߳: ״ʹʱ, ˳ʱ; ÿfilterٴ/join߳
+        class WorkerPool
+        {
+        public:
+            static WorkerPool& instance()
+            {
+                static WorkerPool s_pool;
+                return s_pool;
+            }
+            // ߳
+            uint32_t getThreadCount() const
+            {
+                return uint32_t(m_threads.size()) + 1;
+            }
+            // job(i), i in [0, chunkCount): ɹ̺߳͵̷ֵ߳, ȫɺ󷵻
+            // ߳ͬʱʱִ; jobвٵrun
+            void run(uint32_t chunkCount, const std::function<void(uint32_t)>& job)
+            {
+                std::lock_guard<std::mutex> runGuard(m_runMutex);
+                {
+                    std::lock_guard<std::mutex> guard(m_mutex);
+                    m_job        = &job;
+                    m_chunkCount = chunkCount;
+                    m_nextChunk  = 0;
+                    m_doneChunks = 0;
+                }
+                m_cond.notify_all();
+                std::unique_lock<std::mutex> lock(m_mutex);
+                this->_work(lock, false);
+                m_doneCond.wait(lock, [this] { return m_doneChunks == m_chunkCount; });
+                m_job = nullptr;
+            }
+        private:
+            WorkerPool()
+            {
+                const auto n = std::max(1u, std::thread::hardware_concurrency());
+                for(uint32_t t = 1; t < n; ++t)
+                    m_threads.emplace_back([this]
+                    {
+                        std::unique_lock<std::mutex> lock(m_mutex);
+                        this->_work(lock, true);
+                    });
+            }
+            ~WorkerPool()
+            {
+                {
+                    std::lock_guard<std::mutex> guard(m_mutex);
+                    m_quit = true;
+                }
+                m_cond.notify_all();
+                for(auto& thread : m_threads)
+                    thread.join();
+            }
+            // lockʱ; ߳һֱѭm_quit, ߳ûʣĿʱ
+            void _work(std::unique_lock<std::mutex>& lock, bool wait)
+            {
+                for(;;)
+                {
+                    if(wait)
+                        m_cond.wait(lock, [this] { return m_quit || (m_job && m_nextChunk < m_chunkCount); });
+                    if(m_quit || !m_job || m_nextChunk >= m_chunkCount)
+                        return;
+                    const auto  chunk = m_nextChunk++;
+                    const auto& job   = *m_job;
+                    lock.unlock();
+                    job(chunk);
+                    lock.lock();
+                    if(++m_doneChunks == m_chunkCount)
+                        m_doneCond.notify_all();
+                }
+            }
+        private:
+            std::vector<std::thread> m_threads;
+            std::mutex               m_runMutex;
+            std::mutex               m_mutex;
+            std::condition_variable  m_cond;
+            std::condition_variable  m_doneCond;
+            const std::function<void(uint32_t)>* m_job = nullptr;
+            uint32_t m_chunkCount = 0;
+            uint32_t m_nextChunk  = 0;
+            uint32_t m_doneChunks = 0;
+            bool     m_quit       = false;
+        };
+        // ÿôtexel; Ĺ(Լ128x128µlevel)ֱڵǰ߳
+        constexpr uint32_t PARALLEL_GRAIN_TEXELS = 32768;
+        // [0, count)ָWorkerPool; ÿgrain
+        template <typename Fn>
+        static void parallelFor(uint32_t count, uint32_t grain, const Fn& fn)
+        {
+            const auto chunkCount = (count + grain - 1) / grain;
+            if(chunkCount <= 1)
+            {
+                fn(0u, count);
+                return;
+            }
+            auto& pool = WorkerPool::instance();
+            const auto nChunk = std::min(pool.getThreadCount(), chunkCount);
+            if(nChunk <= 1)
+            {
+                fn(0u, count);
+                return;
+            }
+            const auto chunk = (count + nChunk - 1) / nChunk;
+            pool.run(nChunk, [&fn, chunk, count](uint32_t i)
+            {
+                fn(std::min(count, i * chunk), std::min(count, (i + 1) * chunk));
+            });
+        }
+        template <uint32_t N> SIMDFloat4_t loadTexel(const Float* p);
+        template <> SIMDFloat4_t loadTexel<1>(const Float* p) { return SIMDFloat4::loaduX(p); }
+        template <> SIMDFloat4_t loadTexel<2>(const Float* p) { return SIMDFloat4::loaduXY(p); }
+        template <> SIMDFloat4_t loadTexel<3>(const Float* p) { return SIMDFloat4::loaduXYZ(p); }
+        template <> SIMDFloat4_t loadTexel<4>(const Float* p) { return SIMDFloat4::loadu(p); }
+        template <uint32_t N>
+        static inline void storeTexel(SIMDFloat4P_t v, Float* p)
+        {
+            alignas(16) Float tmp[4];
+            simd::store(v, tmp);
+            for(uint32_t i = 0; i < N; ++i)
+                p[i] = tmp[i];
+        }
+        template <>
+        inline void storeTexel<4>(SIMDFloat4P_t v, Float* p)
+        {
+            simd::storeu(v, p);
+        }
+        // mipʱtexelĶд: FloatʽֱӶд; 8-bitʽתΪFloat, sRGBԿռfilter
+        template <uint32_t N> struct FloatTexels
+        {
+            static SIMDFloat4_t load(const Float* row, uint32_t x)          { return loadTexel<N>(row + x * N); }
+            static void         store(SIMDFloat4P_t v, Float* row, uint32_t x) { storeTexel<N>(v, row + x * N); }
+        };
+        template <Format F> struct Unorm8Texels
+        {
+            static SIMDFloat4_t load(const Float* row, uint32_t x)
+            {
+                const auto c = decodeUnorm8(F, reinterpret_cast<const uint8_t*>(row) + x * unorm8_byte_count(F));
+                return SIMDFloat4::loadu(&c.x);
+            }
+            static void store(SIMDFloat4P_t v, Float* row, uint32_t x)
+            {
+                ColorValue c;
+                simd::storeu(v, &c.x);
+                encodeUnorm8(F, c, reinterpret_cast<uint8_t*>(row) + x * unorm8_byte_count(F));
+            }
+        };
+        // src[lo, hi)ı仯Ӱ쵽dstΧ
+        static std::pair<uint32_t, uint32_t> affectedRange(const FilterTaps& taps, uint32_t lo, uint32_t hi)
+        {
+            const auto dstSize = uint32_t(taps.indices.size() / taps.tapCount);
+            uint32_t first = dstSize, last = 0;
+            for(uint32_t i = 0; i < dstSize; ++i)
+            {
+                for(uint32_t k = 0; k < taps.tapCount; ++k)
+                {
+                    const auto idx = taps.indices[i * taps.tapCount + k];
+                    if(lo <= idx && idx < hi && taps.weights[i * taps.tapCount + k] != Float(0))
+                    {
+                        first = std::min(first, i);
+                        last  = std::max(last, i + 1);
+                        break;
+                    }
+                }
+            }
+            return first < last ? std::make_pair(first, last) : std::make_pair(0u, 0u);
+        }
+        // ɷfilter: Ⱥ(src -> dstRect), ; ÿ˰в
+        // srcΪLockedRect, dstΪǡlockdstRectϵLockedRect; ֻ¼dstRectڵtexel
+        template <typename Texels>
+        static void downsample(const LockedRect& src, const FilterTaps& xTaps, const FilterTaps& yTaps,
+                               const LockedRect& dst, const Rect& dstRect)
+        {
+            const auto dstWidth = dstRect.getWidth();
+            // dstRectõsrc
+            uint32_t srcTop = ~0u, srcBottom = 0;
+            for(auto y = dstRect.top; y < dstRect.bottom; ++y)
+            {
+                for(uint32_t k = 0; k < yTaps.tapCount; ++k)
+                {
+                    srcTop    = std::min(srcTop,    yTaps.indices[y * yTaps.tapCount + k]);
+                    srcBottom = std::max(srcBottom, yTaps.indices[y * yTaps.tapCount + k] + 1);
+                }
+            }
+            // мͳһ4Float
+            std::unique_ptr<Float[]> tmp(new Float[(srcBottom - srcTop) * dstWidth * 4]);
+            const auto grain = std::max(1u, PARALLEL_GRAIN_TEXELS / std::max(1u, dstWidth));
+
+            parallelFor(srcBottom - srcTop, grain, [&](uint32_t rowBegin, uint32_t rowEnd)
+            {
+                for(auto r = rowBegin; r < rowEnd; ++r)
+                {
+                    const Float* srcRow = src.row(srcTop + r);
+                    Float*       tmpRow = &tmp[r * dstWidth * 4];
+                    for(uint32_t x = 0; x < dstWidth; ++x)
+                    {
+                        auto indices = &xTaps.indices[(dstRect.left + x) * xTaps.tapCount];
+                        auto weights = &xTaps.weights[(dstRect.left + x) * xTaps.tapCount];
+                        auto acc = SIMDFloat4::zero();
+                        for(uint32_t k = 0; k < xTaps.tapCount; ++k)
+                            acc = simd::add(acc, simd::mul(Texels::load(srcRow, indices[k]), weights[k]));
+                        simd::storeu(acc, tmpRow + x * 4);
+                    }
+                }
+            });
+            parallelFor(dstRect.getHeight(), grain, [&](uint32_t rowBegin, uint32_t rowEnd)
+            {
+                for(auto r = rowBegin; r < rowEnd; ++r)
+                {
+                    const auto y = dstRect.top + r;
+                    auto indices = &yTaps.indices[y * yTaps.tapCount];
+                    auto weights = &yTaps.weights[y * yTaps.tapCount];
+                    Float* dstRow = dst.row(r);
+                    for(uint32_t x = 0; x < dstWidth; ++x)
+                    {
+                        auto acc = SIMDFloat4::zero();
+                        for(uint32_t k = 0; k < yTaps.tapCount; ++k)
+                            acc = simd::add(acc, simd::mul(SIMDFloat4::loadu(&tmp[((indices[k] - srcTop) * dstWidth + x) * 4]), weights[k]));
+                        Texels::store(acc, dstRow, x);
+                    }
+                }
+            });
+        }
+        static void downsample(Format fmt, const LockedRect& src, uint32_t srcWidth, uint32_t srcHeight,
+                               const LockedRect& dst, uint32_t dstWidth, uint32_t dstHeight, const Rect& dstRect, MipFilter filter)
+        {
+            const auto xTaps = buildFilterTaps(srcWidth,  dstWidth,  filter);
+            const auto yTaps = buildFilterTaps(srcHeight, dstHeight, filter);
+            switch(fmt)
+            {
+            case Format::R32_FLOAT:
+                downsample<FloatTexels<1>>(src, xTaps, yTaps, dst, dstRect);
+                break;
+            case Format::R32G32_FLOAT:
+                downsample<FloatTexels<2>>(src, xTaps, yTaps, dst, dstRect);
+                break;
+            case Format::R32G32B32_FLOAT:
+                downsample<FloatTexels<3>>(src, xTaps, yTaps, dst, dstRect);
+                break;
+            case Format::R32G32B32A32_FLOAT:
+                downsample<FloatTexels<4>>(src, xTaps, yTaps, dst, dstRect);
+                break;
+            case Format::R8_UNORM:
+                downsample<Unorm8Texels<Format::R8_UNORM>>(src, xTaps, yTaps, dst, dstRect);
+                break;
+            case Format::R8G8_UNORM:
+                downsample<Unorm8Texels<Format::R8G8_UNORM>>(src, xTaps, yTaps, dst, dstRect);
+                break;
+            case Format::R8G8B8A8_UNORM:
+                downsample<Unorm8Texels<Format::R8G8B8A8_UNORM>>(src, xTaps, yTaps, dst, dstRect);
+                break;
+            case Format::R8G8B8A8_UNORM_SRGB:
+                downsample<Unorm8Texels<Format::R8G8B8A8_UNORM_SRGB>>(src, xTaps, yTaps, dst, dstRect);
+                break;
+            default:
+                assert(false && "֧!");
+                break;
+            }
+        }
+    }
+    namespace detail
+    {
+        template <uint32_t N>
+        static void resolveSamples(const LockedRect& src, const LockedRect& dst, uint32_t samples)
         {
-            auto srcTexel = reinterpret_cast<const T*>(src);
-            auto dstTexel = reinterpret_cast<T*>(dstOut);
-            for(uint32_t y = 0; y < height; y += 2)
+            const auto w = dst.rect.getWidth(), h = dst.rect.getHeight();
+            const auto scale = Float(1) / Float(samples);
+            for(uint32_t y = 0; y < h; ++y)
             {
-                const uint32_t rows[2] = { y * width, (y + 1) * width };
-                for(uint32_t x = 0; x < width; x += 2, ++dstTexel)
+                const Float* srcRow = src.row(y);
+                Float*       dstRow = dst.row(y);
+                for(uint32_t x = 0; x < w; ++x, srcRow += N * samples)
                 {
-                    *dstTexel =
-                        (
-                            srcTexel[rows[0] + x] +
-                            srcTexel[rows[0] + x + 1] +
-                            srcTexel[rows[1] + x] +
-                            srcTexel[rows[1] + x + 1]
-                         ) * Float(0.25);
+                    auto acc = loadTexel<N>(srcRow);
+                    for(uint32_t s = 1; s < samples; ++s)
+                        acc = simd::add(acc, loadTexel<N>(srcRow + s * N));
+                    storeTexel<N>(simd::mul(acc, scale), dstRow + x * N);
                 }
             }
         }
     }
+    void Surface::resolve(Surface* dstSurface)
+    {
+        assert(dstSurface && dstSurface->getSampleCount() == 1);
+        assert(dstSurface->getFormat() == m_format && dstSurface->getWidth() == m_width && dstSurface->getHeight() == m_height);
+        auto src = this->lock(nullptr, LockMode::READ_ONLY);
+        auto dst = dstSurface->lock();
+        switch(m_format)
+        {
+        case Format::R32_FLOAT:
+            detail::resolveSamples<1>(src, dst, m_sampleCount);
+            break;
+        case Format::R32G32_FLOAT:
+            detail::resolveSamples<2>(src, dst, m_sampleCount);
+            break;
+        case Format::R32G32B32_FLOAT:
+            detail::resolveSamples<3>(src, dst, m_sampleCount);
+            break;
+        case Format::R32G32B32A32_FLOAT:
+            detail::resolveSamples<4>(src, dst, m_sampleCount);
+            break;
+        default:
+            assert(false && "֧!");
+        }
+        dstSurface->unlock(dst);
+        this->unlock(src);
+    }
     ///////////////////////////////////////////////////////////////////////////////////
     //
     ///////////////////////////////////////////////////////////////////////////////////
     Texture2D::Texture2D(const Desc& desc)
-        : m_mipLevel(0)
+        : Texture(TextureType::TEXTURE_2D)
+        , m_mipLevel(0)
         , m_surfaces(nullptr)
         , m_widthSq(desc.width * desc.width)
         , m_heightSq(desc.height* desc.height)
     {
         assert(desc.width > 0 && desc.height > 0);
-        assert(Format::R32_FLOAT <= desc.format && desc.format <= Format::R32G32B32A32_FLOAT);
+        assert((Format::R32_FLOAT <= desc.format && desc.format <= Format::R32G32B32A32_FLOAT) || is_block_compressed(desc.format) || is_unorm8(desc.format));
 
         auto mipLevels = desc.mipLevels;
         if(desc.mipLevels == 0)
@@ -398,6 +902,7 @@ namespace rl {
             while(w && h);
         }
         m_surfaces = new Surface*[mipLevels];
+        m_dirtyRects.reset(new Rect[mipLevels]);
 
 
         std::memset(m_surfaces, 0, sizeof(Surface*) * mipLevels);
@@ -413,16 +918,43 @@ namespace rl {
                 w >>= 1; h >>= 1;
             } while(w && h);
         }
-        if(desc.mem)
+        if(desc.mem && is_block_compressed(desc.format))
+        {// ѹʽmip: memаDDSĲνܴŸmipblock, memPitch
+            auto src = reinterpret_cast<const uint8_t*>(desc.mem);
+            for(uint32_t lvl = 0; lvl < m_mipLevel; ++lvl)
+            {
+                auto locked = m_surfaces[lvl]->lock();
+                const auto byteCount = locked.pitch * sizeof(Float) * ((this->getHeight(lvl) + 3) >> 2);
+                std::memcpy(locked.data, src, byteCount);
+                src += byteCount;
+                m_surfaces[lvl]->unlock(locked);
+            }
+        }
+        else if(desc.mem)
         {
-            auto dst = reinterpret_cast<uint8_t*>(m_surfaces[0]->lock());
+            auto locked = m_surfaces[0]->lock();
             const auto byteWidth = m_surfaces[0]->getFormatByteCount() * desc.width;
-            for(size_t h = 0; h < desc.height; ++h)
-                std::memcpy(dst + h * byteWidth, reinterpret_cast<const uint8_t*>(desc.mem) + h * desc.memPitch, byteWidth);
-            m_surfaces[0]->unlock();
-            this->generateMips();
+            for(uint32_t h = 0; h < desc.height; ++h)
+                std::memcpy(locked.row(h), reinterpret_cast<const uint8_t*>(desc.mem) + h * desc.memPitch, byteWidth);
+            m_surfaces[0]->unlock(locked);
+            if(m_mipLevel > 1)
+                this->generateMips(0, desc.mipFilter);
         }
     }
+    Texture2D::Texture2D(std::shared_ptr<TextureFile> file)
+        : Texture(TextureType::TEXTURE_2D)
+        , m_mipLevel(0)
+        , m_file(std::move(file))
+    {
+        assert(m_file && "TextureFile::openʧ!");
+        m_mipLevel = m_file->getMipLevel();
+        m_widthSq  = m_file->getWidth()  * m_file->getWidth();
+        m_heightSq = m_file->getHeight() * m_file->getHeight();
+        m_surfaces = new Surface*[m_mipLevel];
+        m_dirtyRects.reset(new Rect[m_mipLevel]);
+        for(uint32_t lvl = 0; lvl < m_mipLevel; ++lvl)
+            m_surfaces[lvl] = new Surface(m_file->getWidth(lvl), m_file->getHeight(lvl), m_file->getFormat(), m_file->getMipData(lvl));
+    }
     Texture2D::~Texture2D()
     {
         for(size_t i = 0; i < m_mipLevel; ++i)
@@ -434,54 +966,79 @@ namespace rl {
         assert(mipLevel < m_mipLevel);
         assert(m_surfaces[mipLevel]);
         m_surfaces[mipLevel]->clear(clr, rect);
+        m_dirtyRects[mipLevel].merge(rect ? *rect : m_surfaces[mipLevel]->getRect());
     }
-    void Texture2D::generateMips(uint32_t baseLevel)
+    void Texture2D::generateMips(uint32_t baseLevel, MipFilter filter)
     {
         assert(baseLevel + 1 < m_mipLevel);
         const auto fmt = this->getFormat();
+        assert(!is_block_compressed(fmt) && "ѹʽmip!");
+        // ÿֻlockһ: ΪdstдֱΪһsrc
+        std::vector<LockedRect> locks(m_mipLevel);
+        locks[baseLevel] = this->lock(baseLevel, nullptr, LockMode::READ_ONLY);
         for(uint32_t lvl = baseLevel + 1; lvl < m_mipLevel; ++lvl)
-        {
-            auto src = reinterpret_cast<const Float*>(this->lock(lvl - 1));
-            auto dst = reinterpret_cast<      Float*>(this->lock(lvl));
+            locks[lvl] = this->lock(lvl);
 
-            const auto height = this->getHeight(lvl - 1);
-            const auto width  = this->getWidth (lvl - 1);
-            switch(fmt)
-            {
-            case Format::R32_FLOAT:
-                detail::filterTexel<Float>(src, width, height, dst);
-                break;
-
-            case Format::R32G32_FLOAT:
-                detail::filterTexel<Vec2>(src, width, height, dst);
-                break;
+        for(uint32_t lvl = baseLevel + 1; lvl < m_mipLevel; ++lvl)
+        {
+            const auto srcWidth = this->getWidth(lvl - 1), srcHeight = this->getHeight(lvl - 1);
+            const auto dstWidth = this->getWidth(lvl),     dstHeight = this->getHeight(lvl);
+            detail::downsample(fmt, locks[lvl - 1], srcWidth, srcHeight, locks[lvl], dstWidth, dstHeight, locks[lvl].rect, filter);
+        }
+        // ֱunlock Surface: mipһ, ٱdirty
+        for(uint32_t lvl = baseLevel; lvl < m_mipLevel; ++lvl)
+        {
+            m_surfaces[lvl]->unlock(locks[lvl]);
+            m_dirtyRects[lvl] = Rect();
+        }
+    }
+    void Texture2D::updateMips(MipFilter filter)
+    {
+        const auto fmt = this->getFormat();
+        assert(!is_block_compressed(fmt) && "ѹʽmip!");
+        // ϶: ÿdirtyֻӰһһ, ٲһdirty
+        for(uint32_t lvl = 0; lvl + 1 < m_mipLevel; ++lvl)
+        {
+            const auto dirty = m_dirtyRects[lvl];
+            m_dirtyRects[lvl] = Rect();
+            if(dirty.isVoid())
+                continue;
+            const auto srcWidth = this->getWidth(lvl),     srcHeight = this->getHeight(lvl);
+            const auto dstWidth = this->getWidth(lvl + 1), dstHeight = this->getHeight(lvl + 1);
+            const auto xRange = detail::affectedRange(detail::buildFilterTaps(srcWidth,  dstWidth,  filter), dirty.left, dirty.right);
+            const auto yRange = detail::affectedRange(detail::buildFilterTaps(srcHeight, dstHeight, filter), dirty.top,  dirty.bottom);
+            const Rect dstRect(xRange.first, yRange.first, xRange.second, yRange.second);
+            if(dstRect.isVoid())
+                continue;
 
-            case Format::R32G32B32_FLOAT:
-                detail::filterTexel<Vec3>(src, width, height, dst);
-                break;
+            auto src = m_surfaces[lvl]->lock(nullptr, LockMode::READ_ONLY);
+            auto dst = m_surfaces[lvl + 1]->lock(&dstRect);
+            detail::downsample(fmt, src, srcWidth, srcHeight, dst, dstWidth, dstHeight, dstRect, filter);
+            m_surfaces[lvl + 1]->unlock(dst);
+            m_surfaces[lvl]->unlock(src);
 
-            case Format::R32G32B32A32_FLOAT:
-                detail::filterTexel<Vec4>(src, width, height, dst);
-                break;
-            default:
-                assert(false);
-                break;
-            }
-            this->unlock(lvl);
-            this->unlock(lvl - 1);
+            m_dirtyRects[lvl + 1].merge(dstRect);
         }
+        m_dirtyRects[m_mipLevel - 1] = Rect();
     }
-    void* Texture2D::lock(uint32_t mipLevel, const Rect *rect)
+    LockedRect Texture2D::lock(uint32_t mipLevel, const Rect *rect, LockMode mode)
     {
         assert(mipLevel < m_mipLevel);
         assert(m_surfaces[mipLevel]);
-        return m_surfaces[mipLevel]->lock(rect);
+        return m_surfaces[mipLevel]->lock(rect, mode);
     }
-    void Texture2D::unlock(uint32_t mipLevel)
+    void Texture2D::unlock(uint32_t mipLevel, const LockedRect& locked)
     {
         assert(mipLevel < m_mipLevel);
         assert(m_surfaces[mipLevel]);
-        m_surfaces[mipLevel]->unlock();
+        m_surfaces[mipLevel]->unlock(locked);
+        if(locked.mode == LockMode::READ_WRITE)
+            m_dirtyRects[mipLevel].merge(locked.rect);
+    }
+    const Rect& Texture2D::getDirtyRect(uint32_t mipLevel) const
+    {
+        assert(mipLevel < m_mipLevel);
+        return m_dirtyRects[mipLevel];
     }
     Surface* Texture2D::getMipSurface(uint32_t mipLevel) const
     {
@@ -5,6 +5,8 @@
 #include <limits>
 #include <memory>
 #include <cassert>
+#include <mutex>
+#include <vector>
 namespace rl {
     using ColorValue =  Vec4;
 	///////////////////////////////////////////////////////////
@@ -45,60 +47,151 @@ namespace rl {
 		std::unique_ptr<uint8_t[]> m_data;
 	};
 	///////////////////////////////////////////////////////////
+	//ConstantBuffer
+	///////////////////////////////////////////////////////////
+	// Vec4Ϊλĳ, ɱShader(Shader::setConstantBuffer)
+	// drawʼʱShaderȡõǰݵֻsnapshot; snapshot֮ĵһupdateȸһд(copy-on-write), snapshotֲ,
+	// ˿drawиһ֡ĳ. snapshotdrawʱͷ, VisibilityBufferм¼drawеclear
+	// updatesnapshotm_mutexл, ǷҲھ: һ߳update, Pipelinedraw߳snapshot
+	class ConstantBuffer
+	{
+	public:
+        using Snapshot = std::shared_ptr<const std::vector<Vec4>>;
+	public:
+		explicit ConstantBuffer(uint32_t vec4Count);
+		~ConstantBuffer();
+	public:
+        // ӵoffsetVec4ʼд; Float/Vec2/Vec3ֻдһVec4ǰ, Mat4ռ4Vec4
+        template <typename T>
+        void update(uint32_t offset, const T& val);
+        void update(uint32_t offset, const Vec4* data, uint32_t count);
+        // ûupdateʱ, snapshotͬһ
+        Snapshot snapshot();
+
+        uint32_t getVec4Count() const;
+        // snapshot֮ĵһupdateʹversion1
+        uint32_t getVersion() const;
+	private:
+        void _write(uint32_t offset, const void* src, uint32_t bytes);
+	private:
+        mutable std::mutex m_mutex;
+        std::shared_ptr<std::vector<Vec4>> m_data;
+        uint32_t m_vec4Count;
+        uint32_t m_version = 0;
+        bool     m_shared  = false; // m_dataѽsnapshot, һupdateȸ
+        bool     m_dirty   = false; // һsnapshot֮йupdate
+	};
+	///////////////////////////////////////////////////////////
 	// Surface
 	///////////////////////////////////////////////////////////
+    enum class LockMode
+    {
+        READ_ONLY,  // READ_ONLYͬʱlock
+        READ_WRITE, // ཻrectͬʱlockд
+    };
+    // lock()صSurface洢ͼ,ٲ
+    struct LockedRect
+    {
+        // ָrectϽǵelement; ѹʽʱָϽǵblock
+        // 8-bitʽʱֽѰַ(һFloat), תΪuint8_t*ʹ
+        Float*   data  = nullptr;
+        uint32_t pitch = 0;       // ֮Float; ѹʽʱΪblock
+        Rect     rect;
+        LockMode mode  = LockMode::READ_WRITE;
+
+        Float* row(uint32_t y) const
+        {
+            return data + y * pitch;
+        }
+    };
 	class Surface
 	{
 	public:
 		Surface(uint32_t width, uint32_t height, Format fmt);
+        // ʹⲿĴ洢(getPitch()Ĳ), dataSurface, Surfaceþ
+		Surface(uint32_t width, uint32_t height, Format fmt, Float* data);
+        // multisampled: sampleCountΪ1,2,48; ÿpixelĸsample, ֻ֧Floatʽ
+        // þع캯: (w, h, fmt, 0)Float*汾
+        static std::unique_ptr<Surface> createMultisample(uint32_t width, uint32_t height, Format fmt, uint32_t sampleCount);
 	   ~Surface();
 
 		const ColorValue samplePoint(Float u, Float v) const;
 		const ColorValue sampleLinear(Float u, Float v) const;
 		void clear(const ColorValue& val, const Rect* rect = nullptr);
 		void copyTo(const Rect *srcRect, Surface *dstSurface, const Rect *destRect, FilterType filterType);
+        // ÿpixelsampleƽֵдͬߴͬFormatĵsample Surface
+        void resolve(Surface* dstSurface);
 
-		Float* lock(const Rect *rect = nullptr);
-		void   unlock();
+		LockedRect lock(const Rect *rect = nullptr, LockMode mode = LockMode::READ_WRITE);
+		void       unlock(const LockedRect& locked);
 
 		Format   getFormat()           const;
 		uint32_t getFormatFloatCount() const;
         uint32_t getFormatByteCount()  const;
 		uint32_t getWidth()            const;
 		uint32_t getHeight()           const;
+        uint32_t getSampleCount()      const;
+        // in Floats; multisampledʱһpixelsample
+        uint32_t getPitch()            const;
 
         ColorValue getElement(uint32_t x, uint32_t y) const;
         ColorValue getElement(uint32_t index)         const;
+        // ֻ, lock; Samplertexelȡ
+        const Float* getData() const;
+        // ݰ汾: ÿREAD_WRITEunlockı
+        uint32_t     getVersion() const;
 
 		const Rect getRect() const;
 	private:
+        struct MultisampleTag {};
+        Surface(uint32_t width, uint32_t height, Format fmt, uint32_t sampleCount, MultisampleTag);
 
 		Format	 m_format;
 		uint32_t m_width;
 		uint32_t m_height;
+        uint32_t m_sampleCount = 1;
 
-		bool	m_allLocked;
-		Rect	m_lockedRect;
-		std::unique_ptr<Float[]> m_lockedData;
-		// m_width * m_heightelement
-		std::unique_ptr<Float[]> m_data;
+		// m_width * m_heightelement; ѹʽʱΪеblock
+		std::unique_ptr<Float[]> m_storage; // ʹⲿ洢ʱΪ
+		Float*                   m_data;
+        uint32_t                 m_version;
+#ifdef _DEBUG
+        // ֻڼlockͻ
+        std::mutex              m_lockMutex;
+        std::vector<LockedRect> m_locks;
+#endif
 	};
     ///////////////////////////////////////////////////////////
     // Texture
     ///////////////////////////////////////////////////////////
+    enum class TextureType
+    {
+        TEXTURE_2D,
+        VIRTUAL_TEXTURE_2D,
+    };
     class Texture
     {
     public:
-        explicit Texture() {};
+        explicit Texture(TextureType type): m_type(type) {};
         virtual ~Texture() {};
 
     public:
         virtual ColorValue sample(Float u, Float v, Float w, const Vec4 *xGradient, const Vec4 *yGradient, const uint32_t* samplerStates) = 0;
+        TextureType getType() const { return m_type; }
+    private:
+        TextureType m_type;
     };
     ///////////////////////////////////////////////////////////
     // Texture2D
     ///////////////////////////////////////////////////////////
     //todo: Texture1D, Texture3D
+    // mipõ²filter; ȷߴ
+    enum class MipFilter
+    {
+        BOX,    // Ȩ: żߴΪ2-tap, ߴΪ3-tap
+        KAISER, // Kaisersinc, , ۸
+    };
+    class TextureFile;
     class Texture2D: public Texture
     {
     public:
@@ -115,6 +208,7 @@ namespace rl {
             const void* mem = nullptr;
             uint32_t    memPitch;
             uint32_t    memSlicePitch;
+            MipFilter   mipFilter = MipFilter::BOX;
 
             //D3D11_USAGE  Usage;
             //uint32_t     BindFlags;
@@ -123,14 +217,20 @@ namespace rl {
         };
     public:
         Texture2D(const Desc& desc);
+        // ֱʹfileӳĸmip, Ҳmip; fileTexture2Dǰӳ
+        explicit Texture2D(std::shared_ptr<TextureFile> file);
         virtual ~Texture2D();
         virtual ColorValue sample(Float u, Float v, Float w, const Vec4 *xGradient, const Vec4 *yGradient, const uint32_t* samplerStates) override;
     public:
-        // baseLevelΪ׼ʼеmip
-        void  generateMips(uint32_t baseLevel = 0);
-        void  clear(uint32_t mipLevel, const ColorValue& colorVal, const Rect* rect = nullptr);
-        void* lock(uint32_t mipLevel, const Rect* rect = nullptr);
-        void  unlock(uint32_t mipLevel);
+        // baseLevelΪ׼ʼеmip; зָ߳
+        void       generateMips(uint32_t baseLevel = 0, MipFilter filter = MipFilter::BOX);
+        // ֻdirty(unlock(READ_WRITE)clearʱ¼)ڸmipӰ쵽Ĳ
+        void       updateMips(MipFilter filter = MipFilter::BOX);
+        // üдδݵһ; θдϲΪһRect
+        const Rect& getDirtyRect(uint32_t mipLevel) const;
+        void       clear(uint32_t mipLevel, const ColorValue& colorVal, const Rect* rect = nullptr);
+        LockedRect lock(uint32_t mipLevel, const Rect* rect = nullptr, LockMode mode = LockMode::READ_WRITE);
+        void       unlock(uint32_t mipLevel, const LockedRect& locked);
 
         Surface* getMipSurface(uint32_t mipLevel)     const;
         uint32_t getMipLevel  ()                      const;
@@ -142,6 +242,8 @@ namespace rl {
         uint32_t  m_mipLevel; //0: ʾȫmipmap; 1: ʾmultisample
         uint32_t  m_widthSq, m_heightSq;
         Surface** m_surfaces = nullptr;
+        std::unique_ptr<Rect[]> m_dirtyRects;
+        std::shared_ptr<TextureFile> m_file;
     };
 }//ns rl
  // inline 
@@ -178,6 +280,28 @@ namespace rl
 		assert(offsetInCount * sizeof(T) < m_length);
 		return reinterpret_cast<T*>(m_data.get()) + offsetInCount;
 	}
+	////////////////////////////////////////////////////////////////////////
+	// ConstantBuffer
+	////////////////////////////////////////////////////////////////////////
+    template <typename T>
+    inline void ConstantBuffer::update(uint32_t offset, const T& val)
+    {
+        static_assert(sizeof(T) % sizeof(Float) == 0, "");
+        this->_write(offset, &val, sizeof(T));
+    }
+    inline void ConstantBuffer::update(uint32_t offset, const Vec4* data, uint32_t count)
+    {
+        this->_write(offset, data, count * sizeof(Vec4));
+    }
+    inline uint32_t ConstantBuffer::getVec4Count() const
+    {
+        return m_vec4Count;
+    }
+    inline uint32_t ConstantBuffer::getVersion() const
+    {
+        std::lock_guard<std::mutex> guard(m_mutex);
+        return m_version;
+    }
 	////////////////////////////////////////////////////////////////////////
 	// Surface
 	////////////////////////////////////////////////////////////////////////
@@ -205,7 +329,23 @@ namespace rl
 	}
     inline uint32_t Surface::getFormatByteCount()  const
     {
-        return this->getFormatFloatCount() * sizeof(Float);
+        return byte_count(m_format);
+    }
+    inline uint32_t Surface::getSampleCount() const
+    {
+        return m_sampleCount;
+    }
+    inline uint32_t Surface::getPitch() const
+    {
+        return surface_pitch(m_width, m_format) * m_sampleCount;
+    }
+    inline const Float* Surface::getData() const
+    {
+        return m_data;
+    }
+    inline uint32_t Surface::getVersion() const
+    {
+        return m_version;
     }
     ////////////////////////////////////////////////////////////////////////
 	// Surface
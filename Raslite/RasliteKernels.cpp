@@ -0,0 +1,101 @@
+#include "RasliteKernels.h"
+#include <cassert>
+#include <cstdlib>
+#include <cstring>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#else
+#include <cpuid.h>
+#endif
+namespace rl {
+    namespace detail
+    {
+        static void cpuid(uint32_t leaf, uint32_t subleaf, uint32_t regs[4])
+        {
+#if defined(_MSC_VER)
+            int r[4];
+            __cpuidex(r, int(leaf), int(subleaf));
+            for(uint32_t i = 0; i < 4; ++i)
+                regs[i] = uint32_t(r[i]);
+#else
+            __cpuid_count(leaf, subleaf, regs[0], regs[1], regs[2], regs[3]);
+#endif
+        }
+        // XCR0: OSлʱᱣЩĴ
+        static uint64_t xgetbv0()
+        {
+#if defined(_MSC_VER)
+            return _xgetbv(0);
+#else
+            uint32_t eax, edx;
+            __asm__ volatile("xgetbv" : "=a"(eax), "=d"(edx) : "c"(0));
+            return (uint64_t(edx) << 32) | eax;
+#endif
+        }
+        static const char* const s_simdLevelNames[] = { "sse2", "sse4.1", "avx2", "avx512" };
+
+        static Kernels select_kernels()
+        {
+            auto level = cpu_simd_level();
+            // RASLITE_SIMDֻܽ; δֵ֪򳬳CPUʱ
+            if(const char* env = std::getenv("RASLITE_SIMD"))
+            {
+                for(uint32_t i = 0; i <= uint32_t(level); ++i)
+                {
+                    if(std::strcmp(env, s_simdLevelNames[i]) == 0)
+                    {
+                        level = SIMDLevel(i);
+                        break;
+                    }
+                }
+            }
+            switch(level)
+            {
+            case SIMDLevel::AVX512:
+                return kernels_avx512();
+            case SIMDLevel::AVX2:
+                return kernels_avx2();
+            case SIMDLevel::SSE4_1:
+                return kernels_sse41();
+            default:
+                return kernels_sse2();
+            }
+        }
+    }
+    SIMDLevel cpu_simd_level()
+    {
+        uint32_t regs[4];
+        detail::cpuid(0, 0, regs);
+        const auto maxLeaf = regs[0];
+        detail::cpuid(1, 0, regs);
+        const bool sse41   = (regs[2] >> 19) & 1;
+        const bool fma     = (regs[2] >> 12) & 1;
+        const bool osxsave = (regs[2] >> 27) & 1;
+        const bool avx     = (regs[2] >> 28) & 1;
+        if(!sse41)
+            return SIMDLevel::SSE2;
+        if(!osxsave || !avx || !fma || maxLeaf < 7)
+            return SIMDLevel::SSE4_1;
+        const auto xcr0 = detail::xgetbv0();
+        if((xcr0 & 0x6) != 0x6) // XMM|YMM
+            return SIMDLevel::SSE4_1;
+        detail::cpuid(7, 0, regs);
+        const bool avx2    = (regs[1] >> 5) & 1;
+        const bool avx512f = (regs[1] >> 16) & 1;
+        if(!avx2)
+            return SIMDLevel::SSE4_1;
+        if(avx512f && (xcr0 & 0xe0) == 0xe0) // opmask|ZMM0-15256λ|ZMM16-31
+            return SIMDLevel::AVX512;
+        return SIMDLevel::AVX2;
+    }
+    const char* simd_level_name(SIMDLevel level)
+    {
+        assert(uint32_t(level) < sizeof(detail::s_simdLevelNames) / sizeof(detail::s_simdLevelNames[0]));
+        return detail::s_simdLevelNames[uint32_t(level)];
+    }
+    const Kernels& kernels()
+    {
+        static const Kernels s_kernels = detail::select_kernels();
+        return s_kernels;
+    }
+}//ns rl
@@ -0,0 +1,96 @@
+#ifndef RASLITE_KERNELS_H
+#define RASLITE_KERNELS_H
+#include <cstdint>
+namespace rl {
+    /////////////////////////////////////////////////////////////////
+    // ȵں˵Ķָ汾, ʱCPUIDѡһ
+    // ں˷뵥ԪԲͬ/arch, ֻܰRasliteSIMD.h뱾ļ,
+    // ͷļе(иָһ)
+    /////////////////////////////////////////////////////////////////
+    // ɵ͵
+    enum class SIMDLevel : uint8_t
+    {
+        SSE2,
+        SSE4_1,
+        AVX2,   // ͬʱҪFMA
+        AVX512, // AVX512F
+    };
+    // ǰCPUOS(XCR0˶ӦļĴ״̬)ͬʱֵ֧ߵȼ
+    SIMDLevel cpu_simd_level();
+    // "sse2", "sse4.1", "avx2", "avx512"
+    const char* simd_level_name(SIMDLevel level);
+
+    // ں˵ĲֻPOD: öֵٰ(ͬRasliteCommon.hеĶ), ͷļ
+
+    // ε߷E(x, y) = ax + by + cƽ, pixel(x + 0.5, y + 0.5)ֵ
+    struct RasterSpan
+    {
+        float edgeA[3];
+        float edgeB[3];
+        float edgeC[3];
+        bool  edgeTopLeft[3]; // E == 0ʱǷ㸲(top-left)
+        float depthA, depthB, depthC;
+    };
+    // Blend::enabledʱblend state: ֵͬBlendFactor/BlendOp
+    struct BlendState
+    {
+        uint32_t srcBlend;
+        uint32_t dstBlend;
+        uint32_t blendOp;
+        uint32_t srcBlendAlpha;
+        uint32_t dstBlendAlpha;
+        uint32_t blendOpAlpha;
+        float    factor[4];
+    };
+    // floatʽ(R32_FLOAT ~ R32G32B32A32_FLOAT)һmip levelѰַʽ
+    // texel(x, y)ĵcΪdata[y * pitch + x * channels + c], ȱٵķΪ(0,0,0,1)
+    struct SampleMip
+    {
+        const float* data;
+        int32_t      width;
+        int32_t      height;
+        uint32_t     pitch;    // in floats
+        uint32_t     channels; // 1~4
+        uint32_t     addressU; // ͬAddressMode
+        uint32_t     addressV;
+        int32_t      offsetX;  // texelƫ, Ѱַ֮ǰ
+        int32_t      offsetY;
+        float        borderColor[4];
+    };
+
+    struct Kernels
+    {
+        SIMDLevel level;
+        // patternǰpatternCount(1~4)floatѭdstcountfloat
+        void (*fill)(float* dst, uint32_t count, const float* pattern, uint32_t patternCount);
+        // ÿȡsrcǰ3float(rgb), *255clamp[0,255], Ϊ0x00RRGGBB; stride>=3
+        void (*packRGB8)(const float* src, uint32_t stride, uint32_t count, uint32_t* dst);
+        // դһе(x..x+count-1, y), count <= 32: رθǵpixel, iλӦx + i
+        uint32_t (*coverSpan)(const RasterSpan& span, int32_t x, int32_t y, uint32_t count);
+        // ͬcoverSpan, ҸǵpixelȲ: depth[i * depthStride]Ϊx + i, cmpFuncͬCmpFunc
+        // ͨpixeldepthWriteʱд; ظͨpixel
+        uint32_t (*depthSpan)(const RasterSpan& span, int32_t x, int32_t y, uint32_t count,
+                              float* depth, uint32_t depthStride, uint32_t cmpFunc, bool depthWrite);
+        // src: countPixelShaderrgba; dst[i]: render targetpixelfloatCount(1~4), ȱٵΪ(0,0,0,1)
+        // blendдdst[i]
+        void (*blend)(const BlendState& state, const float* src, float* const* dst, uint32_t count, uint32_t floatCount);
+        // mipϲcount(u[i], v[i]): linearʱΪbilinear, Ϊpoint
+        // SoAд: out[c * count + i]Ϊlane iĵc
+        void (*sampleFloat)(const SampleMip& mip, const float* u, const float* v, uint32_t count, bool linear, float* out);
+        // countclip spaceposition(xyzw)任raster space: xyzw, xy clamp0.99999, z clamp[0, 0.99999],
+        // ٳviewport(, д洢), wдΪ1/w; w < FLT_EPSILONpositionֲ
+        void (*viewportTransform)(float* positions, uint32_t count, const float viewport[16]);
+    };
+    // ״εʱѡ: ĬΪcpu_simd_level(); RASLITE_SIMD(ͬsimd_level_name)ָ͵ĵȼ, ڶԱȲ
+    const Kernels& kernels();
+
+    namespace detail
+    {
+        // ָ汾ĺ, ֱRasliteKernelsXXX.cpp
+        Kernels kernels_sse2();
+        Kernels kernels_sse41();
+        Kernels kernels_avx2();
+        Kernels kernels_avx512();
+    }
+}//ns rl
+#endif //RASLITE_KERNELS_H
@@ -0,0 +1,11 @@
+// AVX2: ļ/arch:AVX2, 8 lane
+#include "RasliteKernelsImpl.h"
+#if !defined(RL_SIMD_AVX2) && !defined(RL_SIMD_REF)
+#error ļҪ/arch:AVX2
+#endif
+namespace rl {
+    Kernels detail::kernels_avx2()
+    {
+        return make_kernels(SIMDLevel::AVX2);
+    }
+}//ns rl
@@ -0,0 +1,11 @@
+// AVX-512: ļ/arch:AVX512, 16 lane
+#include "RasliteKernelsImpl.h"
+#if !defined(RL_SIMD_AVX512) && !defined(RL_SIMD_REF)
+#error ļҪ/arch:AVX512
+#endif
+namespace rl {
+    Kernels detail::kernels_avx512()
+    {
+        return make_kernels(SIMDLevel::AVX512);
+    }
+}//ns rl
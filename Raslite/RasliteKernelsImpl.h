@@ -0,0 +1,390 @@
+#ifndef RASLITE_KERNELS_IMPL_H
+#define RASLITE_KERNELS_IMPL_H
+// ںʵ, ɸRasliteKernelsXXX.cppԶӦָ
+// ȫnamespace: ÿ뵥Ԫһ, ͬŻ滻
+#include "RasliteKernels.h"
+#include "RasliteSIMD.h"
+#include <cfloat>
+namespace rl {
+    namespace
+    {
+        // (0, 1, 2, ...)
+        inline floatN laneIndex()
+        {
+            static const float INDEX[16] = { 0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15 };
+            return floatN::load(INDEX);
+        }
+        // lane i = p[i * stride], ֻȡǰn, laneΪ0
+        inline floatN loadLanes(const float* p, uint32_t stride, uint32_t n)
+        {
+            if(n == SIMD_LANE_COUNT)
+                return stride == 1 ? floatN::load(p) : floatN::gather(p, stride);
+            float lanes[SIMD_LANE_COUNT] = {};
+            for(uint32_t i = 0; i < n; ++i)
+                lanes[i] = p[i * stride];
+            return floatN::load(lanes);
+        }
+        // p[i * stride] = lane i, ֻдǰn
+        inline void storeLanes(const floatN& v, float* p, uint32_t stride, uint32_t n)
+        {
+            if(n == SIMD_LANE_COUNT && stride == 1)
+                return v.store(p);
+            float lanes[SIMD_LANE_COUNT];
+            v.store(lanes);
+            for(uint32_t i = 0; i < n; ++i)
+                p[i * stride] = lanes[i];
+        }
+        inline floatN clampLanes(const floatN& v, float lo, float hi)
+        {
+            return min(max(v, floatN(lo)), floatN(hi));
+        }
+        void fill(float* dst, uint32_t count, const float* pattern, uint32_t patternCount)
+        {
+            assert(1 <= patternCount && patternCount <= 4);
+            // patternCountfloatNøpatternCount*SIMD_LANE_COUNTfloat, ֮󰴴ظ
+            const auto period = patternCount * SIMD_LANE_COUNT;
+            float  expanded[4 * SIMD_LANE_COUNT];
+            floatN lanes[4];
+            for(uint32_t j = 0; j < period; ++j)
+                expanded[j] = pattern[j % patternCount];
+            for(uint32_t k = 0; k < patternCount; ++k)
+                lanes[k] = floatN::load(expanded + k * SIMD_LANE_COUNT);
+            uint32_t i = 0;
+            for(; i + period <= count; i += period)
+                for(uint32_t k = 0; k < patternCount; ++k)
+                    lanes[k].store(dst + i + k * SIMD_LANE_COUNT);
+            for(; i < count; ++i)
+                dst[i] = pattern[i % patternCount];
+        }
+        // *255clamp[0,255], 0.5ضϼΪ
+        inline float unorm8Channel(float v)
+        {
+            v *= 255.0f;
+            return (v > 0.0f ? (v < 255.0f ? v : 255.0f) : 0.0f) + 0.5f;
+        }
+        void packRGB8(const float* src, uint32_t stride, uint32_t count, uint32_t* dst)
+        {
+            assert(stride >= 3);
+            const floatN scale(255.0f), lo(0.0f), hi(255.0f), half(0.5f);
+            uint32_t i = 0;
+            for(; i + SIMD_LANE_COUNT <= count; i += SIMD_LANE_COUNT)
+            {
+                const auto p = src + i * stride;
+                const auto r = trunc(min(max(floatN::gather(p,     stride) * scale, lo), hi) + half);
+                const auto g = trunc(min(max(floatN::gather(p + 1, stride) * scale, lo), hi) + half);
+                const auto b = trunc(min(max(floatN::gather(p + 2, stride) * scale, lo), hi) + half);
+                // r*65536+g*256+b < 2^24, floatɾȷʾ
+                (r * 65536.0f + g * 256.0f + b).storeInt(reinterpret_cast<int32_t*>(dst + i));
+            }
+            for(; i < count; ++i)
+            {
+                const auto p = src + i * stride;
+                dst[i] = (uint32_t(unorm8Channel(p[0])) << 16) | (uint32_t(unorm8Channel(p[1])) << 8) | uint32_t(unorm8Channel(p[2]));
+            }
+        }
+        /////////////////////////////////////////////////////////////////
+        // դ
+        // ߶ڲ: E > 0, E == 0Ϊtop-left; ֵ˳ͬEdgeEquation::evaluate
+        inline maskN spanInside(const RasterSpan& span, const floatN& px, float py)
+        {
+            auto inside = [&](uint32_t k)
+            {
+                const auto e = floatN(span.edgeA[k]) * px + floatN(span.edgeB[k] * py) + floatN(span.edgeC[k]);
+                return span.edgeTopLeft[k] ? e >= floatN(0.0f) : e > floatN(0.0f);
+            };
+            return inside(0) & inside(1) & inside(2);
+        }
+        // pixelĵx: x + i + 0.5
+        inline floatN spanCenters(int32_t x)
+        {
+            return floatN(float(x)) + laneIndex() + floatN(0.5f);
+        }
+        inline uint32_t spanBits(uint32_t count)
+        {
+            return count < 32 ? (1u << count) - 1 : ~0u;
+        }
+        uint32_t coverSpan(const RasterSpan& span, int32_t x, int32_t y, uint32_t count)
+        {
+            assert(count <= 32);
+            const auto py = float(y) + 0.5f;
+            uint32_t covered = 0;
+            for(uint32_t i = 0; i < count; i += SIMD_LANE_COUNT)
+                covered |= spanInside(span, spanCenters(x + int32_t(i)), py).bits() << i;
+            return covered & spanBits(count);
+        }
+        // src OP dst, cmpFuncͬCmpFunc
+        inline maskN depthTest(uint32_t cmpFunc, const floatN& src, const floatN& dst)
+        {
+            switch(cmpFunc)
+            {
+            case 1: // NEVER
+                return maskN::fromBits(0);
+            case 2: // LESS
+                return src < dst;
+            case 3: // EQUAL
+                return src == dst;
+            case 4: // LESS_EQUAL
+                return src <= dst;
+            case 5: // GREATER
+                return src > dst;
+            case 6: // NOT_EQUAL
+                return src != dst;
+            case 7: // GREATER_EQUAL
+                return src >= dst;
+            case 8: // ALWAYS
+                return maskN::fromBits(~0u);
+            default:
+                assert(false && "ǷCmpFunc!");
+                return maskN::fromBits(0);
+            }
+        }
+        uint32_t depthSpan(const RasterSpan& span, int32_t x, int32_t y, uint32_t count,
+                           float* depth, uint32_t depthStride, uint32_t cmpFunc, bool depthWrite)
+        {
+            assert(count <= 32);
+            const auto py = float(y) + 0.5f;
+            uint32_t passed = 0;
+            for(uint32_t i = 0; i < count; i += SIMD_LANE_COUNT)
+            {
+                const auto n  = count - i < SIMD_LANE_COUNT ? count - i : SIMD_LANE_COUNT;
+                const auto px = spanCenters(x + int32_t(i));
+                auto mask = spanInside(span, px, py).bits() & spanBits(n);
+                if(!mask)
+                    continue;
+                const auto dst = depth + i * depthStride;
+                const auto z   = floatN(span.depthA) * px + floatN(span.depthB * py) + floatN(span.depthC);
+                mask &= depthTest(cmpFunc, z, loadLanes(dst, depthStride, n)).bits();
+                if(depthWrite && mask)
+                {
+                    float lanes[SIMD_LANE_COUNT];
+                    z.store(lanes);
+                    for(uint32_t k = 0; k < n; ++k)
+                    {
+                        if(mask & (1u << k))
+                            dst[k * depthStride] = lanes[k];
+                    }
+                }
+                passed |= mask << i;
+            }
+            return passed;
+        }
+        /////////////////////////////////////////////////////////////////
+        // blend
+        // c(0~3Ϊrgba)blend factor, ͬD3D: colorfactoralpha
+        inline floatN blendFactor(uint32_t factor, const floatN src[4], const floatN dst[4], const float constant[4], uint32_t c)
+        {
+            const floatN one(1.0f);
+            switch(factor)
+            {
+            case 1: // ZERO
+                return floatN(0.0f);
+            case 2: // ONE
+                return one;
+            case 3: // SRC_COLOR
+                assert(c < 3 && "alphaֵΪcolor");
+                return src[c];
+            case 4: // INV_SRC_COLOR
+                assert(c < 3 && "alphaֵΪcolor");
+                return one - src[c];
+            case 5: // SRC_ALPHA
+                return src[3];
+            case 6: // INV_SRC_ALPHA
+                return one - src[3];
+            case 7: // DEST_ALPHA
+                return dst[3];
+            case 8: // INV_DEST_ALPHA
+                return one - dst[3];
+            case 9: // DEST_COLOR
+                assert(c < 3 && "alphaֵΪcolor");
+                return dst[c];
+            case 10: // INV_DEST_COLOR
+                assert(c < 3 && "alphaֵΪcolor");
+                return one - dst[c];
+            case 11: // SRC_ALPHA_SAT
+                return clampLanes(src[3], 0.0f, 1.0f);
+            case 14: // BLEND_FACTOR
+                return floatN(constant[c]);
+            case 15: // INV_BLEND_FACTOR
+                return floatN(1.0f - constant[c]);
+            default: // SRC1_*
+                assert(false && "δʵdual source color blending");
+                return floatN(0.0f);
+            }
+        }
+        inline floatN blendOperation(uint32_t op, const floatN& src, const floatN& dst)
+        {
+            switch(op)
+            {
+            case 1: // ADD
+                return src + dst;
+            case 2: // SUBTRACT
+                return dst - src;
+            case 3: // REV_SUBTRACT
+                return src - dst;
+            case 4: // MIN
+                return min(src, dst);
+            case 5: // MAX
+                return max(src, dst);
+            default:
+                assert(false && "ǷBlendOp!");
+                return floatN(0.0f);
+            }
+        }
+        void blend(const BlendState& state, const float* src, float* const* dst, uint32_t count, uint32_t floatCount)
+        {
+            assert(1 <= floatCount && floatCount <= 4);
+            for(uint32_t i = 0; i < count; i += SIMD_LANE_COUNT)
+            {
+                const auto n = count - i < SIMD_LANE_COUNT ? count - i : SIMD_LANE_COUNT;
+                // dstpixel, Ȱת
+                float dstLanes[4][SIMD_LANE_COUNT] = {};
+                for(uint32_t k = 0; k < n; ++k)
+                {
+                    for(uint32_t c = 0; c < 4; ++c)
+                        dstLanes[c][k] = c < floatCount ? dst[i + k][c] : (c == 3 ? 1.0f : 0.0f);
+                }
+                floatN s[4], d[4];
+                for(uint32_t c = 0; c < 4; ++c)
+                {
+                    s[c] = loadLanes(src + i * 4 + c, 4, n);
+                    d[c] = floatN::load(dstLanes[c]);
+                }
+                for(uint32_t c = 0; c < floatCount; ++c)
+                {
+                    const auto srcFactor = blendFactor(c < 3 ? state.srcBlend : state.srcBlendAlpha, s, d, state.factor, c);
+                    const auto dstFactor = blendFactor(c < 3 ? state.dstBlend : state.dstBlendAlpha, s, d, state.factor, c);
+                    blendOperation(c < 3 ? state.blendOp : state.blendOpAlpha, s[c] * srcFactor, d[c] * dstFactor).store(dstLanes[c]);
+                }
+                for(uint32_t k = 0; k < n; ++k)
+                {
+                    for(uint32_t c = 0; c < floatCount; ++c)
+                        dst[i + k][c] = dstLanes[c][k];
+                }
+            }
+        }
+        /////////////////////////////////////////////////////////////////
+        // 
+        // ֵtexel갴AddressModeѰַ; border: BORDER֮lane(ֵΪ0)
+        inline floatN addressLanes(uint32_t mode, const floatN& i, int32_t size, maskN& border)
+        {
+            const auto s = floatN(float(size)), zero = floatN(0.0f), last = floatN(float(size - 1));
+            switch(mode)
+            {
+            case 1: // WRAP
+                return clampLanes(i - floor(i / s) * s, 0.0f, float(size - 1));
+            case 2: // MIRROR
+            {
+                const auto period = floatN(float(size * 2));
+                const auto m = clampLanes(i - floor(i / period) * period, 0.0f, float(size * 2 - 1));
+                return select(m < s, m, period - floatN(1.0f) - m);
+            }
+            case 4: // BORDER
+                border = border | (i < zero) | (i > last);
+                return select(border, zero, i);
+            case 5: // MIRROR_ONCE
+                return min(select(i < zero, floatN(-1.0f) - i, i), last);
+            default: // CLAMP
+                assert(mode == 3 && "ǷAddressMode!");
+                return min(max(i, zero), last);
+            }
+        }
+        // NaN0, ڡ2^24(floatɾȷʾ), Ѱַ±texture
+        inline floatN sanitizeLanes(const floatN& v)
+        {
+            return clampLanes(select(v == v, v, floatN(0.0f)), -16777216.0f, 16777216.0f);
+        }
+        // ȡ(x, y)texel, x/yΪֵ, Ѱַǰoffset
+        inline void fetchLanes(const SampleMip& mip, const floatN& x, const floatN& y, floatN texel[4])
+        {
+            auto border = maskN::fromBits(0);
+            const auto ax = addressLanes(mip.addressU, sanitizeLanes(x + floatN(float(mip.offsetX))), mip.width,  border);
+            const auto ay = addressLanes(mip.addressV, sanitizeLanes(y + floatN(float(mip.offsetY))), mip.height, border);
+            // ±, texturefloatľȷΧ
+            int32_t xi[SIMD_LANE_COUNT], yi[SIMD_LANE_COUNT], index[SIMD_LANE_COUNT];
+            ax.storeInt(xi);
+            ay.storeInt(yi);
+            for(uint32_t k = 0; k < SIMD_LANE_COUNT; ++k)
+                index[k] = yi[k] * int32_t(mip.pitch) + xi[k] * int32_t(mip.channels);
+            for(uint32_t c = 0; c < 4; ++c)
+                texel[c] = c < mip.channels ? floatN::gatherIndexed(mip.data + c, index) : floatN(c == 3 ? 1.0f : 0.0f);
+            if(mip.addressU == 4 || mip.addressV == 4)
+            {
+                for(uint32_t c = 0; c < 4; ++c)
+                    texel[c] = select(border, floatN(mip.borderColor[c]), texel[c]);
+            }
+        }
+        void sampleFloat(const SampleMip& mip, const float* u, const float* v, uint32_t count, bool linear, float* out)
+        {
+            assert(1 <= mip.channels && mip.channels <= 4);
+            const floatN width(float(mip.width)), height(float(mip.height));
+            for(uint32_t i = 0; i < count; i += SIMD_LANE_COUNT)
+            {
+                const auto n = count - i < SIMD_LANE_COUNT ? count - i : SIMD_LANE_COUNT;
+                // bilinearʱtexelλ+0.5
+                const floatN half(linear ? 0.5f : 0.0f);
+                const auto x  = loadLanes(u + i, 1, n) * width  - half;
+                const auto y  = loadLanes(v + i, 1, n) * height - half;
+                const auto x0 = floor(x), y0 = floor(y);
+                floatN result[4];
+                if(!linear)
+                    fetchLanes(mip, x0, y0, result);
+                else
+                {
+                    const auto fx = x - x0, fy = y - y0;
+                    const auto x1 = x0 + floatN(1.0f), y1 = y0 + floatN(1.0f);
+                    floatN t00[4], t10[4], t01[4], t11[4];
+                    fetchLanes(mip, x0, y0, t00);
+                    fetchLanes(mip, x1, y0, t10);
+                    fetchLanes(mip, x0, y1, t01);
+                    fetchLanes(mip, x1, y1, t11);
+                    for(uint32_t c = 0; c < 4; ++c)
+                    {
+                        const auto top    = t00[c] + (t10[c] - t00[c]) * fx;
+                        const auto bottom = t01[c] + (t11[c] - t01[c]) * fx;
+                        result[c] = top + (bottom - top) * fy;
+                    }
+                }
+                for(uint32_t c = 0; c < 4; ++c)
+                    storeLanes(result[c], out + c * count + i, 1, n);
+            }
+        }
+        /////////////////////////////////////////////////////////////////
+        // 
+        void viewportTransform(float* positions, uint32_t count, const float viewport[16])
+        {
+            for(uint32_t i = 0; i < count; i += SIMD_LANE_COUNT)
+            {
+                const auto n = count - i < SIMD_LANE_COUNT ? count - i : SIMD_LANE_COUNT;
+                const auto p = positions + i * 4;
+                const auto x = loadLanes(p, 4, n), y = loadLanes(p + 1, 4, n), z = loadLanes(p + 2, 4, n), w = loadLanes(p + 3, 4, n);
+                // lane wΪ0, ֲͬ
+                const auto valid = ~(w < floatN(FLT_EPSILON));
+                const auto invW  = floatN(1.0f) / w;
+                // NDC -> raster space
+                const auto nx = clampLanes(x * invW, -0.99999f, 0.99999f);
+                const auto ny = clampLanes(y * invW, -0.99999f, 0.99999f);
+                const auto nz = clampLanes(z * invW,  0.0f,     0.99999f);
+                for(uint32_t c = 0; c < 3; ++c)
+                {
+                    const auto r = nx * floatN(viewport[c]) + ny * floatN(viewport[4 + c]) + nz * floatN(viewport[8 + c]) + floatN(viewport[12 + c]);
+                    storeLanes(select(valid, r, c == 0 ? x : (c == 1 ? y : z)), p + c, 4, n);
+                }
+                storeLanes(select(valid, invW, w), p + 3, 4, n);
+            }
+        }
+        inline Kernels make_kernels(SIMDLevel level)
+        {
+            Kernels k;
+            k.level             = level;
+            k.fill              = &fill;
+            k.packRGB8          = &packRGB8;
+            k.coverSpan         = &coverSpan;
+            k.depthSpan         = &depthSpan;
+            k.blend             = &blend;
+            k.sampleFloat       = &sampleFloat;
+            k.viewportTransform = &viewportTransform;
+            return k;
+        }
+    }
+}//ns rl
+#endif //RASLITE_KERNELS_IMPL_H
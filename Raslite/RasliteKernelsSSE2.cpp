@@ -0,0 +1,8 @@
+// SSE2: x86-64Ļ߰汾
+#include "RasliteKernelsImpl.h"
+namespace rl {
+    Kernels detail::kernels_sse2()
+    {
+        return make_kernels(SIMDLevel::SSE2);
+    }
+}//ns rl
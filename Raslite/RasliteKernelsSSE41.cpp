@@ -0,0 +1,11 @@
+// SSE4.1: MSVCûжӦ/arch, Ҳᶨ__SSE4_1__, ֶ(blendv/round)
+#ifndef RL_SIMD_SSE4_1
+#define RL_SIMD_SSE4_1
+#endif
+#include "RasliteKernelsImpl.h"
+namespace rl {
+    Kernels detail::kernels_sse41()
+    {
+        return make_kernels(SIMDLevel::SSE4_1);
+    }
+}//ns rl
@@ -62,20 +62,6 @@ namespace rl {
     const Vec4 Vec4::RED(1, 0, 0, 1);
     const Vec4 Vec4::GREEN(0, 1, 0, 1);
     const Vec4 Vec4::BLUE(0, 0, 1, 1);
-
-    const Vec4& Vec4::operator *= (const Mat4& rhs)
-    {
-        const auto xVal = rhs._11 * x + rhs._21 * y + rhs._31 * z + rhs._41 * w;
-        const auto yVal = rhs._12 * x + rhs._22 * y + rhs._32 * z + rhs._42 * w;
-        const auto zVal = rhs._13 * x + rhs._23 * y + rhs._33 * z + rhs._43 * w;
-        const auto wVal = rhs._14 * x + rhs._24 * y + rhs._34 * z + rhs._44 * w;
-        x = xVal; y = yVal; z = zVal; w = wVal;
-        return *this;
-    }
-    Vec4 Vec4::operator *(const Mat4 &rhs) const
-    {
-        return Vec4(*this) *= rhs;
-    }
 }//ns rb
 ///////////////////////////////////////////////////////////////////////////////////////////
 // Quat
@@ -133,27 +119,16 @@ namespace rl {
         0, 0, 0, 0);
     const Mat4& Mat4::operator *=(const Mat4& rhs)
     {
-        const auto f11 = _11 * rhs._11 + _12 * rhs._21 + _13 * rhs._31 + _14 * rhs._41;
-        const auto f12 = _11 * rhs._12 + _12 * rhs._22 + _13 * rhs._32 + _14 * rhs._42;
-        const auto f13 = _11 * rhs._13 + _12 * rhs._23 + _13 * rhs._33 + _14 * rhs._43;
-        const auto f14 = _11 * rhs._14 + _12 * rhs._24 + _13 * rhs._34 + _14 * rhs._44;
-        const auto f21 = _21 * rhs._11 + _22 * rhs._21 + _23 * rhs._31 + _24 * rhs._41;
-        const auto f22 = _21 * rhs._12 + _22 * rhs._22 + _23 * rhs._32 + _24 * rhs._42;
-        const auto f23 = _21 * rhs._13 + _22 * rhs._23 + _23 * rhs._33 + _24 * rhs._43;
-        const auto f24 = _21 * rhs._14 + _22 * rhs._24 + _23 * rhs._34 + _24 * rhs._44;
-        const auto f31 = _31 * rhs._11 + _32 * rhs._21 + _33 * rhs._31 + _34 * rhs._41;
-        const auto f32 = _31 * rhs._12 + _32 * rhs._22 + _33 * rhs._32 + _34 * rhs._42;
-        const auto f33 = _31 * rhs._13 + _32 * rhs._23 + _33 * rhs._33 + _34 * rhs._43;
-        const auto f34 = _31 * rhs._14 + _32 * rhs._24 + _33 * rhs._34 + _34 * rhs._44;
-        const auto f41 = _41 * rhs._11 + _42 * rhs._21 + _43 * rhs._31 + _44 * rhs._41;
-        const auto f42 = _41 * rhs._12 + _42 * rhs._22 + _43 * rhs._32 + _44 * rhs._42;
-        const auto f43 = _41 * rhs._13 + _42 * rhs._23 + _43 * rhs._33 + _44 * rhs._43;
-        const auto f44 = _41 * rhs._14 + _42 * rhs._24 + _43 * rhs._34 + _44 * rhs._44;
-
-        _11 = f11; _12 = f12; _13 = f13; _14 = f14;
-        _21 = f21; _22 = f22; _23 = f23; _24 = f24;
-        _31 = f31; _32 = f32; _33 = f33; _34 = f34;
-        _41 = f41; _42 = f42; _43 = f43; _44 = f44;
+        // ĵr = r() * rhs
+        for(size_t r = 0; r < 4; ++r)
+        {
+            const auto row = this->getSIMDRow(r);
+            auto v = simd::mul(simd::splatX(row), rhs.getSIMDRow(0));
+            v = simd::add(v, simd::mul(simd::splatY(row), rhs.getSIMDRow(1)));
+            v = simd::add(v, simd::mul(simd::splatZ(row), rhs.getSIMDRow(2)));
+            v = simd::add(v, simd::mul(simd::splatW(row), rhs.getSIMDRow(3)));
+            simd::storeu(v, m[r]);
+        }
         return *this;
     }
     static inline Float determinant2x2(const Float a, const Float b, const Float c, const Float d)
@@ -168,34 +143,24 @@ namespace rl {
               - b1 * determinant2x2(a2, a3, c2, c3)
               + c1 * determinant2x2(a2, a3, b2, b3);
     }
-    static Float determinantMinor(const Mat4 &val, const uint32_t row, const uint32_t col)
+    // 2x2(m11,m12,m21,m22)һSIMDFloat4_t; A#ʾAİ
+    // A*B
+    static inline SIMDFloat4_t mat2Mul(SIMDFloat4P_t a, SIMDFloat4P_t b)
     {
-        Float mat[3][3];
-
-        for(uint32_t r = 0, m = 0; r < 4; ++r)
-        {
-            if(r == row)
-                continue;
-            for(uint32_t c = 0, n = 0; c < 4; ++c)
-            {
-                if(c == col)
-                    continue;
-                mat[m][n] = val.m[r][c];
-                ++n;
-            }
-            ++m;
-        }
-        return determinant3x3(mat[0][0], mat[0][1], mat[0][2], mat[1][0], mat[1][1], mat[1][2], mat[2][0], mat[2][1], mat[2][2]);
+        return simd::add(simd::mul(a, simd::shuffle<0, 3, 0, 3>(b, b)),
+                         simd::mul(simd::shuffle<1, 0, 3, 2>(a, a), simd::shuffle<2, 1, 2, 1>(b, b)));
     }
-    static Mat4 _adjoint(const Mat4& m)
+    // A#*B
+    static inline SIMDFloat4_t mat2AdjMul(SIMDFloat4P_t a, SIMDFloat4P_t b)
     {
-        Mat4 matReturn;
-        for(uint32_t r = 0; r < 4; ++r)
-        {
-            for(uint32_t c = 0; c < 4; ++c)
-                matReturn.m[c][r] = powf(-1.0f, (Float)(r + c)) * determinantMinor(m, r, c);
-        }
-        return matReturn;
+        return simd::sub(simd::mul(simd::shuffle<3, 3, 0, 0>(a, a), b),
+                         simd::mul(simd::shuffle<1, 1, 2, 2>(a, a), simd::shuffle<2, 3, 0, 1>(b, b)));
+    }
+    // A*B#
+    static inline SIMDFloat4_t mat2MulAdj(SIMDFloat4P_t a, SIMDFloat4P_t b)
+    {
+        return simd::sub(simd::mul(a, simd::shuffle<3, 0, 3, 0>(b, b)),
+                         simd::mul(simd::shuffle<1, 0, 3, 2>(a, a), simd::shuffle<2, 1, 2, 1>(b, b)));
     }
     Float Mat4::determinant() const
     {
@@ -204,22 +169,62 @@ namespace rl {
              + _13 * determinant3x3(_21, _31, _41, _22, _32, _42, _24, _34, _44)
              - _14 * determinant3x3(_21, _31, _41, _22, _32, _42, _23, _33, _43);
     }
+    // ֿ: M = |A B|, 1/|M| * |X# Y#|
+    //                |C D|          |Z# W#|
     Mat4& Mat4::inverse()
     {
-        const auto d = this->determinant();
-        if(fabsf(d) < FLT_EPSILON)
+        const auto r0 = this->getSIMDRow(0);
+        const auto r1 = this->getSIMDRow(1);
+        const auto r2 = this->getSIMDRow(2);
+        const auto r3 = this->getSIMDRow(3);
+        const auto a  = simd::shuffle<0, 1, 0, 1>(r0, r1);
+        const auto b  = simd::shuffle<2, 3, 2, 3>(r0, r1);
+        const auto c  = simd::shuffle<0, 1, 0, 1>(r2, r3);
+        const auto d  = simd::shuffle<2, 3, 2, 3>(r2, r3);
+        // (|A|, |B|, |C|, |D|)
+        const auto detSub = simd::sub(simd::mul(simd::shuffle<0, 2, 0, 2>(r0, r2), simd::shuffle<1, 3, 1, 3>(r1, r3)),
+                                      simd::mul(simd::shuffle<1, 3, 1, 3>(r0, r2), simd::shuffle<0, 2, 0, 2>(r1, r3)));
+        const auto detA = simd::splatX(detSub);
+        const auto detB = simd::splatY(detSub);
+        const auto detC = simd::splatZ(detSub);
+        const auto detD = simd::splatW(detSub);
+
+        const auto dc = mat2AdjMul(d, c);
+        const auto ab = mat2AdjMul(a, b);
+        // X# = |D|A - B(D#C), W# = |A|D - C(A#B)
+        auto x = simd::sub(simd::mul(detD, a), mat2Mul(b, dc));
+        auto w = simd::sub(simd::mul(detA, d), mat2Mul(c, ab));
+        // Y# = |B|C - D(A#B)#, Z# = |C|B - A(D#C)#
+        auto y = simd::sub(simd::mul(detB, c), mat2MulAdj(d, ab));
+        auto z = simd::sub(simd::mul(detC, b), mat2MulAdj(a, dc));
+        // |M| = |A||D| + |B||C| - tr((A#B)(D#C))
+        const auto det = simd::getX(detSub) * simd::getW(detSub) + simd::getY(detSub) * simd::getZ(detSub)
+                       - simd::sum(simd::mul(ab, simd::shuffle<0, 2, 1, 3>(dc, dc)));
+        if(fabsf(det) < FLT_EPSILON)
             return *this;
-        *this = _adjoint(*this) / d;
+        const auto rcpDet = simd::mul(SIMDFloat4::set(1.0f, -1.0f, -1.0f, 1.0f), 1.0f / det);
+        x = simd::mul(x, rcpDet);
+        y = simd::mul(y, rcpDet);
+        z = simd::mul(z, rcpDet);
+        w = simd::mul(w, rcpDet);
+        // дغϲ
+        simd::storeu(simd::shuffle<3, 1, 3, 1>(x, y), m[0]);
+        simd::storeu(simd::shuffle<2, 0, 2, 0>(x, y), m[1]);
+        simd::storeu(simd::shuffle<3, 1, 3, 1>(z, w), m[2]);
+        simd::storeu(simd::shuffle<2, 0, 2, 0>(z, w), m[3]);
         return *this;
     }
     Mat4& Mat4::transpose()
     {
-        for(int i = 0; i < 3; ++i)
-        {
-            for(int r = i; r < 4; ++r)
-                for(int c = i + 1; c < 4; ++c)
-                    std::swap(this->m[r][c], this->m[c][r]);
-        }
+        auto r0 = this->getSIMDRow(0);
+        auto r1 = this->getSIMDRow(1);
+        auto r2 = this->getSIMDRow(2);
+        auto r3 = this->getSIMDRow(3);
+        simd::transpose(r0, r1, r2, r3);
+        simd::storeu(r0, m[0]);
+        simd::storeu(r1, m[1]);
+        simd::storeu(r2, m[2]);
+        simd::storeu(r3, m[3]);
         return *this;
     }
     Mat4 Mat4::getTranspose() const
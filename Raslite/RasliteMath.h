@@ -8,6 +8,7 @@
 #include <limits>
 #include <utility>
 #include <algorithm>
+#include "RasliteSIMD.h"
 #pragma warning( disable: 4996 ) // Disable warning about _controlfp being deprecated.
 namespace rl
 {
@@ -342,6 +343,7 @@ namespace rl
         Vec4(const Vec2& rhs);
         Vec4(const Vec4& rhs, uint32_t n);
         Vec4(const Float* rhs, uint32_t n);
+        explicit Vec4(SIMDFloat4P_t rhs);
 		const Vec4& operator =(const Vec4 &rhs);
 		const Vec4& operator =(const Vec3 &rhs);
 		const Vec4& operator =(const Vec2 &rhs);
@@ -349,6 +351,8 @@ namespace rl
 
 		operator Float*();
 		operator const Float*() const;
+        // 㶼SIMDFloat4_t; Vec4Ҫ16ֽڶ
+        SIMDFloat4_t toSIMD() const;
 
 		Vec4 operator +() const;
 		Vec4 operator -() const;
@@ -415,6 +419,7 @@ namespace rl
 
 		operator Float*();
 		operator const Float*() const;
+        SIMDFloat4_t toSIMD() const;
 
 		Quat operator +() const;
 		Quat operator -() const;
@@ -485,6 +490,7 @@ namespace rl
 
         Vec4  getColumn(size_t c) const;
         Vec4  getRow(size_t r)    const;
+        SIMDFloat4_t getSIMDRow(size_t r) const;
 
 	public:
 		// ѧΪоҰд洢
@@ -691,6 +697,24 @@ namespace rl
 				&& (this->top  <= rhs.top    && rhs.top    <  this->bottom)
 				&& (this->top  <  rhs.bottom && rhs.bottom <= this->bottom);
 		}
+		bool intersects(const Rect& rhs) const
+		{
+			return this->left < rhs.right && rhs.left < this->right
+				&& this->top  < rhs.bottom && rhs.top < this->bottom;
+		}
+		// ϲΪͬʱߵСRect; Rectϲ
+		Rect& merge(const Rect& rhs)
+		{
+			if(rhs.isVoid())
+				return *this;
+			if(this->isVoid())
+				return *this = rhs;
+			this->left   = std::min(this->left,   rhs.left);
+			this->top    = std::min(this->top,    rhs.top);
+			this->right  = std::max(this->right,  rhs.right);
+			this->bottom = std::max(this->bottom, rhs.bottom);
+			return *this;
+		}
 		bool isNormal() const
 		{
 			return this->left < this->right && this->top < this->bottom;;
@@ -764,6 +788,82 @@ namespace rl
             return *this;
         }
     };
+    /////////////////////////////////////////////////////////////////////////////////////////
+    // SoA: ÿһfloatN, һμSIMD_LANE_COUNTvertex/pixel
+    // (Vec2/Vec3/Vec4/Mat4)㲥lane
+    struct Vec2xN
+    {
+        floatN x, y;
+
+        Vec2xN() = default;
+        Vec2xN(const floatN& x, const floatN& y);
+        Vec2xN(const Vec2& rhs);
+
+        Vec2 getLane(uint32_t i) const;
+        void setLane(uint32_t i, const Vec2& val);
+    };
+    struct Vec3xN
+    {
+        floatN x, y, z;
+
+        Vec3xN() = default;
+        Vec3xN(const floatN& x, const floatN& y, const floatN& z);
+        Vec3xN(const Vec3& rhs);
+
+        Vec3 getLane(uint32_t i) const;
+        void setLane(uint32_t i, const Vec3& val);
+    };
+    struct Vec4xN
+    {
+        floatN x, y, z, w;
+
+        Vec4xN() = default;
+        Vec4xN(const floatN& x, const floatN& y, const floatN& z, const floatN& w);
+        Vec4xN(const Vec3xN& rhs, const floatN& w);
+        Vec4xN(const Vec4& rhs);
+
+        Vec4 getLane(uint32_t i) const;
+        void setLane(uint32_t i, const Vec4& val);
+        Vec3xN xyz() const;
+    };
+    Vec2xN operator +(const Vec2xN& lhs, const Vec2xN& rhs);
+    Vec2xN operator -(const Vec2xN& lhs, const Vec2xN& rhs);
+    Vec2xN operator *(const Vec2xN& lhs, const Vec2xN& rhs);
+    Vec2xN operator *(const Vec2xN& lhs, const floatN& rhs);
+    Vec2xN operator /(const Vec2xN& lhs, const floatN& rhs);
+    Vec2xN operator -(const Vec2xN& rhs);
+    floatN dot      (const Vec2xN& lhs, const Vec2xN& rhs);
+    floatN length   (const Vec2xN& v);
+    Vec2xN normalize(const Vec2xN& v);
+    Vec2xN lerp     (const Vec2xN& lhs, const Vec2xN& rhs, const floatN& factor);
+    Vec2xN select   (const maskN& m, const Vec2xN& lhs, const Vec2xN& rhs);
+
+    Vec3xN operator +(const Vec3xN& lhs, const Vec3xN& rhs);
+    Vec3xN operator -(const Vec3xN& lhs, const Vec3xN& rhs);
+    Vec3xN operator *(const Vec3xN& lhs, const Vec3xN& rhs);
+    Vec3xN operator *(const Vec3xN& lhs, const floatN& rhs);
+    Vec3xN operator /(const Vec3xN& lhs, const floatN& rhs);
+    Vec3xN operator -(const Vec3xN& rhs);
+    floatN dot      (const Vec3xN& lhs, const Vec3xN& rhs);
+    Vec3xN cross    (const Vec3xN& lhs, const Vec3xN& rhs);
+    floatN length   (const Vec3xN& v);
+    Vec3xN normalize(const Vec3xN& v);
+    Vec3xN lerp     (const Vec3xN& lhs, const Vec3xN& rhs, const floatN& factor);
+    Vec3xN select   (const maskN& m, const Vec3xN& lhs, const Vec3xN& rhs);
+
+    Vec4xN operator +(const Vec4xN& lhs, const Vec4xN& rhs);
+    Vec4xN operator -(const Vec4xN& lhs, const Vec4xN& rhs);
+    Vec4xN operator *(const Vec4xN& lhs, const Vec4xN& rhs);
+    Vec4xN operator *(const Vec4xN& lhs, const floatN& rhs);
+    Vec4xN operator /(const Vec4xN& lhs, const floatN& rhs);
+    Vec4xN operator -(const Vec4xN& rhs);
+    // Vec4 * Mat4ͬ()
+    Vec4xN operator *(const Vec4xN& lhs, const Mat4& rhs);
+    floatN dot      (const Vec4xN& lhs, const Vec4xN& rhs);
+    floatN length   (const Vec4xN& v);
+    Vec4xN normalize(const Vec4xN& v);
+    Vec4xN lerp     (const Vec4xN& lhs, const Vec4xN& rhs, const floatN& factor);
+    Vec4xN select   (const maskN& m, const Vec4xN& lhs, const Vec4xN& rhs);
 }//ns rl
 namespace rl 
 {
@@ -1209,85 +1309,86 @@ namespace rl
 	{
 		return &x;
 	}
+    inline Vec4::Vec4(SIMDFloat4P_t rhs)
+    {
+        simd::storeu(rhs, &x);
+    }
+    inline SIMDFloat4_t Vec4::toSIMD() const
+    {
+        return SIMDFloat4::loadu(&x);
+    }
 	inline Vec4 Vec4::operator +() const
 	{
 		return *this;
 	}
 	inline Vec4 Vec4::operator -() const
 	{
-		return Vec4(-x, -y, -z, -w);
+		return Vec4(simd::sub(SIMDFloat4::zero(), this->toSIMD()));
 	}
 
 	inline const Vec4 &Vec4::operator +=(const Vec4 &rhs)
 	{
-		x += rhs.x; y += rhs.y;
-		z += rhs.z; w += rhs.w;
+		simd::storeu(simd::add(this->toSIMD(), rhs.toSIMD()), &x);
 		return *this;
 	}
 
 	inline const Vec4 &Vec4::operator -=(const Vec4 &rhs)
 	{
-		x -= rhs.x; y -= rhs.y;
-		z -= rhs.z; w -= rhs.w;
+		simd::storeu(simd::sub(this->toSIMD(), rhs.toSIMD()), &x);
 		return *this;
 	}
 
 	inline const Vec4 &Vec4::operator *=(const Vec4 &rhs)
 	{
-		x *= rhs.x; y *= rhs.y;
-		z *= rhs.z; w *= rhs.w;
+		simd::storeu(simd::mul(this->toSIMD(), rhs.toSIMD()), &x);
 		return *this;
 	}
 
 	inline const Vec4 &Vec4::operator *=(const Float rhs)
 	{
-		x *= rhs; y *= rhs;
-		z *= rhs; w *= rhs;
+		simd::storeu(simd::mul(this->toSIMD(), rhs), &x);
 		return *this;
 	}
 
 	inline const Vec4 &Vec4::operator /=(const Float rhs)
 	{
-		const Float inv = 1.0f / rhs;
-		x *= inv; y *= inv;
-		z *= inv; w *= inv;
+		simd::storeu(simd::mul(this->toSIMD(), 1.0f / rhs), &x);
 		return *this;
 	}
 
 	inline Vec4 Vec4::operator +(const Vec4 &rhs) const
 	{
-		return Vec4(x + rhs.x, y + rhs.y, z + rhs.z, w + rhs.w);
+		return Vec4(simd::add(this->toSIMD(), rhs.toSIMD()));
 	}
 
 	inline Vec4 Vec4::operator -(const Vec4 &rhs) const
 	{
-		return Vec4(x - rhs.x, y - rhs.y, z - rhs.z, w - rhs.w);
+		return Vec4(simd::sub(this->toSIMD(), rhs.toSIMD()));
 	}
 
 	inline Vec4 Vec4::operator *(const Vec4 &rhs) const
 	{
-		return Vec4(x * rhs.x, y * rhs.y, z * rhs.z, w * rhs.w);
+		return Vec4(simd::mul(this->toSIMD(), rhs.toSIMD()));
 	}
 
 	inline Vec4 Vec4::operator *(const Float rhs) const
 	{
-		return Vec4(x * rhs, y * rhs, z * rhs, w * rhs);
+		return Vec4(simd::mul(this->toSIMD(), rhs));
 	}
 
 	inline Vec4 Vec4::operator /(const Float rhs) const
 	{
-		const Float fInv = 1.0f / rhs;
-		return Vec4(x * fInv, y * fInv, z * fInv, w * fInv);
+		return Vec4(simd::mul(this->toSIMD(), 1.0f / rhs));
 	}
 
 	inline Float Vec4::length() const
 	{
-		return sqrtf(x * x + y * y + z * z + w * w);
+		return sqrtf(this->lengthSq());
 	}
 
 	inline Float Vec4::lengthSq() const
 	{
-		return x * x + y * y + z * z + w * w;
+		return this->dot(*this);
 	}
 
 	inline Vec4 &Vec4::normalize()
@@ -1295,9 +1396,7 @@ namespace rl
 		const Float fLength = length();
 		//if( fLength >= FLT_EPSILON )
 		{
-			const Float fInvLength = 1.0f / fLength;
-			x *= fInvLength; y *= fInvLength;
-			z *= fInvLength; w *= fInvLength;
+			*this *= 1.0f / fLength;
 		}
 		return *this;
 	}
@@ -1306,9 +1405,7 @@ namespace rl
 	{
 		//if( w != 1.0f && fabsf( w ) >= FLT_EPSILON )
 		{
-			const Float fInvW = 1.0f / w;
-			x *= fInvW; y *= fInvW;
-			z *= fInvW; w = 1.0f;
+			simd::storeu(simd::setW(simd::mul(this->toSIMD(), 1.0f / w), 1.0f), &x);
 		}
 		return *this;
 	}
@@ -1359,14 +1456,12 @@ namespace rl
 
 	inline Vec4& Vec4::setLerp(const Vec4& rhs, Float factor)
 	{
-		(*this) += (rhs - (*this))*factor;
+		simd::storeu(simd::lerp(this->toSIMD(), rhs.toSIMD(), factor), &x);
         return *this;
 	}
 	inline Vec4 Vec4::lerp(const Vec4& rhs, Float factor) const
 	{
-		auto lhs(*this);
-		lhs.setLerp(rhs, factor);
-		return lhs;
+		return Vec4(simd::lerp(this->toSIMD(), rhs.toSIMD(), factor));
 	}
     inline Vec4& Vec4::setZero()
     {
@@ -1375,8 +1470,23 @@ namespace rl
     }
 	inline Float Vec4::dot(const Vec4& rhs) const
 	{
-		return x * rhs.x + y * rhs.y + z * rhs.z + w * rhs.w;
+		return simd::sum(simd::mul(this->toSIMD(), rhs.toSIMD()));
 	}
+    // : x*row0 + y*row1 + z*row2 + w*row3
+    inline const Vec4& Vec4::operator *=(const Mat4& rhs)
+    {
+        const auto v = this->toSIMD();
+        auto r = simd::mul(simd::splatX(v), rhs.getSIMDRow(0));
+        r = simd::add(r, simd::mul(simd::splatY(v), rhs.getSIMDRow(1)));
+        r = simd::add(r, simd::mul(simd::splatZ(v), rhs.getSIMDRow(2)));
+        r = simd::add(r, simd::mul(simd::splatW(v), rhs.getSIMDRow(3)));
+        simd::storeu(r, &x);
+        return *this;
+    }
+    inline Vec4 Vec4::operator *(const Mat4& rhs) const
+    {
+        return Vec4(*this) *= rhs;
+    }
     inline Vec3 Vec4::xyz() const
     {
         return Vec3(x, y, z);
@@ -1445,90 +1555,84 @@ namespace rl
 
 	inline Quat::operator Float*() { return &x; }
 	inline Quat::operator const Float*() const { return &x; }
+    inline SIMDFloat4_t Quat::toSIMD() const { return SIMDFloat4::loadu(&x); }
 
 	inline Quat Quat::operator +() const { return *this; }
 	inline Quat Quat::operator -() const { return Quat(-x, -y, -z, w); }
 
 	inline const Quat &Quat::operator +=(const Quat &rhs)
 	{
-		x += rhs.x; y += rhs.y;
-		z += rhs.z; w += rhs.w;
+		simd::storeu(simd::add(this->toSIMD(), rhs.toSIMD()), &x);
 		return *this;
 	}
 
 	inline const Quat &Quat::operator -=(const Quat &rhs)
 	{
-		x -= rhs.x; y -= rhs.y;
-		z -= rhs.z; w -= rhs.w;
+		simd::storeu(simd::sub(this->toSIMD(), rhs.toSIMD()), &x);
 		return *this;
 	}
 
 	inline const Quat &Quat::operator *=(const Quat &qVal)
 	{
-		Quat qResult;
-		qResult.x = w * qVal.x + x * qVal.w + y * qVal.z - z * qVal.y;
-		qResult.y = w * qVal.y - x * qVal.z + y * qVal.w + z * qVal.x;
-		qResult.z = w * qVal.z + x * qVal.y - y * qVal.x + z * qVal.w;
-		qResult.w = w * qVal.w - x * qVal.x - y * qVal.y - z * qVal.z;
-		*this = qResult;
-
+		*this = (*this) * qVal;
 		return *this;
 	}
 
 	inline const Quat &Quat::operator *=(const Float rhs)
 	{
-		x *= rhs; y *= rhs;
-		z *= rhs; w *= rhs;
+		simd::storeu(simd::mul(this->toSIMD(), rhs), &x);
 		return *this;
 	}
 
 	inline const Quat &Quat::operator /=(const Float rhs)
 	{
-		const Float fInvVal = 1.0f / rhs;
-		x *= fInvVal; y *= fInvVal;
-		z *= fInvVal; w *= fInvVal;
+		simd::storeu(simd::mul(this->toSIMD(), 1.0f / rhs), &x);
 		return *this;
 	}
 
 	inline Quat Quat::operator +(const Quat &rhs) const
 	{
-		return Quat(x + rhs.x, y + rhs.y, z + rhs.z, w + rhs.w);
+		return Quat(*this) += rhs;
 	}
 
 	inline Quat Quat::operator -(const Quat &rhs) const
 	{
-		return Quat(x - rhs.x, y - rhs.y, z - rhs.z, w - rhs.w);
+		return Quat(*this) -= rhs;
 	}
 
 	inline Quat Quat::operator *(const Quat &qVal) const
 	{
+		// w*q + x*(qw,-qz,qy,-qx) + y*(qz,qw,-qx,-qy) + z*(-qy,qx,qw,-qz)
+		const auto lhs = this->toSIMD();
+		const auto rhs = qVal.toSIMD();
+		auto r = simd::mul(simd::splatW(lhs), rhs);
+		r = simd::add(r, simd::mul(simd::splatX(lhs), simd::mul(simd::shuffle<3, 2, 1, 0>(rhs, rhs), SIMDFloat4::set( 1.0f, -1.0f,  1.0f, -1.0f))));
+		r = simd::add(r, simd::mul(simd::splatY(lhs), simd::mul(simd::shuffle<2, 3, 0, 1>(rhs, rhs), SIMDFloat4::set( 1.0f,  1.0f, -1.0f, -1.0f))));
+		r = simd::add(r, simd::mul(simd::splatZ(lhs), simd::mul(simd::shuffle<1, 0, 3, 2>(rhs, rhs), SIMDFloat4::set(-1.0f,  1.0f,  1.0f, -1.0f))));
 		Quat qResult;
-		qResult.x = w * qVal.x + x * qVal.w + y * qVal.z - z * qVal.y;
-		qResult.y = w * qVal.y - x * qVal.z + y * qVal.w + z * qVal.x;
-		qResult.z = w * qVal.z + x * qVal.y - y * qVal.x + z * qVal.w;
-		qResult.w = w * qVal.w - x * qVal.x - y * qVal.y - z * qVal.z;
+		simd::storeu(r, &qResult.x);
 		return qResult;
 	}
 
 	inline Quat Quat::operator *(const Float rhs) const
 	{
-		return Quat(x * rhs, y * rhs, z * rhs, w * rhs);
+		return Quat(*this) *= rhs;
 	}
 
 	inline Quat Quat::operator /(const Float rhs) const
 	{
-		const Float fInv = 1.0f / rhs;
-		return Quat(x * fInv, y * fInv, z * fInv, w * fInv);
+		return Quat(*this) /= rhs;
 	}
 
 	inline Float Quat::length() const
 	{
-		return sqrtf(x * x + y * y + z * z + w * w);
+		return sqrtf(this->lengthSq());
 	}
 
 	inline Float Quat::lengthSq() const
 	{
-		return x * x + y * y + z * z + w * w;
+		const auto v = this->toSIMD();
+		return simd::sum(simd::mul(v, v));
 	}
 
 	inline Quat &Quat::normalize()
@@ -1536,9 +1640,7 @@ namespace rl
 		const auto len = this->length();
 		//if( fLength >= FLT_EPSILON )
 		{
-			const auto invLen = 1.0f / len;
-			x *= invLen; y *= invLen;
-			z *= invLen; w *= invLen;
+			*this *= 1.0f / len;
 		}
 		return *this;
 	}
@@ -1596,28 +1698,22 @@ namespace rl
 	}
 	inline const Mat4& Mat4::operator +=(const Mat4& rhs)
 	{
-		_11 += rhs._11; _12 += rhs._12; _13 += rhs._13; _14 += rhs._14;
-		_21 += rhs._21; _22 += rhs._22; _23 += rhs._23; _24 += rhs._24;
-		_31 += rhs._31; _32 += rhs._32; _33 += rhs._33; _34 += rhs._34;
-		_41 += rhs._41; _42 += rhs._42; _43 += rhs._43; _44 += rhs._44;
+		for(size_t r = 0; r < 4; ++r)
+			simd::storeu(simd::add(this->getSIMDRow(r), rhs.getSIMDRow(r)), m[r]);
 		return *this;
 	}
 
 	inline const Mat4& Mat4::operator -=(const Mat4& rhs)
 	{
-		_11 -= rhs._11; _12 -= rhs._12; _13 -= rhs._13; _14 -= rhs._14;
-		_21 -= rhs._21; _22 -= rhs._22; _23 -= rhs._23; _24 -= rhs._24;
-		_31 -= rhs._31; _32 -= rhs._32; _33 -= rhs._33; _34 -= rhs._34;
-		_41 -= rhs._41; _42 -= rhs._42; _43 -= rhs._43; _44 -= rhs._44;
+		for(size_t r = 0; r < 4; ++r)
+			simd::storeu(simd::sub(this->getSIMDRow(r), rhs.getSIMDRow(r)), m[r]);
 		return *this;
 	}
 
 	inline const Mat4& Mat4::operator *=(const Float rhs)
 	{
-		_11 *= rhs; _12 *= rhs; _13 *= rhs; _14 *= rhs;
-		_21 *= rhs; _22 *= rhs; _23 *= rhs; _24 *= rhs;
-		_31 *= rhs; _32 *= rhs; _33 *= rhs; _34 *= rhs;
-		_41 *= rhs; _42 *= rhs; _43 *= rhs; _44 *= rhs;
+		for(size_t r = 0; r < 4; ++r)
+			simd::storeu(simd::mul(this->getSIMDRow(r), rhs), m[r]);
 		return *this;
 	}
 
@@ -1637,16 +1733,19 @@ namespace rl
         assert(r < 4);
         return Vec4(m[r][0], m[r][1], m[r][2], m[r][3]);
     }
+    inline SIMDFloat4_t Mat4::getSIMDRow(size_t r) const
+    {
+        assert(r < 4);
+        return SIMDFloat4::loadu(m[r]);
+    }
     inline Mat4  Mat4::getInverse() const
     {
         return Mat4(*this).inverse();
     }
     inline Mat4& Mat4::negate()
     {
-        _11 = -_11; _12 = -_12; _13 = -_13; _14 = -_14;
-        _21 = -_21; _22 = -_22; _23 = -_23; _24 = -_24;
-        _31 = -_31; _32 = -_32; _33 = -_33; _34 = -_34;
-        _41 = -_41; _42 = -_42; _43 = -_43; _44 = -_44;
+        for(size_t r = 0; r < 4; ++r)
+            simd::storeu(simd::sub(SIMDFloat4::zero(), this->getSIMDRow(r)), m[r]);
         return *this;
     }
     inline Mat4 Mat4::getNegate() const
@@ -1735,6 +1834,106 @@ namespace rl
     {//homo dist
         return this->normal.dot(rhs) + d * rhs.w;
     }
+    //////////////////////////////////////////////////////////////////////////////////////
+    // SoA
+    inline Vec2xN::Vec2xN(const floatN& x, const floatN& y) : x(x), y(y) {}
+    inline Vec2xN::Vec2xN(const Vec2& rhs) : x(rhs.x), y(rhs.y) {}
+    inline Vec2 Vec2xN::getLane(uint32_t i) const
+    {
+        return Vec2(x.lane(i), y.lane(i));
+    }
+    inline void Vec2xN::setLane(uint32_t i, const Vec2& val)
+    {
+        x.setLane(i, val.x); y.setLane(i, val.y);
+    }
+    inline Vec3xN::Vec3xN(const floatN& x, const floatN& y, const floatN& z) : x(x), y(y), z(z) {}
+    inline Vec3xN::Vec3xN(const Vec3& rhs) : x(rhs.x), y(rhs.y), z(rhs.z) {}
+    inline Vec3 Vec3xN::getLane(uint32_t i) const
+    {
+        return Vec3(x.lane(i), y.lane(i), z.lane(i));
+    }
+    inline void Vec3xN::setLane(uint32_t i, const Vec3& val)
+    {
+        x.setLane(i, val.x); y.setLane(i, val.y); z.setLane(i, val.z);
+    }
+    inline Vec4xN::Vec4xN(const floatN& x, const floatN& y, const floatN& z, const floatN& w) : x(x), y(y), z(z), w(w) {}
+    inline Vec4xN::Vec4xN(const Vec3xN& rhs, const floatN& w) : x(rhs.x), y(rhs.y), z(rhs.z), w(w) {}
+    inline Vec4xN::Vec4xN(const Vec4& rhs) : x(rhs.x), y(rhs.y), z(rhs.z), w(rhs.w) {}
+    inline Vec4 Vec4xN::getLane(uint32_t i) const
+    {
+        assert(i < SIMD_LANE_COUNT);
+        Float lanes[4][SIMD_LANE_COUNT];
+        x.store(lanes[0]); y.store(lanes[1]); z.store(lanes[2]); w.store(lanes[3]);
+        return Vec4(lanes[0][i], lanes[1][i], lanes[2][i], lanes[3][i]);
+    }
+    inline void Vec4xN::setLane(uint32_t i, const Vec4& val)
+    {
+        x.setLane(i, val.x); y.setLane(i, val.y); z.setLane(i, val.z); w.setLane(i, val.w);
+    }
+    inline Vec3xN Vec4xN::xyz() const
+    {
+        return Vec3xN(x, y, z);
+    }
+
+    inline Vec2xN operator +(const Vec2xN& lhs, const Vec2xN& rhs) { return Vec2xN(lhs.x + rhs.x, lhs.y + rhs.y); }
+    inline Vec2xN operator -(const Vec2xN& lhs, const Vec2xN& rhs) { return Vec2xN(lhs.x - rhs.x, lhs.y - rhs.y); }
+    inline Vec2xN operator *(const Vec2xN& lhs, const Vec2xN& rhs) { return Vec2xN(lhs.x * rhs.x, lhs.y * rhs.y); }
+    inline Vec2xN operator *(const Vec2xN& lhs, const floatN& rhs) { return Vec2xN(lhs.x * rhs, lhs.y * rhs); }
+    inline Vec2xN operator /(const Vec2xN& lhs, const floatN& rhs) { return lhs * (floatN(1.0f) / rhs); }
+    inline Vec2xN operator -(const Vec2xN& rhs) { return Vec2xN(-rhs.x, -rhs.y); }
+    inline floatN dot(const Vec2xN& lhs, const Vec2xN& rhs) { return lhs.x * rhs.x + lhs.y * rhs.y; }
+    inline floatN length(const Vec2xN& v) { return sqrt(dot(v, v)); }
+    inline Vec2xN normalize(const Vec2xN& v) { return v / length(v); }
+    inline Vec2xN lerp(const Vec2xN& lhs, const Vec2xN& rhs, const floatN& factor) { return lhs + (rhs - lhs) * factor; }
+    inline Vec2xN select(const maskN& m, const Vec2xN& lhs, const Vec2xN& rhs)
+    {
+        return Vec2xN(select(m, lhs.x, rhs.x), select(m, lhs.y, rhs.y));
+    }
+
+    inline Vec3xN operator +(const Vec3xN& lhs, const Vec3xN& rhs) { return Vec3xN(lhs.x + rhs.x, lhs.y + rhs.y, lhs.z + rhs.z); }
+    inline Vec3xN operator -(const Vec3xN& lhs, const Vec3xN& rhs) { return Vec3xN(lhs.x - rhs.x, lhs.y - rhs.y, lhs.z - rhs.z); }
+    inline Vec3xN operator *(const Vec3xN& lhs, const Vec3xN& rhs) { return Vec3xN(lhs.x * rhs.x, lhs.y * rhs.y, lhs.z * rhs.z); }
+    inline Vec3xN operator *(const Vec3xN& lhs, const floatN& rhs) { return Vec3xN(lhs.x * rhs, lhs.y * rhs, lhs.z * rhs); }
+    inline Vec3xN operator /(const Vec3xN& lhs, const floatN& rhs) { return lhs * (floatN(1.0f) / rhs); }
+    inline Vec3xN operator -(const Vec3xN& rhs) { return Vec3xN(-rhs.x, -rhs.y, -rhs.z); }
+    inline floatN dot(const Vec3xN& lhs, const Vec3xN& rhs) { return lhs.x * rhs.x + lhs.y * rhs.y + lhs.z * rhs.z; }
+    inline Vec3xN cross(const Vec3xN& lhs, const Vec3xN& rhs)
+    {
+        return Vec3xN(lhs.y * rhs.z - lhs.z * rhs.y,
+                      lhs.z * rhs.x - lhs.x * rhs.z,
+                      lhs.x * rhs.y - lhs.y * rhs.x);
+    }
+    inline floatN length(const Vec3xN& v) { return sqrt(dot(v, v)); }
+    inline Vec3xN normalize(const Vec3xN& v) { return v / length(v); }
+    inline Vec3xN lerp(const Vec3xN& lhs, const Vec3xN& rhs, const floatN& factor) { return lhs + (rhs - lhs) * factor; }
+    inline Vec3xN select(const maskN& m, const Vec3xN& lhs, const Vec3xN& rhs)
+    {
+        return Vec3xN(select(m, lhs.x, rhs.x), select(m, lhs.y, rhs.y), select(m, lhs.z, rhs.z));
+    }
+
+    inline Vec4xN operator +(const Vec4xN& lhs, const Vec4xN& rhs) { return Vec4xN(lhs.x + rhs.x, lhs.y + rhs.y, lhs.z + rhs.z, lhs.w + rhs.w); }
+    inline Vec4xN operator -(const Vec4xN& lhs, const Vec4xN& rhs) { return Vec4xN(lhs.x - rhs.x, lhs.y - rhs.y, lhs.z - rhs.z, lhs.w - rhs.w); }
+    inline Vec4xN operator *(const Vec4xN& lhs, const Vec4xN& rhs) { return Vec4xN(lhs.x * rhs.x, lhs.y * rhs.y, lhs.z * rhs.z, lhs.w * rhs.w); }
+    inline Vec4xN operator *(const Vec4xN& lhs, const floatN& rhs) { return Vec4xN(lhs.x * rhs, lhs.y * rhs, lhs.z * rhs, lhs.w * rhs); }
+    inline Vec4xN operator /(const Vec4xN& lhs, const floatN& rhs) { return lhs * (floatN(1.0f) / rhs); }
+    inline Vec4xN operator -(const Vec4xN& rhs) { return Vec4xN(-rhs.x, -rhs.y, -rhs.z, -rhs.w); }
+    inline Vec4xN operator *(const Vec4xN& lhs, const Mat4& rhs)
+    {
+        Vec4xN r;
+        r.x = lhs.x * rhs._11 + lhs.y * rhs._21 + lhs.z * rhs._31 + lhs.w * rhs._41;
+        r.y = lhs.x * rhs._12 + lhs.y * rhs._22 + lhs.z * rhs._32 + lhs.w * rhs._42;
+        r.z = lhs.x * rhs._13 + lhs.y * rhs._23 + lhs.z * rhs._33 + lhs.w * rhs._43;
+        r.w = lhs.x * rhs._14 + lhs.y * rhs._24 + lhs.z * rhs._34 + lhs.w * rhs._44;
+        return r;
+    }
+    inline floatN dot(const Vec4xN& lhs, const Vec4xN& rhs) { return lhs.x * rhs.x + lhs.y * rhs.y + lhs.z * rhs.z + lhs.w * rhs.w; }
+    inline floatN length(const Vec4xN& v) { return sqrt(dot(v, v)); }
+    inline Vec4xN normalize(const Vec4xN& v) { return v / length(v); }
+    inline Vec4xN lerp(const Vec4xN& lhs, const Vec4xN& rhs, const floatN& factor) { return lhs + (rhs - lhs) * factor; }
+    inline Vec4xN select(const maskN& m, const Vec4xN& lhs, const Vec4xN& rhs)
+    {
+        return Vec4xN(select(m, lhs.x, rhs.x), select(m, lhs.y, rhs.y), select(m, lhs.z, rhs.z), select(m, lhs.w, rhs.w));
+    }
 }//ns rb
 
 #endif //RASLITE_MATH_H
\ No newline at end of file
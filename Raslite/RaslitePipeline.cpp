@@ -1,4 +1,5 @@
 #include "Raslite.h"
+#include "RasliteSIMD.h"
 #include <tuple>
 #include <algorithm>
 namespace rl
@@ -34,12 +35,76 @@ namespace rl
         {
             m_context = ctx;
         }
+        // Pipeline::draw<VS, PS>, drawΪnullptr
+        void setTypedStages(const detail::TypedStages* stages)
+        {
+            m_typedStages = stages;
+        }
     protected:
-        const Context* m_context = nullptr;
+        const Context*             m_context     = nullptr;
+        const detail::TypedStages* m_typedStages = nullptr;
     };
     ///////////////////////////////////////////////////////////////////////
 	//InputLayout
 	///////////////////////////////////////////////////////////////////////
+    namespace detail
+    {
+        // ȡһelement, ȱٵķΪ(0,0,0,1)
+        template <Format F>
+        void fetchElement(const uint8_t* src, ShaderRegister& dst)
+        {
+            SIMDFloat4_t v;
+            if constexpr(F == Format::R32_FLOAT)
+                v = simd::add(SIMDFloat4::loaduX(reinterpret_cast<const float*>(src)), SIMDFloat4::unitW());
+            else if constexpr(F == Format::R32G32_FLOAT)
+                v = simd::add(SIMDFloat4::loaduXY(reinterpret_cast<const float*>(src)), SIMDFloat4::unitW());
+            else if constexpr(F == Format::R32G32B32_FLOAT)
+                v = simd::add(SIMDFloat4::loaduXYZ(reinterpret_cast<const float*>(src)), SIMDFloat4::unitW());
+            else if constexpr(F == Format::R32G32B32A32_FLOAT)
+                v = SIMDFloat4::loadu(reinterpret_cast<const float*>(src));
+            else if constexpr(F == Format::R8_UNORM)
+                v = SIMDFloat4::set(src[0] * (1.0f / 255.0f), 0.0f, 0.0f, 1.0f);
+            else if constexpr(F == Format::R8G8_UNORM)
+                v = SIMDFloat4::set(src[0] * (1.0f / 255.0f), src[1] * (1.0f / 255.0f), 0.0f, 1.0f);
+            else if constexpr(F == Format::R8G8B8A8_UNORM)
+                v = SIMDFloat4::loaduUnorm8x4(src);
+            else if constexpr(F == Format::R16G16_SNORM)
+                v = simd::add(SIMDFloat4::loaduSnorm16x2(reinterpret_cast<const int16_t*>(src)), SIMDFloat4::unitW());
+            else if constexpr(F == Format::R16G16B16A16_SNORM)
+                v = SIMDFloat4::loaduSnorm16x4(reinterpret_cast<const int16_t*>(src));
+            else if constexpr(F == Format::R16G16_FLOAT)
+                v = simd::add(SIMDFloat4::loaduHalf2(reinterpret_cast<const uint16_t*>(src)), SIMDFloat4::unitW());
+            else if constexpr(F == Format::R16G16B16A16_FLOAT)
+                v = SIMDFloat4::loaduHalf4(reinterpret_cast<const uint16_t*>(src));
+            else
+            {
+                static_assert(F == Format::R10G10B10A2_UNORM, "ֵ֧Ķʽ!");
+                v = SIMDFloat4::loaduUnorm10x3_2(reinterpret_cast<const uint32_t*>(src));
+            }
+            simd::storeu(v, &dst.x);
+        }
+        inline InputLayout::FetchOp::Func fetchFunc(Format fmt)
+        {
+            switch(fmt)
+            {
+            case Format::R32_FLOAT:          return &fetchElement<Format::R32_FLOAT>;
+            case Format::R32G32_FLOAT:       return &fetchElement<Format::R32G32_FLOAT>;
+            case Format::R32G32B32_FLOAT:    return &fetchElement<Format::R32G32B32_FLOAT>;
+            case Format::R32G32B32A32_FLOAT: return &fetchElement<Format::R32G32B32A32_FLOAT>;
+            case Format::R8_UNORM:           return &fetchElement<Format::R8_UNORM>;
+            case Format::R8G8_UNORM:         return &fetchElement<Format::R8G8_UNORM>;
+            case Format::R8G8B8A8_UNORM:     return &fetchElement<Format::R8G8B8A8_UNORM>;
+            case Format::R16G16_SNORM:       return &fetchElement<Format::R16G16_SNORM>;
+            case Format::R16G16B16A16_SNORM: return &fetchElement<Format::R16G16B16A16_SNORM>;
+            case Format::R16G16_FLOAT:       return &fetchElement<Format::R16G16_FLOAT>;
+            case Format::R16G16B16A16_FLOAT: return &fetchElement<Format::R16G16B16A16_FLOAT>;
+            case Format::R10G10B10A2_UNORM:  return &fetchElement<Format::R10G10B10A2_UNORM>;
+            default:
+                assert(false && "ֵ֧Ķʽ!");
+                return nullptr;
+            }
+        }
+    }//ns detail
 	InputLayout::InputLayout(const InputElement* elements, uint32_t count)
 		: m_nElement(count)
 	{
@@ -54,6 +119,45 @@ namespace rl
 		}
 		m_elements = std::make_unique<InputElement[]>(m_nElement);
 		std::memcpy(m_elements.get(), elements, sizeof(InputElement) * m_nElement);
+        // ÿstreamstep rate
+        {
+            bool assigned[VERTEX_STREAM_COUNT] = {};
+            for(uint32_t i = 0; i < m_nElement; ++i)
+            {
+                auto& elem = elements[i];
+                assert((!assigned[elem.streami] || m_streamStepRates[elem.streami] == elem.instanceStepRate) && "ͬһstreaminstanceStepRateһ!");
+                assigned[elem.streami]          = true;
+                m_streamStepRates[elem.streami] = elem.instanceStepRate;
+                m_hasInstanceStreams |= elem.instanceStepRate > 0;
+            }
+            for(uint32_t i = 0; i <= m_highestStreamIndex; ++i)
+            {
+                if(assigned[i] && m_streamStepRates[i] == 0)
+                    m_vertexStreams[m_nVertexStream++] = uint8_t(i);
+            }
+        }
+        // FetchOp: elementstreamа˳, ÿelementƫ϶뵽4ֽ(ͬD3D),
+        // R8/R8G8֮float element4ֽڶ, SIMDFloat4::loaduX..XYZȡ
+        {
+            uint32_t offsets[VERTEX_STREAM_COUNT] = {};
+            m_fetchOps = std::make_unique<FetchOp[]>(m_nElement);
+            uint32_t nInstanceFetchOp = 0;
+            for(uint32_t i = 0; i < m_nElement; ++i)
+            {
+                auto& elem = elements[i];
+                assert(is_vertex_format(elem.format) && "ֵ֧Ķʽ!");
+                FetchOp op;
+                op.func      = detail::fetchFunc(elem.format);
+                op.offset    = (offsets[elem.streami] + 3) & ~3u;
+                op.streami   = elem.streami;
+                op.registeri = elem.registeri;
+                offsets[elem.streami] = op.offset + byte_count(elem.format);
+                if(elem.instanceStepRate > 0)
+                    m_fetchOps[m_nElement - 1 - nInstanceFetchOp++] = op;
+                else
+                    m_fetchOps[m_nVertexFetchOp++] = op;
+            }
+        }
         //
         {
             for(uint32_t i = 0; i < VS_REGISTER_COUNT; ++i)
@@ -68,6 +172,78 @@ namespace rl
 	InputLayout::~InputLayout()
 	{
 	}
+    void InputLayout::fetchVertex(const uint8_t* const dataptrs[VERTEX_STREAM_COUNT], VSRegisters& registers) const
+    {
+        for(uint32_t i = 0; i < m_nVertexFetchOp; ++i)
+        {
+            auto& op = m_fetchOps[i];
+            op.func(dataptrs[op.streami] + op.offset, registers[op.registeri]);
+        }
+    }
+    void InputLayout::fetchInstance(const uint8_t* const dataptrs[VERTEX_STREAM_COUNT], VSRegisters& registers) const
+    {
+        for(uint32_t i = m_nVertexFetchOp; i < m_nElement; ++i)
+        {
+            auto& op = m_fetchOps[i];
+            op.func(dataptrs[op.streami] + op.offset, registers[op.registeri]);
+        }
+    }
+    void InputLayout::copyInstanceRegisters(const VSRegisters& src, VSRegisters& dst) const
+    {
+        for(uint32_t i = m_nVertexFetchOp; i < m_nElement; ++i)
+            dst[m_fetchOps[i].registeri] = src[m_fetchOps[i].registeri];
+    }
+    ///////////////////////////////////////////////////////////////////////
+	//VisibilityBuffer
+	///////////////////////////////////////////////////////////////////////
+    VisibilityBuffer::VisibilityBuffer(uint32_t width, uint32_t height)
+        : m_width(width)
+        , m_height(height)
+        , m_samples(std::make_unique<Sample[]>(width * height))
+    {
+        assert(width > 0 && height > 0);
+    }
+    void VisibilityBuffer::clear()
+    {
+        std::fill(m_samples.get(), m_samples.get() + m_width * m_height, Sample());
+        m_draws.clear();
+        m_triangles.clear();
+    }
+    uint32_t VisibilityBuffer::beginDraw(PixelShader* ps)
+    {
+        assert(ps && "resolveʱҪPixelShader!");
+        auto state = std::make_unique<Shader::State>();
+        ps->saveState(*state);
+        m_draws.push_back({ ps, uint32_t(m_triangles.size()), std::move(state) });
+        return uint32_t(m_draws.size()) - 1;
+    }
+    uint32_t VisibilityBuffer::addTriangle(const Triangle& tri)
+    {
+        assert(!m_draws.empty() && "beginDraw!");
+        m_triangles.push_back(tri);
+        return uint32_t(m_triangles.size()) - 1 - m_draws.back().firstTriangle;
+    }
+    ///////////////////////////////////////////////////////////////////////
+	//StreamOutputBuffer
+	///////////////////////////////////////////////////////////////////////
+    StreamOutputBuffer::StreamOutputBuffer(uint32_t capacity)
+        : m_vertices(capacity)
+        , m_written(capacity, false)
+    {
+        assert(capacity > 0);
+    }
+    void StreamOutputBuffer::clear()
+    {
+        std::fill(m_written.begin(), m_written.end(), false);
+    }
+    void StreamOutputBuffer::write(uint32_t vertexi, const Vec4& position, const PSRegisters& registers)
+    {
+        assert(vertexi < m_vertices.size() && "stream output!");
+        auto& v = m_vertices[vertexi];
+        v.position  = position;
+        std::copy(std::begin(registers), std::end(registers), std::begin(v.registers));
+        m_written[vertexi] = true;
+    }
     ///////////////////////////////////////////////////////////////////////
     void lerp(const VSOutput& v0, const VSOutput& v1, Float factor, VSOutput& v2Out)
     {
@@ -80,175 +256,14 @@ namespace rl
  }//ns rl
 namespace rl
 {
-    /*
-         E(X,Y) = aX + bY + c = 0;
-         Screen PointǷEdge
-         ϵ(ϵ)(: ʱΪ)
-          ---------------->x
-          |
-         \|/y
-    */
-     struct EdgeEquation
-     {
-     public:
-         EdgeEquation() {}
-         EdgeEquation(const Vec2& v0, const Vec2& v1)
-         {
-             /*ʽֱ߷ aX + bY + c = 0;
-                     (y-y0)/(x-x0)  = (y1-y0)/(x1-x0)  
-                  => (y-y0)*(x1-x0) = (y1-y0)*(x-x0)
-                  => (x1-x0)*y -(x1-x0)y0 = (y1-y0)*x - (y1-y0)*x0
-                  => (y1-y0)*x -(x1-x0)*y +(x1-x0)y0 -(y1-y0)*x0 = 0
-             */
-             auto tmp = v1 - v0;
-             m_a =  tmp.y;
-             m_b = -tmp.x;
-             m_c =  tmp.x*v0.y - tmp.y*v0.x;
-             //Top: ˮƽx->xС; Left: yС->y
-             m_topLeft =  v0.y < v1.y/*left*/ || (v1.y == v0.y && v0.x > v1.x)/*top*/;
-         }
-         // E(X,Y) = aX + bY + c
-		 Float evaluate(Float x, Float y) const
-		 {
-			 return m_a * x + m_b * y + m_c;
-		 }
-		 Float evaluate(int x, int y) const
-		 {
-			 return this->evaluate(x + 0.5f, y + 0.5f);
-		 }
-         // E(X + stepsz, Y) = a(X+stepsz) + bY + c = E(X,Y) + a*stepsz
-         // ĵeΪĳE(X,Y),ȡ(X+stepsz)Eֵ
-         Float deltaX(Float stepsz = 1) const
-         {
-             return m_a * stepsz;
-         }
-         // E(X, Y+stepsz) = aX + b(Y+stepsz) + c = E(X,Y) + b*stepsz
-         // ԴĵeΪĳE(X,Y),ȻȡһX(X+1)Eֵ
-         Float deltaY(Float stepsz = 1) const
-         {
-             return m_b * stepsz;
-         }
-         bool inside(Float val) const
-         {
-             return val > 0 || (val == 0 && m_topLeft);
-         }
-         bool inside(int x, int y) const
-         {
-             return this->inside(this->evaluate(x, y));
-         }
-     public:
-         Float m_a, m_b, m_c;
-         bool m_topLeft;
-     };
-     // ÿԶԼPlane Attribute Equation
-     // F = aX + bY + c;
-     struct PlaneEquation
-     {
-     public:
-         PlaneEquation() {};
-         // ֱΪv0,v1,v2;
-         // ԷֱΪa0,a1,a2;
-         PlaneEquation(const Vec2& v0,const Vec2& v1,const Vec2& v2,const Vec4& a0,const Vec4& a1,const Vec4& a2)
-         {
-             /*
-                 a0 = Ax0 + By0 + C
-                 a1 = Ax1 + By1 + C
-                 a2 = Ax2 + By2 + C
-             */
-             auto sa = (v0.x - v1.x)*(v0.y - v2.y) - (v0.x - v2.x)*(v0.y-v1.y);
-             assert(sa != 0);
-             auto va = (a0 - a1)*(v0.y - v2.y) - (a0 - a2)*(v0.y - v1.y);
-             m_a = va / sa;
-
-             auto sb = (v0.y - v1.y)*(v0.x - v2.x) - (v0.y - v2.y)*(v0.x-v1.x);
-             assert(sb != 0);
-             auto vb = (a0 - a1)*(v0.x - v2.x) - (a0 - a2)*(v0.x - v1.x);
-             m_b = vb / sb;
-
-             m_c = a0 - m_a*v0.x - m_b*v0.y;
-#ifdef _DEBUG
-             auto c1 = a1 - m_a*v1.x - m_b*v1.y;
-             auto c2 = a2 - m_a*v2.x - m_b*v2.y;
-             assert(m_c.equal(c1, 0.01f));
-             assert(m_c.equal(c2, 0.01f));
-#endif
-         }
-         // E(X + stepsz, Y) = a(X+stepsz) + bY + c = E(X,Y) + a*stepsz
-         // ĵeΪĳE(X,Y),ȡ(X+stepsz)Eֵ
-         Vec4 deltaX(Float stepsz = 1) const
-         {
-             return m_a * stepsz;
-         }
-         // E(X, Y+stepsz) = aX + b(Y+stepsz) + c = E(X,Y) + b*stepsz
-         // ԴĵeΪĳE(X,Y),ȻȡһX(X+1)Eֵ
-         Vec4 deltaY(Float stepsz = 1) const
-         {
-             return m_b * stepsz;
-         }
-         Vec4 evaluate(Float x, Float y) const
-         {
-             return m_a * x + m_b * y + m_c;
-         }
-		 Vec4 evaluate(int x, int y) const
-		 {
-			 return this->evaluate(x + 0.5f, y + 0.5f);
-		 }
-     public:
-         // F(X,Y) = aX + bY + cϵ
-         Vec4 m_a, m_b, m_c;
-     };
-     struct TriangleEquation
-     {
-         EdgeEquation m_e01, m_e12, m_e20;
-         Float m_area;
-         PlaneEquation m_attributeEqns[lengthof<PSRegisters>()];
-         //(nonlinearDepth,linearDepthInv)
-         PlaneEquation m_depthEqn;
-         bool inside(int x, int y) const
-         {
-             return m_e01.inside(x, y)
-                 && m_e12.inside(x, y)
-                 && m_e20.inside(x, y);
-         }
-         bool inside(Float edgeVal0, Float edgeVal1, Float edgeVal2) const
-         {
-             return m_e01.inside(edgeVal0)
-                 && m_e12.inside(edgeVal1)
-                 && m_e20.inside(edgeVal2);
-         }
-         bool inside(const Vec3& edgeVals) const
-         {
-             return this->inside(edgeVals[0], edgeVals[1], edgeVals[2]);
-         }
-         bool isDegenerate() const
-         {
-             return std::fabs(m_area) < 0.1f;
-         }
-     };
+     // ATTRIBUTES = falseʱֵֻ(depth-only)
+     template <bool ATTRIBUTES = true>
      struct PixelTraverser
      {
-         static std::pair<Vec2i, Vec2i> calcBoundingBox(const Vec2i points[3])
-         {
-             auto boxMin = points[0], boxMax = points[0];
-             for(auto i = 1; i < 3; ++i)
-             {
-                 auto& pt = points[i];
-                 if(boxMin.x > pt.x) boxMin.x = pt.x;
-                 if(boxMax.x < pt.x) boxMax.x = pt.x;
-                 if(boxMin.y > pt.y) boxMin.y = pt.y;
-                 if(boxMax.y < pt.y) boxMax.y = pt.y;
-             }
-             boxMin.x = std::max(boxMin.x, 0);
-             boxMin.y = std::max(boxMin.y, 0);
-             boxMax.x = std::max(boxMax.x, 0);
-             boxMax.y = std::max(boxMax.y, 0);
-             return std::make_pair(boxMin, boxMax);
-         }
-
          PixelTraverser(const TriangleEquation& tri, const Vec2i points[3])
              : m_triangleEqn(tri)
          {
-             std::tie(m_boxMin, m_boxMax) = PixelTraverser::calcBoundingBox(points);
+             std::tie(m_boxMin, m_boxMax) = detail::boundingBox(points);
              m_pixelCoords = Vec2i(m_boxMin.x, m_boxMin.y);
              this->_evaluate();
          }
@@ -280,6 +295,11 @@ namespace rl
          {
              return m_triangleEqn.inside(m_edgeValues);
          }
+         // ߷pixelĵֵ
+         const Vec3& getEdgeValues() const
+         {
+             return m_edgeValues;
+         }
          const PSRegisters& getAtrributes() const
          {
              return m_attributes;
@@ -303,8 +323,11 @@ namespace rl
              m_edgeValues  ={ m_triangleEqn.m_e01.evaluate(pixelPos.x,pixelPos.y),
                               m_triangleEqn.m_e12.evaluate(pixelPos.x,pixelPos.y),
                               m_triangleEqn.m_e20.evaluate(pixelPos.x,pixelPos.y) };
-             for(uint32_t i = 0; i < lengthof<PSRegisters>(); ++i)
-                 m_attributes[i] = m_triangleEqn.m_attributeEqns[i].evaluate(pixelPos.x, pixelPos.y);
+             if constexpr(ATTRIBUTES)
+             {
+                 for(uint32_t i = 0; i < lengthof<PSRegisters>(); ++i)
+                     m_attributes[i] = m_triangleEqn.m_attributeEqns[i].evaluate(pixelPos.x, pixelPos.y);
+             }
              m_depth = m_triangleEqn.m_depthEqn.evaluate(pixelPos.x, pixelPos.y);
          }
          void _stepX_Forward()
@@ -318,8 +341,11 @@ namespace rl
                                  m_triangleEqn.m_e20.deltaX() };
                  m_edgeValues += dx;
              }
-             for(uint32_t i = 0; i < lengthof<PSRegisters>(); ++i)
-                 m_attributes[i] += m_triangleEqn.m_attributeEqns[i].deltaX();
+             if constexpr(ATTRIBUTES)
+             {
+                 for(uint32_t i = 0; i < lengthof<PSRegisters>(); ++i)
+                     m_attributes[i] += m_triangleEqn.m_attributeEqns[i].deltaX();
+             }
 
              m_depth += m_triangleEqn.m_depthEqn.deltaX();
          }
@@ -334,8 +360,11 @@ namespace rl
                                  m_triangleEqn.m_e20.deltaX()};
                  m_edgeValues -= dx;
              }
-             for(uint32_t i = 0; i < lengthof<PSRegisters>(); ++i)
-                 m_attributes[i] -= m_triangleEqn.m_attributeEqns[i].deltaX();
+             if constexpr(ATTRIBUTES)
+             {
+                 for(uint32_t i = 0; i < lengthof<PSRegisters>(); ++i)
+                     m_attributes[i] -= m_triangleEqn.m_attributeEqns[i].deltaX();
+             }
 
              m_depth -= m_triangleEqn.m_depthEqn.deltaX();
          }
@@ -348,8 +377,11 @@ namespace rl
              m_edgeValues += { m_triangleEqn.m_e01.deltaY(),
                                m_triangleEqn.m_e12.deltaY(),
                                m_triangleEqn.m_e20.deltaY()};
-             for(uint32_t i = 0; i < lengthof<PSRegisters>(); ++i)
-                 m_attributes[i] += m_triangleEqn.m_attributeEqns[i].deltaY();
+             if constexpr(ATTRIBUTES)
+             {
+                 for(uint32_t i = 0; i < lengthof<PSRegisters>(); ++i)
+                     m_attributes[i] += m_triangleEqn.m_attributeEqns[i].deltaY();
+             }
              m_depth += m_triangleEqn.m_depthEqn.deltaY();
          }
      private:
@@ -374,6 +406,9 @@ namespace rl
     class Clipper: public PipelineChild
     {
     public:
+        // üĶ
+        static constexpr uint32_t MAX_VERTEX_COUNT = 20;
+
         explicit Clipper()
             : m_nClipVertices(0) , m_stage(0)
         {
@@ -600,11 +635,11 @@ namespace rl
         }
     private:
         // еĶ(ΪüӵĶ)洢ڴ˴
-        VSOutput  m_clipVertices[20];
+        VSOutput  m_clipVertices[MAX_VERTEX_COUNT];
         // еĶĸ
         uint32_t  m_nClipVertices;
         // ÿһδβüܻһЩ㲻ɼõ)
-        VSOutput* m_pVisibleVertices[2][20];
+        VSOutput* m_pVisibleVertices[2][MAX_VERTEX_COUNT];
         // ǰɼĶ
         uint32_t  m_nVisibleVertices;
         // 01,: ׶
@@ -633,6 +668,8 @@ namespace rl
 		uint32_t m_count;
 		uint32_t m_fetchs;
 		Entry m_entries[VERTEX_CACHE_CAPACITY];
+		uint32_t m_instanceID = 0;
+		VSInput  m_instanceInput; // ǰinstanceinstance
 
 	public:
 		Vertexer() : m_count(0), m_fetchs(0)
@@ -649,83 +686,139 @@ namespace rl
             if(!ctx)
                 this->reset();
             PipelineChild::setContext(ctx);
+            if(ctx)
+                this->setInstance(0, 0);
         }
-        Entry* fetch(uint32_t vertexi)
+        // лµinstance: instanceֻȡһ, cacheеvertexһinstance, Ҫ
+        void setInstance(uint32_t instanceID, uint32_t instanceStart)
         {
-            auto curr = &m_entries[0];
-            auto dest = curr;
-            for(uint32_t i = 0; i < m_count; ++i, ++curr)
+            assert((instanceID == 0 || (!m_context->so.buffer && !m_context->ia.streamOutput)) && "stream output֧instancing!");
+            this->reset();
+            m_instanceID = instanceID;
+            auto layout = m_context->ia.layout;
+            if(m_context->ia.streamOutput || !layout->hasInstanceStreams())
+                return;
+            const uint8_t* dataptrs[VERTEX_STREAM_COUNT] = { nullptr };
+            for(uint32_t i = 0; i <= layout->getHighestStreamIndex(); ++i)
             {
-                if(curr->index == vertexi)
-                {//cache
-                    curr->fetches = m_fetchs++;
-                    return curr;
-                }
-                //ʹfetchesٵ
-                if(curr->fetches < dest->fetches)
-                    dest = curr;
+                auto& current  = m_context->ia.vstreams[i];
+                auto  stepRate = layout->getStreamStepRate(i);
+                if(!current.vbuffer || stepRate == 0)
+                    continue;
+                auto offset = current.offset + (instanceStart + instanceID / stepRate) * current.stride;
+                assert(offset < current.vbuffer->getLength());
+                dataptrs[i] = current.vbuffer->getData<uint8_t>(offset);
             }
-            if(m_count < VERTEX_CACHE_CAPACITY)
-                dest = &m_entries[m_count++];
-
-            dest->index   = vertexi;
-            dest->fetches = m_fetchs++;
-            // ִvertex shader
+            layout->fetchInstance(dataptrs, m_instanceInput.registers);
+        }
+        Entry* fetch(uint32_t vertexi)
+        {
+            if(auto hit = this->_find(vertexi))
+            {//cache
+                hit->fetches = m_fetchs++;
+                return hit;
+            }
+            auto dest = this->_allocate(vertexi);
+            // ѱ任vertex
+            if(auto so = m_context->ia.streamOutput)
             {
-                auto& vsi = dest->vertex.input;
-                auto& vso = dest->vertex.output;
-
-                this->assembleVertex(vertexi, vsi);
-                VertexShader::SystemValue sv;
-                {
-
-                }
-                m_context->vs->execute(vsi.registers, vso.registers, sv);
-                vso.position = sv.position;
+                auto& v = so->getVertex(vertexi);
+                dest->vertex.output.position  = v.position;
+                std::copy(std::begin(v.registers), std::end(v.registers), std::begin(dest->vertex.output.registers));
+                return dest;
             }
+            this->_shade(&dest, 1);
             return dest;
         }
+        // fetchcount(<= VS_BATCH_SIZE)vertexδ, һ𽻸VertexShader::executeBatchcache
+        void prefetch(const uint32_t* vertices, uint32_t count)
+        {
+            assert(count <= VS_BATCH_SIZE);
+            if(m_context->ia.streamOutput)
+                return;
+            Entry*   batch[VS_BATCH_SIZE];
+            uint32_t batchCount = 0;
+            for(uint32_t i = 0; i < count; ++i)
+            {
+                // ·entryҲcache, ظvertexִֻһ
+                if(!this->_find(vertices[i]))
+                    batch[batchCount++] = this->_allocate(vertices[i]);
+            }
+            if(batchCount > 0)
+                this->_shade(batch, batchCount);
+        }
         void assembleVertex(uint32_t vertexi, VSInput& vsiOut)
         {
             const uint8_t* dataptrs[VERTEX_STREAM_COUNT] = { nullptr };
-            auto layout = m_context->ia.layout;
-            const auto highestIndex = layout->getHighestStreamIndex();
-            for(uint32_t i = 0; i <= highestIndex; ++i)
+            auto layout  = m_context->ia.layout;
+            auto streams = layout->getVertexStreams();
+            for(uint32_t i = 0; i < layout->getVertexStreamCount(); ++i)
             {
-                auto& current = m_context->ia.vstreams[i];
-                if(!current.vbuffer)
-                    continue;
+                auto& current = m_context->ia.vstreams[streams[i]];
+                assert(current.vbuffer);
                 auto offset = current.offset + vertexi * current.stride;
                 assert(offset < current.vbuffer->getLength());
-                dataptrs[i] = current.vbuffer->getData<uint8_t>(offset);
+                dataptrs[streams[i]] = current.vbuffer->getData<uint8_t>(offset);
             }
-            for(uint32_t i = 0; i < layout->getElementNum(); ++i)
+            layout->fetchVertex(dataptrs, vsiOut.registers);
+            if(layout->hasInstanceStreams())
+                layout->copyInstanceRegisters(m_instanceInput.registers, vsiOut.registers);
+        }
+    private:
+        Entry* _find(uint32_t vertexi)
+        {
+            for(uint32_t i = 0; i < m_count; ++i)
             {
-                auto& elem  = layout->getElement(i);
-                auto& attri = vsiOut.registers[elem.registeri];
-                auto  data  = (Float*)dataptrs[elem.streami];
-                switch(elem.format)
+                if(m_entries[i].index == vertexi)
+                    return &m_entries[i];
+            }
+            return nullptr;
+        }
+        // cacheʱ滻fetchesٵ
+        Entry* _allocate(uint32_t vertexi)
+        {
+            auto dest = &m_entries[0];
+            if(m_count < VERTEX_CACHE_CAPACITY)
+                dest = &m_entries[m_count++];
+            else
+            {
+                for(uint32_t i = 1; i < m_count; ++i)
                 {
-                case Format::FLOAT32:
-                    dataptrs[elem.streami] += sizeof(Float);
-                    attri = ShaderRegister(data[0], 0, 0, 1);
-                    break;
-                case Format::VECTOR2:
-                    dataptrs[elem.streami] += 2 * sizeof(Float);
-                    attri = ShaderRegister(data[0], data[1], 0, 1);
-                    break;
-                case Format::VECTOR3:
-                    dataptrs[elem.streami] += 3 * sizeof(Float);
-                    attri = ShaderRegister(data[0], data[1], data[2], 1);
-                    break;
-                case Format::VECTOR4:
-                    dataptrs[elem.streami] += 4 * sizeof(Float);
-                    attri = ShaderRegister(data[0], data[1], data[2], data[3]);
-                    break;
-                default:
-                    break;
+                    if(m_entries[i].fetches < dest->fetches)
+                        dest = &m_entries[i];
                 }
             }
+            dest->index   = vertexi;
+            dest->fetches = m_fetchs++;
+            return dest;
+        }
+        // nentryִvertex shader
+        void _shade(Entry* const* entries, uint32_t n)
+        {
+            const VSRegisters*        inputs[VS_BATCH_SIZE];
+            PSRegisters*              outputs[VS_BATCH_SIZE];
+            VertexShader::SystemValue svs[VS_BATCH_SIZE];
+            for(uint32_t i = 0; i < n; ++i)
+            {
+                auto& vertex = entries[i]->vertex;
+                this->assembleVertex(entries[i]->index, vertex.input);
+                svs[i].vertexID   = entries[i]->index;
+                svs[i].primtiveID = 0;
+                svs[i].instanceID = m_instanceID;
+                inputs[i]  = &vertex.input.registers;
+                outputs[i] = &vertex.output.registers;
+            }
+            if(m_typedStages)
+                m_typedStages->executeVertices(*m_context->vs, inputs, outputs, svs, (1u << n) - 1);
+            else
+                m_context->vs->executeBatch(inputs, outputs, svs, (1u << n) - 1);
+            for(uint32_t i = 0; i < n; ++i)
+            {
+                auto& vso = entries[i]->vertex.output;
+                vso.position = svs[i].position;
+                if(auto so = m_context->so.buffer)
+                    so->write(entries[i]->index, vso.position, vso.registers);
+            }
         }
     };
     ///////////////////////////////////////////////////////////////////////
@@ -765,26 +858,31 @@ namespace rl
         //     vso.position.zΪnonlinear_z(scaled)
         //     vso.position.wΪ1/linear_z
         //     vso.shaderRegsiters1/linear_z( a/linear_z)raster space²Բֵ
+        // positionKernels::viewportTransformһα任n
+        void transformToViewport(VSOutput* const* vertices, uint32_t n)
+        {
+            assert(n <= Clipper::MAX_VERTEX_COUNT);
+            Vec4 positions[Clipper::MAX_VERTEX_COUNT];
+            for(uint32_t i = 0; i < n; ++i)
+                positions[i] = vertices[i]->position;
+            static_assert(sizeof(Vec4) == 4 * sizeof(Float), "Vec4Ϊxyzw!");
+            kernels().viewportTransform(&positions[0].x, n, m_context->om.viewportTransform);
+            for(uint32_t i = 0; i < n; ++i)
+            {
+                // w < FLT_EPSILONvertexûб任
+                const bool transformed = !(vertices[i]->position.w < FLT_EPSILON);
+                vertices[i]->position = positions[i];
+                // position.wд 1/linear_z(ڻָlinear registers)
+                // еԶ1/linear_z,Ϊalinear_z( a/linear_z)screen space²Բֵ
+                // depth-onlyʱֵ
+                if(transformed && m_context->ps)
+                    vertices[i]->registerMul(positions[i].w);
+            }
+        }
         void transformToViewport(VSOutput& vso)
         {
-            // vso.positionΪ homogeneous space,wΪlinear depth
-            if(vso.position.w < FLT_EPSILON)
-                return;
-            // תNDC Space
-            const auto invW = 1.0f / vso.position.w;
-            vso.position.x *= invW;
-            vso.position.y *= invW;
-            vso.position.z *= invW;
-            vso.position.w  = 1.0f;
-            // xyתRaster space
-            vso.position.x = clamp(vso.position.x, -0.99999f, 0.99999f);
-            vso.position.y = clamp(vso.position.y, -0.99999f, 0.99999f);
-            vso.position.z = clamp(vso.position.z,  0.0f, 0.99999f);
-            vso.position *= m_context->om.viewportTransform;
-            // position.wд 1/linear_z(ڻָlinear registers)
-            vso.position.w = invW;
-            // еԶ1/linear_z,Ϊalinear_z( a/linear_z)screen space²Բֵ
-            vso.registerMul(invW);
+            VSOutput* vertices[1] = { &vso };
+            this->transformToViewport(vertices, 1);
         }
     public:
         Rasterizer()
@@ -799,7 +897,9 @@ namespace rl
             //const Vec2i points[2] ={ vs0.position.xy(),vs1.position.xy() };
             //this->rasterizeLine(points[0].x, points[0].y, points[1].x, points[1].y, Vec4::WHITE);
             //return;
-
+            // ߶ֻдcolor, depth-onlyvisibility bufferʱûпдrender target
+            if(!m_context->ps || m_context->om.visibilityBuffer)
+                return;
             // Homogeneous spaceвü(ܰExternal Trianglesõ)
             m_clipper->planeClip(v0.output, v1.output);
             const auto n = m_clipper->getVisibleVertexCount();
@@ -807,8 +907,7 @@ namespace rl
                 return;
             assert(n == 2);
             auto vertices = m_clipper->getVisibleVertices();
-            for(uint32_t i = 0; i < n; ++i)
-                this->transformToViewport(*vertices[i]);
+            this->transformToViewport(vertices, n);
             // scissor testing
             if(m_context->rs.scissorEnabled)
             {
@@ -846,13 +945,10 @@ namespace rl
             if(n < 3)
                 return;
             auto vertices = m_clipper->getVisibleVertices();
-            // תһεRasterռbackface culling
-            for(uint32_t i = 0; i < 3; ++i)
-                this->transformToViewport(*vertices[i]);
+            // ȫתRasterռ, ɵһbackface culling
+            this->transformToViewport(vertices, n);
             if(this->cull(*vertices[0], *vertices[1], *vertices[2]))
                 return;
-            for(uint32_t i = 3; i < n; ++i)
-               this->transformToViewport(*vertices[i]);
             // scissor testing
             if(m_context->rs.scissorEnabled)
             {
@@ -862,6 +958,8 @@ namespace rl
             // ִhalfspace㷨դ
             for(uint32_t i = 1; i < n - 1; ++i)
                 this->rasterizeTriangle(*vertices[0], *vertices[i], *vertices[i + 1]);
+            // fanеλص, Ŷӵblendһִ
+            this->_flushBlend();
         }
         void setContext(const Context* ctx) 
         {
@@ -873,22 +971,43 @@ namespace rl
                 mutCtx->om.viewportTransform =
                     Transform::viewport(vp.topLeftX, vp.topLeftY, vp.width, vp.height, vp.minDepth, vp.maxDepth);
 
-                auto color = ctx->om.renderTargets[0];
-                mutCtx->om.colorData = color->lock();
-                mutCtx->om.colorFloatCount = color->getFormatFloatCount();
-                mutCtx->om.colorBufferPitch = color->getWidth() * color->getFormatFloatCount();
+                // psΪnullptrʱdepth-only: render target, ֻдdepthStencil
+                assert((ctx->ps || !ctx->om.renderTargets[0]) && "depth-onlyʱܰrender target!");
+                if(auto color = ctx->om.renderTargets[0])
+                {
+                    m_colorLocked = color->lock();
+                    mutCtx->om.colorData = m_colorLocked.data;
+                    mutCtx->om.colorFloatCount = color->getFormatFloatCount();
+                    mutCtx->om.colorBufferPitch = m_colorLocked.pitch;
+                }
+                else
+                    mutCtx->om.colorData = nullptr;
+                if(auto vbuffer = ctx->om.visibilityBuffer)
+                {
+                    assert(ctx->ps && "visibility bufferҪPixelShaderresolve!");
+                    assert(vbuffer->getWidth() == ctx->om.depthStencil->getWidth() && vbuffer->getHeight() == ctx->om.depthStencil->getHeight());
+                    m_drawID = vbuffer->beginDraw(ctx->ps);
+                }
 
                 auto depth = ctx->om.depthStencil;
-                mutCtx->om.depthData = depth->lock();
-                mutCtx->om.depthBufferPitch = depth->getWidth();
+                m_depthLocked = depth->lock();
+                mutCtx->om.depthData = m_depthLocked.data;
+                mutCtx->om.depthBufferPitch = m_depthLocked.pitch;
                 mutCtx->om.depthFloatCount = depth->getFormatFloatCount();
+
+                mutCtx->om.sampleCount = depth->getSampleCount();
+                assert((!ctx->om.renderTargets[0] || ctx->om.renderTargets[0]->getSampleCount() == depth->getSampleCount()) && "sampleһ!");
+                assert((ctx->om.sampleCount == 1 || (ctx->ps && !ctx->om.visibilityBuffer && ctx->rs.shadingRate == ShadingRate::_1X1 && !ctx->rs.shadingRateTiles))
+                       && "multisampledֻ֧ͨcolor pass!");
+                if(ctx->om.sampleCount > 1)
+                    _samplePattern(ctx->om.sampleCount, m_sampleOffsets);
             }
             else
             {
-                auto color = m_context->om.renderTargets[0];
-                color->unlock();
+                if(auto color = m_context->om.renderTargets[0])
+                    color->unlock(m_colorLocked);
                 auto depth = m_context->om.depthStencil;
-                depth->unlock();
+                depth->unlock(m_depthLocked);
             }
             PipelineChild::setContext(ctx);
             m_clipper->setContext(ctx);
@@ -896,8 +1015,8 @@ namespace rl
     private:
         void setColor(int x, int y, const Vec4& val)
         {
-            Float* colorData = m_context->om.colorData + (y * m_context->om.colorBufferPitch + x * m_context->om.colorFloatCount);
-            val.copyTo(colorData, m_context->om.colorFloatCount);
+            for(uint32_t s = 0; s < m_context->om.sampleCount; ++s)
+                val.copyTo(this->_colorAddress(x, y, s), m_context->om.colorFloatCount);
         }
         // 汾Bresenham㷨
         //*.steep:  swap
@@ -966,88 +1085,414 @@ namespace rl
         void rasterizeTriangle(const VSOutput& v0, const VSOutput& v1, const VSOutput& v2)
         {
             TriangleEquation triEqn;
-            this->_initTriangleEquation(v0, v1, v2, triEqn);
+            this->_initTriangleEquation(v0, v1, v2, triEqn, m_context->ps && !m_context->om.visibilityBuffer);
             if(triEqn.isDegenerate())
                 return;//˻
             const Vec2i points[3] = { v0.position.xy(),v1.position.xy(),v2.position.xy() };
+            if(!m_context->ps)
+            {
+                this->_rasterizeDepthOnly(triEqn, points);
+                return;
+            }
             if(m_context->rs.fillMode == FillMode::WIRE_FRAME)
             {
+                // ߿ֻдcolor, ͬscheduleLine: visibility bufferʱûпдrender target, 
+                if(m_context->om.visibilityBuffer)
+                    return;
                 this->rasterizeLine(points[0].x, points[0].y,points[1].x, points[1].y,Vec4::WHITE);
                 this->rasterizeLine(points[1].x, points[1].y,points[2].x, points[2].y,Vec4::WHITE);
                 this->rasterizeLine(points[2].x, points[2].y,points[0].x, points[0].y,Vec4::WHITE);
                 return;
             }
-            PixelTraverser traverser(triEqn,points);
-			auto renderedCount = 0;
-            // ʹEdge TestжǷΪinside
+            if(auto vbuffer = m_context->om.visibilityBuffer)
+            {
+                this->_rasterizeVisibility(*vbuffer, v0, v1, v2, triEqn, points);
+                return;
+            }
+            if(m_context->rs.shadingRate != ShadingRate::_1X1 || m_context->rs.shadingRateTiles)
+            {
+                this->_rasterizeCoarse(triEqn, points);
+                return;
+            }
+            if(m_context->om.sampleCount > 1)
+            {
+                this->_rasterizeMultisample(triEqn, points);
+                return;
+            }
+            // Pipeline::draw<VS, PS>: ʹðshaderʵĹդѭ
+            if(m_typedStages)
+            {
+                m_typedStages->rasterizeSolid(*this, *m_context->ps, triEqn, points);
+                return;
+            }
+            auto ps = m_context->ps;
+            detail::rasterizeSolid(triEqn, points,
+                                   [ps](const PSRegisters* const varyings[PS_BATCH_SIZE], PixelShader::SystemValue svs[PS_BATCH_SIZE], uint32_t mask)
+                                   { return ps->executeBatch(varyings, svs, mask); },
+                                   [this](const Vec2i coords[PS_BATCH_SIZE], const PixelShader::SystemValue svs[PS_BATCH_SIZE], uint32_t passed, uint32_t count)
+                                   { this->outputMerge(coords, svs, passed, count); });
+        }
+    public:
+        // ͨPixelShaderpixel(passedĵiλӦcoords[i])Ȳ, blendдrender target
+        void outputMerge(const Vec2i coords[PS_BATCH_SIZE], const PixelShader::SystemValue svs[PS_BATCH_SIZE], uint32_t passed, uint32_t count)
+        {
+            for(uint32_t i = 0; i < count; ++i)
+            {
+                if(passed & (1u << i))
+                    this->_outputMerge(coords[i].x, coords[i].y, svs[i]);
+            }
+        }
+        // ÿɼpixelִһdrawPixelShader; ͬһεpixelؽԷ
+        void resolveVisibility(const VisibilityBuffer& vbuffer, Surface* renderTarget)
+        {
+            assert(renderTarget && renderTarget->getWidth() == vbuffer.getWidth() && renderTarget->getHeight() == vbuffer.getHeight());
+            auto locked = renderTarget->lock();
+            const auto floatCount = renderTarget->getFormatFloatCount();
+
+            TriangleEquation triEqn;
+            VisibilityBuffer::Sample current;
+            PixelShader* ps = nullptr;
+            // ÿPixelShaderǰָĸdraw״̬; ͬһPSdrawʱҪ»ָ
+            std::vector<std::pair<PixelShader*, uint32_t>> restoredDraws;
+
+            PixelShader::SystemValue svs[PS_BATCH_SIZE];
+            PSRegisters              batchVaryings[PS_BATCH_SIZE];
+            const PSRegisters*       batchVaryingPtrs[PS_BATCH_SIZE];
+            Vec2i                    batchCoords[PS_BATCH_SIZE];
+            uint32_t                 batchCount = 0;
+            auto flush = [&]()
+            {
+                const auto passed = ps->executeBatch(batchVaryingPtrs, svs, (1u << batchCount) - 1);
+                for(uint32_t i = 0; i < batchCount; ++i)
+                {
+                    if(passed & (1u << i))
+                        svs[i].targets[svs[i].targetIndex].copyTo(locked.row(batchCoords[i].y) + batchCoords[i].x * floatCount, floatCount);
+                }
+                batchCount = 0;
+            };
+            for(uint32_t y = 0; y < vbuffer.getHeight(); ++y)
+            {
+                for(uint32_t x = 0; x < vbuffer.getWidth(); ++x)
+                {
+                    const auto& sample = vbuffer.getSample(x, y);
+                    if(sample.drawID == VisibilityBuffer::INVALID_ID)
+                        continue;
+                    if(sample.drawID != current.drawID || sample.primitiveID != current.primitiveID)
+                    {
+                        // еpixeltriEqnƫ, ִ
+                        if(batchCount > 0)
+                            flush();
+                        const auto& tri = vbuffer.getTriangle(sample);
+                        VSOutput vertices[3];
+                        for(uint32_t k = 0; k < 3; ++k)
+                        {
+                            vertices[k].position = tri.positions[k];
+                            std::copy(std::begin(tri.registers[k]), std::end(tri.registers[k]), std::begin(vertices[k].registers));
+                        }
+                        this->_initTriangleEquation(vertices[0], vertices[1], vertices[2], triEqn);
+                        if(sample.drawID != current.drawID)
+                        {
+                            ps = vbuffer.getPixelShader(sample.drawID);
+                            auto restored = std::find_if(restoredDraws.begin(), restoredDraws.end(),
+                                                         [ps](const std::pair<PixelShader*, uint32_t>& r) { return r.first == ps; });
+                            if(restored == restoredDraws.end())
+                                restored = restoredDraws.insert(restoredDraws.end(), { ps, VisibilityBuffer::INVALID_ID });
+                            if(restored->second != sample.drawID)
+                            {
+                                ps->restoreState(vbuffer.getShaderState(sample.drawID));
+                                ps->preamble();
+                                restored->second = sample.drawID;
+                            }
+                        }
+                        current = sample;
+                    }
+                    // pixelֵԷ, ؽֵ
+                    PSRegisters attributes;
+                    for(uint32_t i = 0; i < lengthof<PSRegisters>(); ++i)
+                        attributes[i] = triEqn.m_attributeEqns[i].evaluate(int(x), int(y));
+                    const auto depth = triEqn.m_depthEqn.evaluate(int(x), int(y));
+                    detail::setupPixel(triEqn, Vec2(x + 0.5f, y + 0.5f), depth.x, depth.y, attributes, batchVaryings[batchCount], svs[batchCount]);
+                    batchVaryingPtrs[batchCount] = &batchVaryings[batchCount];
+                    batchCoords[batchCount]      = Vec2i(int(x), int(y));
+                    if(++batchCount == PS_BATCH_SIZE)
+                        flush();
+                }
+            }
+            if(batchCount > 0)
+                flush();
+            renderTarget->unlock(locked);
+        }
+    private:
+        // D3Dı׼sampleλ(1/16 pixelΪλ, pixel)
+        static void _samplePattern(uint32_t sampleCount, Vec2 offsets[MAX_SAMPLE_COUNT])
+        {
+            static const int8_t PATTERN_2[2][2] = { { 4, 4 }, { -4, -4 } };
+            static const int8_t PATTERN_4[4][2] = { { -2, -6 }, { 6, -2 }, { -6, 2 }, { 2, 6 } };
+            static const int8_t PATTERN_8[8][2] = { { 1, -3 }, { -1, 3 }, { 5, 1 }, { -3, -5 }, { -5, 5 }, { -7, -1 }, { 3, 7 }, { 7, -7 } };
+            const int8_t (*pattern)[2] = sampleCount == 2 ? PATTERN_2 : (sampleCount == 4 ? PATTERN_4 : PATTERN_8);
+            for(uint32_t s = 0; s < sampleCount; ++s)
+                offsets[s] = Vec2(pattern[s][0] / Float(16), pattern[s][1] / Float(16));
+        }
+        // MSAA: Ǻsample, PixelShaderÿpixelִֻһ, дͨԵĸsample
+        void _rasterizeMultisample(const TriangleEquation& triEqn, const Vec2i points[3])
+        {
+            const auto& om          = m_context->om;
+            const auto  sampleCount = om.sampleCount;
+            const auto  sampleMask  = om.sampleMask & ((1u << sampleCount) - 1);
+            // samplepixelĵı߷̺ȵ, ÿΪ
+            Vec3  edgeDeltas[MAX_SAMPLE_COUNT];
+            Float depthDeltas[MAX_SAMPLE_COUNT];
+            for(uint32_t s = 0; s < sampleCount; ++s)
+            {
+                const auto& o = m_sampleOffsets[s];
+                edgeDeltas[s]  = { triEqn.m_e01.m_a * o.x + triEqn.m_e01.m_b * o.y,
+                                   triEqn.m_e12.m_a * o.x + triEqn.m_e12.m_b * o.y,
+                                   triEqn.m_e20.m_a * o.x + triEqn.m_e20.m_b * o.y };
+                depthDeltas[s] = triEqn.m_depthEqn.m_a.x * o.x + triEqn.m_depthEqn.m_b.x * o.y;
+            }
+            PixelTraverser<> traverser(triEqn, points);
+            PixelShader::SystemValue svs[PS_BATCH_SIZE];
+            PSRegisters              batchVaryings[PS_BATCH_SIZE];
+            const PSRegisters*       batchVaryingPtrs[PS_BATCH_SIZE];
+            Vec2i                    batchCoords[PS_BATCH_SIZE];
+            Float                    batchDepths[PS_BATCH_SIZE];
+            uint32_t                 batchCount = 0;
+            auto flush = [&]()
+            {
+                const auto passed = m_context->ps->executeBatch(batchVaryingPtrs, svs, (1u << batchCount) - 1);
+                for(uint32_t i = 0; i < batchCount; ++i)
+                {
+                    if(!(passed & (1u << i)))
+                        continue;
+                    auto& sv = svs[i];
+                    // PixelShadercoverageֻȥsample
+                    auto coverage = sv.coverage;
+                    if(om.alphaToCoverageEnabled)
+                        coverage &= (1u << uint32_t(saturate(sv.targets[0].a) * sampleCount + Float(0.5))) - 1;
+                    for(uint32_t s = 0; s < sampleCount; ++s)
+                    {
+                        if(!(coverage & (1u << s)))
+                            continue;
+                        sv.depth = batchDepths[i] + depthDeltas[s];
+                        this->_outputMerge(batchCoords[i].x, batchCoords[i].y, sv, s);
+                    }
+                }
+                batchCount = 0;
+            };
             while(traverser.traverse())
             {
-                auto x = traverser.getPixelCoords().x, y = traverser.getPixelCoords().y;
-                if(!traverser.isInsideTriangle())
+                uint32_t coverage = 0;
+                if(m_context->rs.multisampleEnabled)
                 {
-                    //Float* c = m_context->om.colorData + (y * m_context->om.colorBufferPitch + x * m_context->om.colorFloatCount);
-                    //ColorValue::BLUE.copyTo(c, m_context->om.colorFloatCount);
-                    continue;
+                    for(uint32_t s = 0; s < sampleCount; ++s)
+                        coverage |= triEqn.inside(traverser.getEdgeValues() + edgeDeltas[s]) ? (1u << s) : 0;
                 }
-                PixelShader::SystemValue sv;
+                else if(traverser.isInsideTriangle())
+                    coverage = (1u << sampleCount) - 1;
+                coverage &= sampleMask;
+                if(!coverage)
+                    continue;
+                const auto x = traverser.getPixelCoords().x, y = traverser.getPixelCoords().y;
+                // δʱ԰
+                detail::setupPixel(triEqn, Vec2(x + 0.5f, y + 0.5f), traverser.getNonlinearDepth(), traverser.getInverseLinearDepth(), traverser.getAtrributes(),
+                            batchVaryings[batchCount], svs[batchCount]);
+                svs[batchCount].coverage     = coverage;
+                svs[batchCount].sampleIndex  = 0;
+                batchDepths[batchCount]      = traverser.getNonlinearDepth();
+                batchVaryingPtrs[batchCount] = &batchVaryings[batchCount];
+                batchCoords[batchCount]      = Vec2i(x, y);
+                if(++batchCount == PS_BATCH_SIZE)
+                    flush();
+            }
+            if(batchCount > 0)
+                flush();
+        }
+        // (x, y)tileshading rate; ûtileʱΪdrawshading rate
+        uint32_t _shadingRate(int x, int y) const
+        {
+            const auto& rs = m_context->rs;
+            if(!rs.shadingRateTiles)
+                return uint32_t(rs.shadingRate);
+            return uint32_t(rs.shadingRateTiles[(y / rs.shadingRateTileSize) * rs.shadingRateTileCols + x / rs.shadingRateTileSize]);
+        }
+        // coarse pixel shading: 4x4, ÿshading rateֳrate x rateblock
+        // ÿblockִһPixelShader, дblockڱǵpixel; Ⱥ͸pixel
+        void _rasterizeCoarse(const TriangleEquation& triEqn, const Vec2i points[3])
+        {
+            assert(!m_context->rs.shadingRateTiles || m_context->rs.shadingRateTileSize % 4 == 0);
+            const auto box = detail::boundingBox(points);
+            // ddx/ddycoarse pixelĲ: ±Ϊlog2(rate)
+            PSRegisters attributesDx[3], attributesDy[3];
+            for(uint32_t level = 0; level < 3; ++level)
+            {
+                for(uint32_t i = 0; i < lengthof<PSRegisters>(); ++i)
                 {
-                    sv.depth       = traverser.getNonlinearDepth();
-                    sv.position    = {x + 0.5f,y + 0.5f,sv.depth ,1.0f };
-                    sv.targetIndex = 0;
+                    attributesDx[level][i] = triEqn.m_attributesDx[i] * Float(1u << level);
+                    attributesDy[level][i] = triEqn.m_attributesDy[i] * Float(1u << level);
                 }
-                PSRegisters linearAttributes;
-                for(int i = 0; i < lengthof(linearAttributes); ++i)
-                    linearAttributes[i] = traverser.getAtrributes()[i] / traverser.getInverseLinearDepth();
-                m_context->ps->execute(linearAttributes, sv);
-
-                Float* depthData = m_context->om.depthData + (y * m_context->om.depthBufferPitch + x * m_context->om.depthFloatCount);
-                Float* colorData = m_context->om.colorData + (y * m_context->om.colorBufferPitch + x * m_context->om.colorFloatCount);
-
-                bool depthPassed = true;
-                if(m_context->om.depthEnabled)
-                    depthPassed = _doDepthTest(m_context->om.depthCmpFunc, sv.depth, *depthData);
-                if(depthPassed)
+            }
+            struct Block
+            {
+                Vec2i    origin;
+                uint32_t rate;
+                uint32_t coverage; // (y * rate + x)λ: block(x, y)
+            };
+            Block                    blocks[PS_BATCH_SIZE];
+            PixelShader::SystemValue svs[PS_BATCH_SIZE];
+            PSRegisters              batchVaryings[PS_BATCH_SIZE];
+            const PSRegisters*       batchVaryingPtrs[PS_BATCH_SIZE];
+            uint32_t                 batchCount = 0;
+            auto flush = [&]()
+            {
+                const auto passed = m_context->ps->executeBatch(batchVaryingPtrs, svs, (1u << batchCount) - 1);
+                for(uint32_t i = 0; i < batchCount; ++i)
                 {
-                    if(m_context->om.depthWriteEnabled)
-                        *depthData = sv.depth;
-                    const Blend* blend = nullptr;
+                    if(!(passed & (1u << i)))
+                        continue;
+                    const auto& block = blocks[i];
+                    for(uint32_t k = 0; k < block.rate * block.rate; ++k)
                     {
-                        //false: еRTblends[0]; true: RTiʹӦblends[i]
-                        if(m_context->om.independentBlendEnabled)
-                            blend = &m_context->om.blends[sv.targetIndex];
-                        else
-                            blend = &m_context->om.blends[0];
+                        if(!(block.coverage & (1u << k)))
+                            continue;
+                        const auto x = block.origin.x + int(k % block.rate), y = block.origin.y + int(k / block.rate);
+                        svs[i].depth = triEqn.m_depthEqn.evaluate(x, y).x; // pixel
+                        this->_outputMerge(x, y, svs[i]);
                     }
-                    if(blend && blend->enabled)
+                }
+                batchCount = 0;
+            };
+            for(auto ry = box.first.y & ~3; ry <= box.second.y; ry += 4)
+            {
+                for(auto rx = box.first.x & ~3; rx <= box.second.x; rx += 4)
+                {
+                    const auto rate  = this->_shadingRate(rx, ry);
+                    const auto level = rate == 1 ? 0 : (rate == 2 ? 1 : 2);
+                    assert(rate == 1 || rate == 2 || rate == 4);
+                    for(auto by = ry; by < ry + 4; by += int(rate))
                     {
-                        // SRC_blendfactor(Current) blendop DST_blendfactor(Backbuffer)
-                        const auto& srcRGBA = sv.targets[sv.targetIndex];
-                        const auto  dstRGBA = Vec4().set(colorData, m_context->om.colorFloatCount);
-
-                        auto srcFactor = srcRGBA, dstFactor = dstRGBA;
-                        {
-                            srcFactor.rgb(_resolveBlendColor(blend->srcBlend, srcRGBA, dstRGBA, m_context->om.blendFactor));
-                            dstFactor.rgb(_resolveBlendColor(blend->dstBlend, srcRGBA, dstRGBA, m_context->om.blendFactor));
-
-                            srcFactor.a = _resolveBlendAlpha(blend->srcBlendAlpha, srcRGBA.a, dstRGBA.a, m_context->om.blendFactor[3]);
-                            dstFactor.a = _resolveBlendAlpha(blend->dstBlendAlpha, srcRGBA.a, dstRGBA.a, m_context->om.blendFactor[3]);
-                        }
-                        auto color = Vec4::ZERO;
+                        for(auto bx = rx; bx < rx + 4; bx += int(rate))
                         {
-                            color.rgb(_blendOperationColor(blend->blendOp, srcRGBA.rgb()*srcFactor.rgb(), dstRGBA.rgb()*dstFactor.rgb()));
-                            color.a = _blendOperationAlpha(blend->blendOpAlpha, srcRGBA.a*srcFactor.a, dstFactor.a*dstFactor.a);
+                            uint32_t coverage = 0;
+                            for(uint32_t k = 0; k < rate * rate; ++k)
+                            {
+                                const auto x = bx + int(k % rate), y = by + int(k / rate);
+                                if(box.first.x <= x && x <= box.second.x && box.first.y <= y && y <= box.second.y && triEqn.inside(x, y))
+                                    coverage |= 1u << k;
+                            }
+                            if(!coverage)
+                                continue;
+                            const Vec2 center(bx + rate * 0.5f, by + rate * 0.5f);
+                            PSRegisters attributes;
+                            for(uint32_t i = 0; i < lengthof<PSRegisters>(); ++i)
+                                attributes[i] = triEqn.m_attributeEqns[i].evaluate(center.x, center.y);
+                            const auto depth = triEqn.m_depthEqn.evaluate(center.x, center.y);
+                            auto& sv = svs[batchCount];
+                            detail::setupPixel(triEqn, center, depth.x, depth.y, attributes, batchVaryings[batchCount], sv);
+                            sv.varyingsDx  = &attributesDx[level];
+                            sv.varyingsDy  = &attributesDy[level];
+                            sv.invDepth.y *= Float(rate);
+                            sv.invDepth.z *= Float(rate);
+                            blocks[batchCount]           = { Vec2i(bx, by), rate, coverage };
+                            batchVaryingPtrs[batchCount] = &batchVaryings[batchCount];
+                            if(++batchCount == PS_BATCH_SIZE)
+                                flush();
                         }
-                        if(blend->writeMask&ColorWriteEnable::ALL)
-                            color.copyTo(colorData, m_context->om.colorFloatCount);
                     }
+                }
+            }
+            if(batchCount > 0)
+                flush();
+        }
+        // visibility buffer: ¼βֵֻ, ͨȲԵpixelд(drawID, primitiveID)
+        void _rasterizeVisibility(VisibilityBuffer& vbuffer, const VSOutput& v0, const VSOutput& v1, const VSOutput& v2,
+                                  const TriangleEquation& triEqn, const Vec2i points[3])
+        {
+            VisibilityBuffer::Triangle tri;
+            const VSOutput* vertices[3] = { &v0, &v1, &v2 };
+            for(uint32_t k = 0; k < 3; ++k)
+            {
+                tri.positions[k] = vertices[k]->position;
+                std::copy(std::begin(vertices[k]->registers), std::end(vertices[k]->registers), std::begin(tri.registers[k]));
+            }
+            VisibilityBuffer::Sample id;
+            id.drawID      = m_drawID;
+            id.primitiveID = vbuffer.addTriangle(tri);
+
+            this->_depthSpans(triEqn, points, [&](int x0, int y, uint32_t passed)
+            {
+                for(uint32_t k = 0; k < 32; ++k)
+                {
+                    if(passed & (1u << k))
+                        vbuffer.getSample(x0 + int(k), y) = id;
+                }
+            });
+        }
+        // depth-only(ps == nullptr): ֵֻƽ, ִPixelShader, ֻд
+        void _rasterizeDepthOnly(const TriangleEquation& triEqn, const Vec2i points[3])
+        {
+            this->_depthSpans(triEqn, points, [](int, int, uint32_t) {});
+        }
+        // Kernels::depthSpanԸǵpixelȲ(д), ÿεfn(x, y, passed), passedĵiλӦx + i
+        template<typename Fn>
+        void _depthSpans(const TriangleEquation& triEqn, const Vec2i points[3], Fn fn)
+        {
+            const auto& om     = m_context->om;
+            const auto  span   = triEqn.rasterSpan();
+            const auto  cmp    = om.depthEnabled ? om.depthCmpFunc : CmpFunc::ALWAYS;
+            const auto  stride = om.depthFloatCount * om.sampleCount;
+            detail::forEachSpan(points, [&](int x, int y, uint32_t count)
+            {
+                const auto passed = kernels().depthSpan(span, x, y, count, this->_depthAddress(x, y, 0), stride,
+                                                        uint32_t(cmp), om.depthWriteEnabled);
+                if(passed)
+                    fn(x, y, passed);
+            });
+        }
+        // Ȳ, ͨʱdepthWriteEnabledд; Ƿͨ
+        Float* _colorAddress(int x, int y, uint32_t sampleIndex) const
+        {
+            return m_context->om.colorData + (y * m_context->om.colorBufferPitch + (x * m_context->om.sampleCount + sampleIndex) * m_context->om.colorFloatCount);
+        }
+        Float* _depthAddress(int x, int y, uint32_t sampleIndex) const
+        {
+            return m_context->om.depthData + (y * m_context->om.depthBufferPitch + (x * m_context->om.sampleCount + sampleIndex) * m_context->om.depthFloatCount);
+        }
+        bool _outputDepth(int x, int y, Float depth, uint32_t sampleIndex = 0)
+        {
+            Float* depthData = this->_depthAddress(x, y, sampleIndex);
+            if(m_context->om.depthEnabled && !_doDepthTest(m_context->om.depthCmpFunc, depth, *depthData))
+                return false;
+            if(m_context->om.depthWriteEnabled)
+                *depthData = depth;
+            return true;
+        }
+        // Ȳ, blendдrender target; Ƿд
+        bool _outputMerge(int x, int y, const PixelShader::SystemValue& sv, uint32_t sampleIndex = 0)
+        {
+            Float* colorData = this->_colorAddress(x, y, sampleIndex);
+            if(this->_outputDepth(x, y, sv.depth, sampleIndex))
+            {
+                const Blend* blend = nullptr;
+                {
+                    //false: еRTblends[0]; true: RTiʹӦblends[i]
+                    if(m_context->om.independentBlendEnabled)
+                        blend = &m_context->om.blends[sv.targetIndex];
                     else
-                        sv.targets[sv.targetIndex].copyTo(colorData, m_context->om.colorFloatCount);
-                    ++renderedCount;
+                        blend = &m_context->om.blends[0];
                 }
+                if(blend && blend->enabled)
+                {
+                    // SRC_blendfactor(Current) blendop DST_blendfactor(Backbuffer)
+                    // ͬһ(fan)еpixelص, Ƴٵ_flushBlend
+                    if(blend->writeMask&ColorWriteEnable::ALL)
+                        this->_queueBlend(blend, sv.targets[sv.targetIndex], colorData);
+                }
+                else
+                    sv.targets[sv.targetIndex].copyTo(colorData, m_context->om.colorFloatCount);
+                return true;
             }
-			auto ratio = Float(renderedCount) / traverser.getPixelCount();
+            return false;
         }
-    private:
         static bool _doDepthTest(CmpFunc cmp,Float src ,Float dst)
         {
             switch(cmp)
@@ -1082,161 +1527,36 @@ namespace rl
             }
             return false;
         }
-        static Float _blendOperationAlpha(BlendOp op, Float src, Float dst)
+        // ܵ, _flushBlendһ𽻸Kernels::blend
+        void _queueBlend(const Blend* blend, const Vec4& src, Float* colorData)
         {
-            auto alpha = Float(0);
-            switch(op)
-            {
-            case BlendOp::ADD:
-                alpha = src + dst;
-                break;
-            case BlendOp::SUBTRACT:
-                alpha = dst - src;
-                break;
-            case BlendOp::REV_SUBTRACT:
-                alpha = src - dst;
-                break;
-            case BlendOp::MIN:
-                alpha = std::min(src, dst);
-                break;
-            case BlendOp::MAX:
-                alpha = std::max(src, dst);
-                break;
-            }
-            return alpha;
-        }
-        static Vec3 _blendOperationColor(BlendOp op, const Vec3& src, const Vec3& dst)
-        {
-            auto color = Vec3::ZERO;
-            switch(op)
-            {
-            case BlendOp::ADD:
-                color = src + dst;
-                break;
-            case BlendOp::SUBTRACT:
-                color = dst - src;
-                break;
-            case BlendOp::REV_SUBTRACT:
-                color = src - dst;
-                break;
-            case BlendOp::MIN:
-                color.set( std::min(src.r, dst.r),
-                           std::min(src.g, dst.g),
-                           std::min(src.b, dst.b) );
-                break;
-            case BlendOp::MAX:
-                color.set( std::max(src.r, dst.r),
-                           std::max(src.g, dst.g),
-                           std::max(src.b, dst.b));
-                break;
-            }
-            return color;
-        }
-        static Vec3 _resolveBlendColor(BlendFactor blend, const Vec4& src, const Vec4& dst,const Float* factors)
-        {
-            auto result = Vec3::ZERO;
-            switch(blend)
-            {
-            case BlendFactor::ZERO:
-                result = Vec3::ZERO;
-                break;
-            case BlendFactor::ONE:
-                result = Vec3::ONE;
-                break;
-            case BlendFactor::SRC_COLOR:
-                result = src.rgb();
-                break;
-            case BlendFactor::INV_SRC_COLOR:
-                result = Vec3::ONE - src.rgb();
-                break;
-            case BlendFactor::DEST_COLOR:
-                result = dst.rgb();
-                break;
-            case BlendFactor::INV_DEST_COLOR:
-                result = Vec3::ONE - dst.rgb();
-                break;
-            case BlendFactor::BLEND_FACTOR:
-                result.set(factors, 3);
-                break;
-            case BlendFactor::INV_BLEND_FACTOR:
-                result = Vec3::ONE - Vec3().set(factors, 3);
-                break;
-            case BlendFactor::SRC_ALPHA_SAT:
-                result = Vec3(saturate(src.a),saturate(src.a),saturate(src.a));
-                break;
-            case BlendFactor::SRC_ALPHA:
-                result = Vec3(src.a,src.a,src.a);
-                break;
-            case BlendFactor::INV_SRC_ALPHA:
-                result = Vec3(1 - src.a, 1 - src.a, 1 - src.a);
-                break;
-            case BlendFactor::DEST_ALPHA:
-                result = Vec3(dst.a, dst.a,dst.a);
-                break;
-            case BlendFactor::INV_DEST_ALPHA:
-                result = Vec3(1 - dst.a, 1 - dst.a, 1 - dst.a);
-                break;
-            case BlendFactor::SRC1_COLOR:
-            case BlendFactor::INV_SRC1_COLOR:
-            case BlendFactor::SRC1_ALPHA:
-            case BlendFactor::INV_SRC1_ALPHA:
-                assert(false && "δʵdual source color blending");
-                break;
-            default:
-                break;
-            }
-            return result;
+            if(m_blendCount == BLEND_QUEUE_SIZE || (m_blendCount > 0 && m_blend != blend))
+                this->_flushBlend();
+            m_blend = blend;
+            m_blendSources[m_blendCount] = src;
+            m_blendTargets[m_blendCount] = colorData;
+            ++m_blendCount;
         }
-        static Float _resolveBlendAlpha(BlendFactor blend, Float src, Float dst,Float factor)
+        void _flushBlend()
         {
-            auto result = Float(0);
-            switch(blend)
+            if(m_blendCount == 0)
+                return;
+            BlendState state;
             {
-            case BlendFactor::ZERO:
-                result = Float(0);
-                break;
-            case BlendFactor::ONE:
-                result = Float(1);
-                break;
-            case BlendFactor::BLEND_FACTOR:
-                result = factor;
-                break;
-            case BlendFactor::INV_BLEND_FACTOR:
-                result = Float(1) - factor;
-                break;
-            case BlendFactor::SRC_ALPHA_SAT:
-                result = clamp(src, Float(0), Float(1));
-                break;
-            case BlendFactor::SRC_ALPHA:
-                result = src;
-                break;
-            case BlendFactor::INV_SRC_ALPHA:
-                result = 1 - src;
-                break;
-            case BlendFactor::DEST_ALPHA:
-                result = dst;
-                break;
-            case BlendFactor::INV_DEST_ALPHA:
-                result = 1 - dst;
-                break;
-            case BlendFactor::SRC_COLOR:
-            case BlendFactor::INV_SRC_COLOR:
-            case BlendFactor::DEST_COLOR:
-            case BlendFactor::INV_DEST_COLOR:
-                assert(false && "alphaֵΪcolor");
-                break;
-            case BlendFactor::SRC1_COLOR:
-            case BlendFactor::INV_SRC1_COLOR:
-            case BlendFactor::SRC1_ALPHA:
-            case BlendFactor::INV_SRC1_ALPHA:
-                assert(false && "δʵ");
-                break;
-            default:
-                break;
+                state.srcBlend      = uint32_t(m_blend->srcBlend);
+                state.dstBlend      = uint32_t(m_blend->dstBlend);
+                state.blendOp       = uint32_t(m_blend->blendOp);
+                state.srcBlendAlpha = uint32_t(m_blend->srcBlendAlpha);
+                state.dstBlendAlpha = uint32_t(m_blend->dstBlendAlpha);
+                state.blendOpAlpha  = uint32_t(m_blend->blendOpAlpha);
+                std::copy(std::begin(m_context->om.blendFactor), std::end(m_context->om.blendFactor), state.factor);
             }
-            return result;
+            static_assert(sizeof(Vec4) == 4 * sizeof(Float), "Vec4Ϊrgba!");
+            kernels().blend(state, &m_blendSources[0].x, m_blendTargets, m_blendCount, m_context->om.colorFloatCount);
+            m_blendCount = 0;
         }
-        void _initTriangleEquation(const VSOutput& vs0, const VSOutput& vs1, const VSOutput& vs2,TriangleEquation& eqnOut)
+        // attributes = falseʱ(depth-only)ֻedgedepth
+        void _initTriangleEquation(const VSOutput& vs0, const VSOutput& vs1, const VSOutput& vs2,TriangleEquation& eqnOut, bool attributes = true)
         {
             const Vec2 v0(vs0.position), v1(vs1.position), v2(vs2.position);
             // 
@@ -1248,15 +1568,28 @@ namespace rl
             if(eqnOut.isDegenerate())
                 return;
             // Edge Eqn
+            // (ûбcull)ıȡ, ʹڲedgeֵΪ
+            if(eqnOut.m_area < 0)
             {
                 eqnOut.m_e01 = EdgeEquation(v0, v1);
                 eqnOut.m_e12 = EdgeEquation(v1, v2);
                 eqnOut.m_e20 = EdgeEquation(v2, v0);
             }
+            else
+            {
+                eqnOut.m_e01 = EdgeEquation(v1, v0);
+                eqnOut.m_e12 = EdgeEquation(v2, v1);
+                eqnOut.m_e20 = EdgeEquation(v0, v2);
+            }
             // Eqn
+            if(attributes)
             {
                 for(uint32_t i = 0; i < lengthof<PSRegisters>(); ++i)
+                {
                     eqnOut.m_attributeEqns[i] = PlaneEquation(v0,v1,v2,vs0.registers[i],vs1.registers[i],vs2.registers[i]);
+                    eqnOut.m_attributesDx[i]  = eqnOut.m_attributeEqns[i].m_a;
+                    eqnOut.m_attributesDy[i]  = eqnOut.m_attributeEqns[i].m_b;
+                }
             }
             // Depth Eqn
             {
@@ -1265,12 +1598,123 @@ namespace rl
         }
     private:
         std::unique_ptr<Clipper> m_clipper;
+        LockedRect m_colorLocked;
+        LockedRect m_depthLocked;
+        uint32_t   m_drawID = VisibilityBuffer::INVALID_ID; // visibility bufferģʽµǰdrawID
+        Vec2       m_sampleOffsets[MAX_SAMPLE_COUNT];       // multisampledʱsamplepixelĵλ
+        // ȴblendpixel: PixelShaderrender targetеĵַ
+        static constexpr uint32_t BLEND_QUEUE_SIZE = 16;
+        Vec4         m_blendSources[BLEND_QUEUE_SIZE];
+        Float*       m_blendTargets[BLEND_QUEUE_SIZE];
+        uint32_t     m_blendCount = 0;
+        const Blend* m_blend      = nullptr;
     };
-
+    namespace detail
+    {
+        void mergePixels(Rasterizer& rasterizer, const Vec2i coords[PS_BATCH_SIZE], const PixelShader::SystemValue svs[PS_BATCH_SIZE], uint32_t passed, uint32_t count)
+        {
+            rasterizer.outputMerge(coords, svs, passed, count);
+        }
+    }//ns detail
 }//ns rl
 //Pipeline
 namespace rl
 {
+    namespace detail
+    {
+        // Primitive Assembly
+        enum class AssemblyType: uint8_t
+        {
+            LIST,  // ÿprimitiveʹµvertex
+            STRIP, // ÿvertexǰvertexµprimitive, triangleǰvertexԱ
+            FAN,   // һvertexprimitive
+        };
+        struct TopologyInfo
+        {
+            uint32_t     vertexCount; // ÿprimitivevertex
+            AssemblyType type;
+        };
+        // PrimitiveTopology˳
+        static const TopologyInfo TOPOLOGY_INFOS[] =
+        {
+            { 2, AssemblyType::LIST  }, // LINE_LIST
+            { 2, AssemblyType::STRIP }, // LINE_STRIP
+            { 3, AssemblyType::LIST  }, // TRIANGLE_LIST
+            { 3, AssemblyType::STRIP }, // TRIANGLE_STRIP
+            { 3, AssemblyType::FAN   }, // TRIANGLE_FAN
+        };
+        // countindexװΪprimitive, ÿprimitiveһschedule(indices, vertexCount)
+        // restartEnabledʱ, indexrestartIndexǰstrip/fan(listδɵprimitive)
+        template<typename GetIndex, typename Schedule>
+        void assemblePrimitives(PrimitiveTopology topology, uint32_t count, GetIndex getIndex, bool restartEnabled, uint32_t restartIndex,
+                                Schedule schedule, int32_t baseVertexIndex = 0)
+        {
+            assert(uint32_t(topology) < lengthof(TOPOLOGY_INFOS));
+            const auto& info = TOPOLOGY_INFOS[uint32_t(topology)];
+            const auto  n    = info.vertexCount;
+            uint32_t window[3];         // ǰprimitivevertex
+            uint32_t windowCount    = 0;
+            uint32_t primitiveCount = 0; // ǰstripеprimitive
+            for(uint32_t i = 0; i < count; ++i)
+            {
+                const auto index = getIndex(i);
+                if(restartEnabled && index == restartIndex)
+                {
+                    windowCount = primitiveCount = 0;
+                    continue;
+                }
+                const auto vertexi = uint32_t(baseVertexIndex + int32_t(index));
+                if(windowCount < n)
+                    window[windowCount++] = vertexi;
+                else if(info.type == AssemblyType::STRIP)
+                {
+                    for(uint32_t k = 0; k + 1 < n; ++k)
+                        window[k] = window[k + 1];
+                    window[n - 1] = vertexi;
+                }
+                else
+                {// FAN: window[0]ֲ
+                    window[1] = window[2];
+                    window[2] = vertexi;
+                }
+                if(windowCount < n)
+                    continue;
+                if(info.type == AssemblyType::STRIP && n == 3 && (primitiveCount & 1))
+                {
+                    const uint32_t flipped[3] = { window[0], window[2], window[1] };
+                    schedule(flipped, n);
+                }
+                else
+                    schedule(window, n);
+                ++primitiveCount;
+                if(info.type == AssemblyType::LIST)
+                    windowCount = 0;
+            }
+        }
+        // װgetIndex: i(VS_BATCH_SIZEı)indexʱ, Ȱ[i, i + VS_BATCH_SIZE)еvertexVertexer::prefetch,
+        // ʹVertexShaderִ; ֮cache滻vertexfetchִ
+        template<typename GetIndex>
+        auto prefetchIndices(Vertexer* vertexer, uint32_t count, GetIndex getIndex, bool restartEnabled, uint32_t restartIndex,
+                             int32_t baseVertexIndex = 0)
+        {
+            return [=](uint32_t i)
+            {
+                if(i % VS_BATCH_SIZE == 0)
+                {
+                    uint32_t vertices[VS_BATCH_SIZE];
+                    uint32_t vertexCount = 0;
+                    for(uint32_t k = i; k < count && k < i + VS_BATCH_SIZE; ++k)
+                    {
+                        const auto index = getIndex(k);
+                        if(!(restartEnabled && index == restartIndex))
+                            vertices[vertexCount++] = uint32_t(baseVertexIndex + int32_t(index));
+                    }
+                    vertexer->prefetch(vertices, vertexCount);
+                }
+                return getIndex(i);
+            };
+        }
+    }//ns detail
     Pipeline::Pipeline()
     {
         m_rasterizer = new Rasterizer();
@@ -1284,92 +1728,137 @@ namespace rl
 	///////////////////////////////////////////////////////////////////////////
 	void Pipeline::draw(const Context& ctx, uint32_t vertexCount, uint32_t vertexStart)
 	{
-        m_rasterizer->setContext(&ctx);
-        m_vertexer->setContext(&ctx);
-        switch(ctx.ia.topology)
+        this->_beginDraw(ctx);
+        this->_drawPrimitives(ctx, vertexCount, vertexStart);
+        this->_endDraw(ctx);
+    }
+    void Pipeline::drawInstanced(const Context& ctx, uint32_t vertexCountPerInstance, uint32_t instanceCount, uint32_t vertexStart, uint32_t instanceStart)
+    {
+        this->_beginDraw(ctx);
+        for(uint32_t instancei = 0; instancei < instanceCount; ++instancei)
         {
-        case PrimitiveTopology::TRIANGLE_LIST:
-            {
-                uint32_t indices[3] = { vertexStart, vertexStart + 1, vertexStart + 2 };
-                auto triCount = vertexCount / 3;
-                while(triCount--)
-                {
-                    auto entry0 = m_vertexer->fetch(indices[0]);
-                    auto entry1 = m_vertexer->fetch(indices[1]);
-                    auto entry2 = m_vertexer->fetch(indices[2]);
-                    m_rasterizer->scheduleTriangle(entry0->vertex, entry1->vertex, entry2->vertex);
-                    indices[0] += 3; indices[1] += 3; indices[2] += 3;
-                }
-            }
-        case PrimitiveTopology::TRIANGLE_STRIP:
-            {//0,1,2,3,4,5.. ==>(0,1,2),(1,3,2); (2,3,4), (2,5,4); ....
-                assert(vertexCount >= 3);
-                uint32_t indices[3] ={ vertexStart, vertexStart + 1, vertexStart + 2 };
-                auto triCount = vertexCount - 2;
-                auto flip = true;
-                while(triCount--)
-                {
-                    auto entry0 = m_vertexer->fetch(indices[0]);
-                    auto entry1 = m_vertexer->fetch(indices[1]);
-                    auto entry2 = m_vertexer->fetch(indices[2]);
-                    m_rasterizer->scheduleTriangle(entry0->vertex, entry1->vertex, entry2->vertex);
-                    if(flip)
-                        indices[0] = indices[1], indices[1] = indices[2] + 1;
-                    else
-                        indices[0] = indices[2], indices[1] = indices[0] + 1, indices[2] = indices[0] + 2;
-                    flip = !flip;
-                }
-            }
-            break;
-        case PrimitiveTopology::TRIANGLE_FAN:
-            {//0,1,2,3,4,5.. ==>(0,1,2),(0,2,3), (0,3,4),(0,4,5) ....
-
-            }
-            break;
-        case PrimitiveTopology::LINE_LIST:
-            {
-                uint32_t indices[2] = { vertexStart, vertexStart + 1};
-                auto lineCount = vertexCount / 2;
-                while(lineCount--)
-                {
-                    auto entry0 = m_vertexer->fetch(indices[0]);
-                    auto entry1 = m_vertexer->fetch(indices[1]);
-                    m_rasterizer->scheduleLine(entry0->vertex, entry1->vertex);
-                    indices[0] += 2; indices[1] += 2;
-                }
-            }
-            break;
-        case PrimitiveTopology::LINE_STRIP:
-            break;
+            m_vertexer->setInstance(instancei, instanceStart);
+            this->_drawPrimitives(ctx, vertexCountPerInstance, vertexStart);
         }
-        m_rasterizer->setContext(nullptr);
+        this->_endDraw(ctx);
+    }
+    void Pipeline::_beginDraw(const Context& ctx)
+    {
+        assert((ctx.vs || ctx.ia.streamOutput) && "VertexShader!");
+        assert((!ctx.ia.streamOutput || ctx.ia.streamOutput != ctx.so.buffer) && "stream outputͬʱд!");
+        m_rasterizerDiscard = ctx.so.rasterizerDiscard;
+        if(!ctx.ia.streamOutput)
+        {
+            ctx.vs->snapshotConstants();
+            ctx.vs->preamble();
+        }
+        if(ctx.ps && !m_rasterizerDiscard)
+        {
+            ctx.ps->snapshotConstants();
+            ctx.ps->preamble();
+        }
+        if(!m_rasterizerDiscard)
+        {
+            m_rasterizer->setContext(&ctx);
+            m_rasterizer->setTypedStages(m_typedStages);
+        }
+        m_vertexer->setContext(&ctx);
+        m_vertexer->setTypedStages(m_typedStages);
+    }
+    void Pipeline::_endDraw(const Context& ctx)
+    {
+        if(!m_rasterizerDiscard)
+            m_rasterizer->setContext(nullptr);
         m_vertexer->setContext(nullptr);
+        // drawִͬе, snapshotѾ; ͷźConstantBufferһupdateٸ
+        if(!ctx.ia.streamOutput)
+            ctx.vs->releaseConstants();
+        if(ctx.ps && !m_rasterizerDiscard)
+            ctx.ps->releaseConstants();
+    }
+    void Pipeline::_drawPrimitives(const Context& ctx, uint32_t vertexCount, uint32_t vertexStart)
+    {
+        auto getIndex = detail::prefetchIndices(m_vertexer, vertexCount, [vertexStart](uint32_t i) { return vertexStart + i; }, false, 0);
+        detail::assemblePrimitives(ctx.ia.topology, vertexCount, getIndex, false, 0,
+                                   [this](const uint32_t* indices, uint32_t n) { this->_schedulePrimitive(indices, n); });
+    }
+    void Pipeline::resolve(const VisibilityBuffer& vbuffer, Surface* renderTarget)
+    {
+        // resolveѸdraw״ָ̬PixelShader, ԭΪʱ״̬
+        std::vector<std::pair<PixelShader*, std::unique_ptr<Shader::State>>> callerStates;
+        for(uint32_t drawID = 0; drawID < vbuffer.getDrawCount(); ++drawID)
+        {
+            auto ps = vbuffer.getPixelShader(drawID);
+            auto it = std::find_if(callerStates.begin(), callerStates.end(),
+                                   [ps](const std::pair<PixelShader*, std::unique_ptr<Shader::State>>& s) { return s.first == ps; });
+            if(it != callerStates.end())
+                continue;
+            callerStates.emplace_back(ps, std::make_unique<Shader::State>());
+            ps->saveState(*callerStates.back().second);
+        }
+        m_rasterizer->resolveVisibility(vbuffer, renderTarget);
+        for(auto& s : callerStates)
+            s.first->restoreState(*s.second);
     }
     void Pipeline::drawIndexed(const Context& ctx, uint32_t indexCount, uint32_t indexStart, int32_t baseVertexIndex)
     {
-        m_rasterizer->setContext(&ctx);
-        m_vertexer->setContext(&ctx);
+        this->_beginDraw(ctx);
+        this->_drawIndexedPrimitives(ctx, indexCount, indexStart, baseVertexIndex);
+        this->_endDraw(ctx);
+    }
+    void Pipeline::drawIndexedInstanced(const Context& ctx, uint32_t indexCountPerInstance, uint32_t instanceCount, uint32_t indexStart, int32_t baseVertexIndex, uint32_t instanceStart)
+    {
+        this->_beginDraw(ctx);
+        for(uint32_t instancei = 0; instancei < instanceCount; ++instancei)
+        {
+            m_vertexer->setInstance(instancei, instanceStart);
+            this->_drawIndexedPrimitives(ctx, indexCountPerInstance, indexStart, baseVertexIndex);
+        }
+        this->_endDraw(ctx);
+    }
+    void Pipeline::_drawIndexedPrimitives(const Context& ctx, uint32_t indexCount, uint32_t indexStart, int32_t baseVertexIndex)
+    {
         auto ibuffer = ctx.ia.ibuffer;
         assert(ibuffer);
-        switch(ctx.ia.topology)
+        auto schedule = [this](const uint32_t* indices, uint32_t n) { this->_schedulePrimitive(indices, n); };
+        // ֱӶȡindex, indexжϸʽ
+        if(ibuffer->getFormat() == Format::INDEX16)
         {
-        case PrimitiveTopology::TRIANGLE_LIST:
-            {
-                uint32_t indices[3] = { indexStart + 0, indexStart + 1,indexStart + 2 };
-                auto triCount = indexCount / 3;
-                while(triCount--)
-                {
-                    auto entry0 = m_vertexer->fetch(baseVertexIndex + ibuffer->getVertexIndex(indices[0]));
-                    auto entry1 = m_vertexer->fetch(baseVertexIndex + ibuffer->getVertexIndex(indices[1]));
-                    auto entry2 = m_vertexer->fetch(baseVertexIndex + ibuffer->getVertexIndex(indices[2]));
-                    m_rasterizer->scheduleTriangle(entry0->vertex, entry1->vertex, entry2->vertex);
-
-                    indices[0] += 3; indices[1] += 3; indices[2] += 3;
-                }
-            }
-            break;
+            assert(indexStart + indexCount <= (ibuffer->getLength() >> 1));
+            auto data = ibuffer->getData<uint16_t>(indexStart);
+            auto getIndex = detail::prefetchIndices(m_vertexer, indexCount, [data](uint32_t i) { return uint32_t(data[i]); },
+                                                    ctx.ia.primitiveRestartEnabled, 0xFFFF, baseVertexIndex);
+            detail::assemblePrimitives(ctx.ia.topology, indexCount, getIndex, ctx.ia.primitiveRestartEnabled, 0xFFFF, schedule, baseVertexIndex);
+        }
+        else
+        {
+            assert(indexStart + indexCount <= (ibuffer->getLength() >> 2));
+            auto data = ibuffer->getData<uint32_t>(indexStart);
+            auto getIndex = detail::prefetchIndices(m_vertexer, indexCount, [data](uint32_t i) { return data[i]; },
+                                                    ctx.ia.primitiveRestartEnabled, 0xFFFFFFFF, baseVertexIndex);
+            detail::assemblePrimitives(ctx.ia.topology, indexCount, getIndex, ctx.ia.primitiveRestartEnabled, 0xFFFFFFFF, schedule, baseVertexIndex);
+        }
+    }
+    void Pipeline::_schedulePrimitive(const uint32_t* indices, uint32_t vertexCount)
+    {
+        if(m_rasterizerDiscard)
+        {//ֻҪvsдstream output
+            for(uint32_t i = 0; i < vertexCount; ++i)
+                m_vertexer->fetch(indices[i]);
+            return;
+        }
+        if(vertexCount == 3)
+        {
+            auto entry0 = m_vertexer->fetch(indices[0]);
+            auto entry1 = m_vertexer->fetch(indices[1]);
+            auto entry2 = m_vertexer->fetch(indices[2]);
+            m_rasterizer->scheduleTriangle(entry0->vertex, entry1->vertex, entry2->vertex);
+        }
+        else
+        {
+            auto entry0 = m_vertexer->fetch(indices[0]);
+            auto entry1 = m_vertexer->fetch(indices[1]);
+            m_rasterizer->scheduleLine(entry0->vertex, entry1->vertex);
         }
-        m_rasterizer->setContext(nullptr);
-        m_vertexer->setContext(nullptr);
     }
 }
\ No newline at end of file
@@ -1,6 +1,9 @@
 #ifndef RASLITE_PIPELINE_H
 #define RASLITE_PIPELINE_H
 #include "RasliteShader.h"
+#include "RasliteRaster.h"
+#include <vector>
+#include <type_traits>
 namespace rl 
 {
     /////////////////////////////////////////////////////////////////
@@ -20,9 +23,22 @@ namespace rl
 		uint8_t      streami;
 		Format format;
 		uint8_t      registeri;
+		// 0: vertexȡ; n: instanceȡ, ÿninstanceǰһԪ. ͬһstreamelementһ
+		uint32_t     instanceStepRate = 0;
 	};
+	// ʱelementбΪFetchOp: ÿelementĶȡvertexеƫƶԤȷ, fetchʱжϸʽ
+	// element˳, ƫ϶뵽4ֽ: {R8_UNORM, R32G32_FLOAT}кߵƫΪ4
 	class InputLayout
 	{
+	public:
+        struct FetchOp
+        {
+            using Func = void(*)(const uint8_t* src, ShaderRegister& dst);
+            Func     func;
+            uint32_t offset;    // streamһԪеֽƫ
+            uint8_t  streami;
+            uint8_t  registeri;
+        };
 	public:
 		InputLayout(const InputElement* elements, uint32_t count);
 	   ~InputLayout();
@@ -32,14 +48,108 @@ namespace rl
 
 		const InputElement* getElements() const;
 		const InputElement& getElement(uint32_t idx) const;
+        // streaminstanceStepRate, 0Ϊvertexstream
+        uint32_t getStreamStepRate(uint32_t streami) const;
+        bool     hasInstanceStreams() const;
+        // vertexȡstream
+        uint32_t       getVertexStreamCount() const;
+        const uint8_t* getVertexStreams() const;
+        // dataptrs: streamǰԪصʼַ
+        void fetchVertex  (const uint8_t* const dataptrs[VERTEX_STREAM_COUNT], VSRegisters& registers) const;
+        void fetchInstance(const uint8_t* const dataptrs[VERTEX_STREAM_COUNT], VSRegisters& registers) const;
+        // instanceregistersrcƵdst
+        void copyInstanceRegisters(const VSRegisters& src, VSRegisters& dst) const;
 
         const VSRegisterTypes& getRegisterTypes() const;
 	private:
 		std::unique_ptr<InputElement[]> m_elements;
 		uint32_t m_nElement = 0;
 		uint32_t m_highestStreamIndex = 0;
+        uint32_t m_streamStepRates[VERTEX_STREAM_COUNT] = {};
+        bool     m_hasInstanceStreams = false;
+        uint8_t  m_vertexStreams[VERTEX_STREAM_COUNT];
+        uint32_t m_nVertexStream = 0;
+        // vertexopǰ, instanceopں
+        std::unique_ptr<FetchOp[]> m_fetchOps;
+        uint32_t m_nVertexFetchOp = 0;
         VSRegisterTypes m_registerTypes;
 	};
+	/////////////////////////////////////////////////////////////////
+	//VisibilityBuffer
+	/////////////////////////////////////////////////////////////////
+    // դʱÿpixelֻд(drawID, primitiveID), Pipeline::resolveÿɼpixelֻɫһ
+    // ɫʱɼ¼ؽԷ; PixelShader(discard)pixel, ֻʺϲ͸
+    class VisibilityBuffer
+    {
+    public:
+        static constexpr uint32_t INVALID_ID = 0xFFFFFFFF;
+        struct Sample
+        {
+            uint32_t drawID      = INVALID_ID; // clearڼdraw
+            uint32_t primitiveID = INVALID_ID; // drawڵڼդ(ü֮)
+        };
+        // Raster space: position.wΪ1/linear_z, registersѳ˹1/linear_z
+        struct Triangle
+        {
+            Vec4        positions[3];
+            PSRegisters registers[3];
+        };
+    public:
+        VisibilityBuffer(uint32_t width, uint32_t height);
+        // еsample, draw; ÿ֡ʼʱ
+        void clear();
+
+        // Rasterizer: ʼһdraw, drawID; psresolveʱʹ
+        // ͬʱpsǰ״̬(uniform, Դ, ConstantBuffersnapshot), resolveʱdrawָ
+        uint32_t beginDraw(PixelShader* ps);
+        // ¼ǰdrawһ, primitiveID
+        uint32_t addTriangle(const Triangle& tri);
+
+        Sample&         getSample(uint32_t x, uint32_t y);
+        const Sample&   getSample(uint32_t x, uint32_t y) const;
+        const Triangle& getTriangle(const Sample& sample) const;
+        PixelShader*    getPixelShader(uint32_t drawID)   const;
+        const Shader::State& getShaderState(uint32_t drawID) const;
+        uint32_t        getDrawCount() const;
+        uint32_t        getWidth()     const;
+        uint32_t        getHeight()    const;
+    private:
+        struct Draw
+        {
+            PixelShader* ps;
+            uint32_t     firstTriangle; // m_trianglesеʼλ
+            std::unique_ptr<Shader::State> state;
+        };
+        uint32_t m_width;
+        uint32_t m_height;
+        std::unique_ptr<Sample[]> m_samples;
+        std::vector<Draw>         m_draws;
+        std::vector<Triangle>     m_triangles;
+    };
+    /////////////////////////////////////////////////////////////////
+    // vertex indexVertexShader(clip space position + registers)
+    // Context::so.bufferǿʱdrawд; Context::ia.streamOutputǿʱdrawֱӶȡ, ִIAVertexShader
+    class StreamOutputBuffer
+    {
+    public:
+        struct Vertex
+        {
+            Vec4        position;
+            PSRegisters registers;
+        };
+    public:
+        explicit StreamOutputBuffer(uint32_t capacity);
+        // vertexΪδд
+        void clear();
+        void write(uint32_t vertexi, const Vec4& position, const PSRegisters& registers);
+
+        const Vertex& getVertex(uint32_t vertexi) const;
+        bool          isWritten(uint32_t vertexi) const;
+        uint32_t      getCapacity() const;
+    private:
+        std::vector<Vertex> m_vertices;
+        std::vector<bool>   m_written;
+    };
 	/////////////////////////////////////////////////////////////////
 	//Context
 	/////////////////////////////////////////////////////////////////
@@ -60,7 +170,17 @@ namespace rl
 			const IndexBuffer* ibuffer = nullptr;
 			VertexStream       vstreams[VERTEX_STREAM_COUNT];
 			PrimitiveTopology  topology = PrimitiveTopology::TRIANGLE_LIST;
+			// indexed draw, 0xFFFF(INDEX16)/0xFFFFFFFF(INDEX32)ʾʼµstrip/fan
+			bool               primitiveRestartEnabled = false;
 			const InputLayout* layout = nullptr;
+			// nullptr: vertexֱӴstream outputȡ(ѱ任), layout/vstreams, ִvs
+			const StreamOutputBuffer* streamOutput = nullptr;
+		};
+		// Stream Output Stage
+		struct SO
+		{
+			StreamOutputBuffer* buffer = nullptr; // nullptr: vertex index¼vs, ֮passظʹ
+			bool rasterizerDiscard     = false;   // true: ִֻеstream output, դ(Ҫrender target/depthStencil)
 		};
 		// Output Merger Stage
 		struct OM
@@ -69,6 +189,8 @@ namespace rl
             uint8_t  renderTargetCount = 0;
             Surface* renderTargets[SIMULTANEOUS_RENDER_TARGET_COUNT] = { nullptr };
             Surface* depthStencil =  nullptr;
+            // nullptrʱΪvisibility bufferģʽ: ִPixelShader, дrender target; ߶WIRE_FRAMEβ
+            VisibilityBuffer* visibilityBuffer = nullptr;
 			//BlendFactor State
             bool     alphaToCoverageEnabled = false;
             bool     independentBlendEnabled= false; //false: еRTblends[0]; true: RTiʹӦblends[i]
@@ -95,6 +217,7 @@ namespace rl
             Float*   depthData = nullptr;
             uint32_t depthBufferPitch;
             uint32_t depthFloatCount;
+            uint32_t sampleCount = 1; // depthStencilrender targetsample
 
             Mat4     viewportTransform = Mat4::IDENTITY;
 		};
@@ -116,15 +239,23 @@ namespace rl
             Float slopeScaledDepthBias  = 0.0f;
             bool depthClipEnabled       = true;
             bool scissorEnabled         = false;
-            bool multisampleEnabled     = false;
+            bool multisampleEnabled     = false; // multisampledSurfacesampleԸ; ֻpixel
             bool antialiasedLineEnabled = false;
+            // coarse pixel shading: PixelShaderblockִһ, дblockڱǵpixel; Ⱥ͸pixel
+            ShadingRate shadingRate = ShadingRate::_1X1;
+            // ѡ: tileָshading rate(shadingRate), (y / tileSize) * tileCols + x / tileSize
+            // tileSizeΪ4ı, ʹblocktile
+            const ShadingRate* shadingRateTiles    = nullptr;
+            uint32_t           shadingRateTileSize = 16;
+            uint32_t           shadingRateTileCols = 0;
 		};
 		IA  ia;
+		SO  so;
 		RS  rs;
 		OM  om;
 
-		VertexShader* vs = nullptr;
-		PixelShader*  ps = nullptr;
+		VertexShader* vs = nullptr; // ia.streamOutputǿʱΪnullptr
+		PixelShader*  ps = nullptr; // nullptr: depth-only(shadow map, Z-prepass), ʱrender target
 		//todo: GS HS DS CS
 	};
 	/////////////////////////////////////////////////////////////////
@@ -133,6 +264,64 @@ namespace rl
 	class Rasterizer;
 	class OutputMerger;
 	class Vertexer;
+    namespace detail
+    {
+        // shaderʵvertex shadingʵιդ, Pipeline::draw<VS, PS>VertexerRasterizer
+        // ÿvertex/ÿһ麯, жexecuteĵǷ
+        class TypedStages
+        {
+        public:
+            virtual void executeVertices(VertexShader& vs, const VSRegisters* const inputs[VS_BATCH_SIZE], PSRegisters* const outputs[VS_BATCH_SIZE],
+                                         VertexShader::SystemValue sv[VS_BATCH_SIZE], uint32_t mask) const = 0;
+            virtual void rasterizeSolid(Rasterizer& rasterizer, PixelShader& ps, const TriangleEquation& triEqn, const Vec2i points[3]) const = 0;
+        };
+        // Rasterizeroutput merger: ͨPixelShaderpixel(passedĵiλӦcoords[i])Ȳ, blendдrender target
+        void mergePixels(Rasterizer& rasterizer, const Vec2i coords[PS_BATCH_SIZE], const PixelShader::SystemValue svs[PS_BATCH_SIZE], uint32_t passed, uint32_t count);
+        template <typename VS, typename PS>
+        class TypedStagesT: public TypedStages
+        {
+        public:
+            void executeVertices(VertexShader& vs, const VSRegisters* const inputs[VS_BATCH_SIZE], PSRegisters* const outputs[VS_BATCH_SIZE],
+                                 VertexShader::SystemValue sv[VS_BATCH_SIZE], uint32_t mask) const override
+            {
+                auto& self = static_cast<VS&>(vs);
+                // VSexecuteBatch(Vec4xN)ʱֱӵ, VS::execute
+                if constexpr(std::is_same<decltype(&VS::executeBatch), decltype(&VertexShader::executeBatch)>::value)
+                {
+                    for(uint32_t i = 0; i < VS_BATCH_SIZE; ++i)
+                    {
+                        if(mask & (1u << i))
+                            self.VS::execute(*inputs[i], *outputs[i], sv[i]);
+                    }
+                }
+                else
+                    self.VS::executeBatch(inputs, outputs, sv, mask);
+            }
+            void rasterizeSolid(Rasterizer& rasterizer, PixelShader& ps, const TriangleEquation& triEqn, const Vec2i points[3]) const override
+            {
+                auto& self = static_cast<PS&>(ps);
+                detail::rasterizeSolid(triEqn, points,
+                                       [&self](const PSRegisters* const varyings[PS_BATCH_SIZE], PixelShader::SystemValue svs[PS_BATCH_SIZE], uint32_t mask)
+                                       {
+                                           // ͬexecuteVertices: PS(PixelShaderT)executeBatchʱֱӵ
+                                           if constexpr(std::is_same<decltype(&PS::executeBatch), decltype(&PixelShader::executeBatch)>::value)
+                                           {
+                                               uint32_t passed = 0;
+                                               for(uint32_t i = 0; i < PS_BATCH_SIZE; ++i)
+                                               {
+                                                   if((mask & (1u << i)) && self.PS::execute(*varyings[i], svs[i]))
+                                                       passed |= 1u << i;
+                                               }
+                                               return passed;
+                                           }
+                                           else
+                                               return self.PS::executeBatch(varyings, svs, mask);
+                                       },
+                                       [&rasterizer](const Vec2i coords[PS_BATCH_SIZE], const PixelShader::SystemValue svs[PS_BATCH_SIZE], uint32_t passed, uint32_t count)
+                                       { mergePixels(rasterizer, coords, svs, passed, count); });
+            }
+        };
+    }//ns detail
 	class Pipeline
 	{
 	public:
@@ -140,10 +329,31 @@ namespace rl
         ~Pipeline();
 		void draw(const Context& ctx,uint32_t vertexCount,uint32_t vertexStart);
         void drawIndexed(const Context& ctx, uint32_t indexCount, uint32_t indexStart, int32_t baseVertexIndex);
+        // ͬdraw/drawIndexed, ctx.vsctx.psΪVSPS(), VS::executePS::executeҪΪpublic
+        // sample, 1x1 shading rateʵκvertex shadingshaderʵ, executeԱ;
+        // ·(MSAA, coarse shading, visibility buffer)drawͬ
+        template <typename VS, typename PS>
+        void draw(const Context& ctx, uint32_t vertexCount, uint32_t vertexStart);
+        template <typename VS, typename PS>
+        void drawIndexed(const Context& ctx, uint32_t indexCount, uint32_t indexStart, int32_t baseVertexIndex);
+        // ͬһvertexinstanceCount, instancestreaminstanceStartʼȡ; drawֻһ
+        void drawInstanced(const Context& ctx, uint32_t vertexCountPerInstance, uint32_t instanceCount, uint32_t vertexStart, uint32_t instanceStart);
+        void drawIndexedInstanced(const Context& ctx, uint32_t indexCountPerInstance, uint32_t instanceCount, uint32_t indexStart, int32_t baseVertexIndex, uint32_t instanceStart);
+        // visibility bufferÿɼpixelִһdrawPixelShader, дrenderTarget
+        void resolve(const VisibilityBuffer& vbuffer, Surface* renderTarget);
         
+	private:
+        // shaderpreamble, østagecontext; һdraw(instance)ֻһ
+        void _beginDraw(const Context& ctx);
+        void _endDraw(const Context& ctx);
+        void _drawPrimitives(const Context& ctx, uint32_t vertexCount, uint32_t vertexStart);
+        void _drawIndexedPrimitives(const Context& ctx, uint32_t indexCount, uint32_t indexStart, int32_t baseVertexIndex);
+        void _schedulePrimitive(const uint32_t* indices, uint32_t vertexCount);
 	private:
         Rasterizer* m_rasterizer;
         Vertexer*   m_vertexer;
+        bool        m_rasterizerDiscard = false;
+        const detail::TypedStages* m_typedStages = nullptr; // ֻdraw<VS, PS>ڼǿ
 	};
 }//ns rl
 ///////////////////////////////////////////////////////////////////
@@ -170,10 +380,97 @@ namespace rl
 		assert(idx < m_nElement);
 		return m_elements[idx];
 	}
+    inline uint32_t InputLayout::getStreamStepRate(uint32_t streami) const
+    {
+        assert(streami < VERTEX_STREAM_COUNT);
+        return m_streamStepRates[streami];
+    }
+    inline bool InputLayout::hasInstanceStreams() const
+    {
+        return m_hasInstanceStreams;
+    }
+    inline uint32_t InputLayout::getVertexStreamCount() const
+    {
+        return m_nVertexStream;
+    }
+    inline const uint8_t* InputLayout::getVertexStreams() const
+    {
+        return m_vertexStreams;
+    }
     inline const VSRegisterTypes& InputLayout::getRegisterTypes() const
     {
         return m_registerTypes;
     }
+    inline VisibilityBuffer::Sample& VisibilityBuffer::getSample(uint32_t x, uint32_t y)
+    {
+        assert(x < m_width && y < m_height);
+        return m_samples[y * m_width + x];
+    }
+    inline const VisibilityBuffer::Sample& VisibilityBuffer::getSample(uint32_t x, uint32_t y) const
+    {
+        assert(x < m_width && y < m_height);
+        return m_samples[y * m_width + x];
+    }
+    inline const VisibilityBuffer::Triangle& VisibilityBuffer::getTriangle(const Sample& sample) const
+    {
+        assert(sample.drawID < m_draws.size());
+        return m_triangles[m_draws[sample.drawID].firstTriangle + sample.primitiveID];
+    }
+    inline PixelShader* VisibilityBuffer::getPixelShader(uint32_t drawID) const
+    {
+        assert(drawID < m_draws.size());
+        return m_draws[drawID].ps;
+    }
+    inline const Shader::State& VisibilityBuffer::getShaderState(uint32_t drawID) const
+    {
+        assert(drawID < m_draws.size());
+        return *m_draws[drawID].state;
+    }
+    inline uint32_t VisibilityBuffer::getDrawCount() const
+    {
+        return uint32_t(m_draws.size());
+    }
+    inline uint32_t VisibilityBuffer::getWidth() const
+    {
+        return m_width;
+    }
+    inline uint32_t VisibilityBuffer::getHeight() const
+    {
+        return m_height;
+    }
+    inline const StreamOutputBuffer::Vertex& StreamOutputBuffer::getVertex(uint32_t vertexi) const
+    {
+        assert(vertexi < m_vertices.size() && m_written[vertexi] && "vertexδдstream output!");
+        return m_vertices[vertexi];
+    }
+    inline bool StreamOutputBuffer::isWritten(uint32_t vertexi) const
+    {
+        return vertexi < m_written.size() && m_written[vertexi];
+    }
+    inline uint32_t StreamOutputBuffer::getCapacity() const
+    {
+        return uint32_t(m_vertices.size());
+    }
+    template <typename VS, typename PS>
+    inline void Pipeline::draw(const Context& ctx, uint32_t vertexCount, uint32_t vertexStart)
+    {
+        static_assert(std::is_base_of<VertexShader, VS>::value && std::is_base_of<PixelShader, PS>::value, "VSPSΪVertexShaderPixelShader!");
+        assert((!ctx.vs || dynamic_cast<VS*>(ctx.vs)) && (!ctx.ps || dynamic_cast<PS*>(ctx.ps)) && "shaderͲƥ!");
+        static const detail::TypedStagesT<VS, PS> stages;
+        m_typedStages = &stages;
+        this->draw(ctx, vertexCount, vertexStart);
+        m_typedStages = nullptr;
+    }
+    template <typename VS, typename PS>
+    inline void Pipeline::drawIndexed(const Context& ctx, uint32_t indexCount, uint32_t indexStart, int32_t baseVertexIndex)
+    {
+        static_assert(std::is_base_of<VertexShader, VS>::value && std::is_base_of<PixelShader, PS>::value, "VSPSΪVertexShaderPixelShader!");
+        assert((!ctx.vs || dynamic_cast<VS*>(ctx.vs)) && (!ctx.ps || dynamic_cast<PS*>(ctx.ps)) && "shaderͲƥ!");
+        static const detail::TypedStagesT<VS, PS> stages;
+        m_typedStages = &stages;
+        this->drawIndexed(ctx, indexCount, indexStart, baseVertexIndex);
+        m_typedStages = nullptr;
+    }
 }
 
 
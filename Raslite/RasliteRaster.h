@@ -0,0 +1,269 @@
+#ifndef RASLITE_RASTER_H
+#define RASLITE_RASTER_H
+#include "RasliteShader.h"
+#include "RasliteKernels.h"
+#include <algorithm>
+#include <utility>
+/////////////////////////////////////////////////////////////////
+// εı/ԷʵεĹդѭ
+// ͷļ, ʹPipeline::draw<VS, PS>ڵôshaderʵ
+/////////////////////////////////////////////////////////////////
+namespace rl
+{
+    /*
+         E(X,Y) = aX + bY + c = 0;
+         Screen PointǷEdge
+         ϵ(ϵ)(: ʱΪ)
+          ---------------->x
+          |
+         \|/y
+    */
+     struct EdgeEquation
+     {
+     public:
+         EdgeEquation() {}
+         EdgeEquation(const Vec2& v0, const Vec2& v1)
+         {
+             /*ʽֱ߷ aX + bY + c = 0;
+                     (y-y0)/(x-x0)  = (y1-y0)/(x1-x0)  
+                  => (y-y0)*(x1-x0) = (y1-y0)*(x-x0)
+                  => (x1-x0)*y -(x1-x0)y0 = (y1-y0)*x - (y1-y0)*x0
+                  => (y1-y0)*x -(x1-x0)*y +(x1-x0)y0 -(y1-y0)*x0 = 0
+             */
+             auto tmp = v1 - v0;
+             m_a =  tmp.y;
+             m_b = -tmp.x;
+             m_c =  tmp.x*v0.y - tmp.y*v0.x;
+             //Top: ˮƽx->xС; Left: yС->y
+             m_topLeft =  v0.y < v1.y/*left*/ || (v1.y == v0.y && v0.x > v1.x)/*top*/;
+         }
+         // E(X,Y) = aX + bY + c
+		 Float evaluate(Float x, Float y) const
+		 {
+			 return m_a * x + m_b * y + m_c;
+		 }
+		 Float evaluate(int x, int y) const
+		 {
+			 return this->evaluate(x + 0.5f, y + 0.5f);
+		 }
+         // E(X + stepsz, Y) = a(X+stepsz) + bY + c = E(X,Y) + a*stepsz
+         // ĵeΪĳE(X,Y),ȡ(X+stepsz)Eֵ
+         Float deltaX(Float stepsz = 1) const
+         {
+             return m_a * stepsz;
+         }
+         // E(X, Y+stepsz) = aX + b(Y+stepsz) + c = E(X,Y) + b*stepsz
+         // ԴĵeΪĳE(X,Y),ȻȡһX(X+1)Eֵ
+         Float deltaY(Float stepsz = 1) const
+         {
+             return m_b * stepsz;
+         }
+         bool inside(Float val) const
+         {
+             return val > 0 || (val == 0 && m_topLeft);
+         }
+         bool inside(int x, int y) const
+         {
+             return this->inside(this->evaluate(x, y));
+         }
+     public:
+         Float m_a, m_b, m_c;
+         bool m_topLeft;
+     };
+     // ÿԶԼPlane Attribute Equation
+     // F = aX + bY + c;
+     struct PlaneEquation
+     {
+     public:
+         PlaneEquation() {};
+         // ֱΪv0,v1,v2;
+         // ԷֱΪa0,a1,a2;
+         PlaneEquation(const Vec2& v0,const Vec2& v1,const Vec2& v2,const Vec4& a0,const Vec4& a1,const Vec4& a2)
+         {
+             /*
+                 a0 = Ax0 + By0 + C
+                 a1 = Ax1 + By1 + C
+                 a2 = Ax2 + By2 + C
+             */
+             auto sa = (v0.x - v1.x)*(v0.y - v2.y) - (v0.x - v2.x)*(v0.y-v1.y);
+             assert(sa != 0);
+             auto va = (a0 - a1)*(v0.y - v2.y) - (a0 - a2)*(v0.y - v1.y);
+             m_a = va / sa;
+
+             auto sb = (v0.y - v1.y)*(v0.x - v2.x) - (v0.y - v2.y)*(v0.x-v1.x);
+             assert(sb != 0);
+             auto vb = (a0 - a1)*(v0.x - v2.x) - (a0 - a2)*(v0.x - v1.x);
+             m_b = vb / sb;
+
+             m_c = a0 - m_a*v0.x - m_b*v0.y;
+#ifdef _DEBUG
+             auto c1 = a1 - m_a*v1.x - m_b*v1.y;
+             auto c2 = a2 - m_a*v2.x - m_b*v2.y;
+             assert(m_c.equal(c1, 0.01f));
+             assert(m_c.equal(c2, 0.01f));
+#endif
+         }
+         // E(X + stepsz, Y) = a(X+stepsz) + bY + c = E(X,Y) + a*stepsz
+         // ĵeΪĳE(X,Y),ȡ(X+stepsz)Eֵ
+         Vec4 deltaX(Float stepsz = 1) const
+         {
+             return m_a * stepsz;
+         }
+         // E(X, Y+stepsz) = aX + b(Y+stepsz) + c = E(X,Y) + b*stepsz
+         // ԴĵeΪĳE(X,Y),ȻȡһX(X+1)Eֵ
+         Vec4 deltaY(Float stepsz = 1) const
+         {
+             return m_b * stepsz;
+         }
+         Vec4 evaluate(Float x, Float y) const
+         {
+             return m_a * x + m_b * y + m_c;
+         }
+		 Vec4 evaluate(int x, int y) const
+		 {
+			 return this->evaluate(x + 0.5f, y + 0.5f);
+		 }
+     public:
+         // F(X,Y) = aX + bY + cϵ
+         Vec4 m_a, m_b, m_c;
+     };
+     struct TriangleEquation
+     {
+         EdgeEquation m_e01, m_e12, m_e20;
+         Float m_area;
+         PlaneEquation m_attributeEqns[lengthof<PSRegisters>()];
+         // m_attributeEqnsa,bϵ, PixelShader::SystemValue::ddx/ddyʹ
+         PSRegisters m_attributesDx, m_attributesDy;
+         //(nonlinearDepth,linearDepthInv)
+         PlaneEquation m_depthEqn;
+         bool inside(int x, int y) const
+         {
+             return m_e01.inside(x, y)
+                 && m_e12.inside(x, y)
+                 && m_e20.inside(x, y);
+         }
+         bool inside(Float edgeVal0, Float edgeVal1, Float edgeVal2) const
+         {
+             return m_e01.inside(edgeVal0)
+                 && m_e12.inside(edgeVal1)
+                 && m_e20.inside(edgeVal2);
+         }
+         bool inside(const Vec3& edgeVals) const
+         {
+             return this->inside(edgeVals[0], edgeVals[1], edgeVals[2]);
+         }
+         bool isDegenerate() const
+         {
+             return std::fabs(m_area) < 0.1f;
+         }
+         // ߷̺ƽ, Kernels::coverSpan/depthSpanʹ
+         RasterSpan rasterSpan() const
+         {
+             RasterSpan span;
+             const EdgeEquation* edges[3] = { &m_e01, &m_e12, &m_e20 };
+             for(uint32_t k = 0; k < 3; ++k)
+             {
+                 span.edgeA[k]       = edges[k]->m_a;
+                 span.edgeB[k]       = edges[k]->m_b;
+                 span.edgeC[k]       = edges[k]->m_c;
+                 span.edgeTopLeft[k] = edges[k]->m_topLeft;
+             }
+             span.depthA = m_depthEqn.m_a.x;
+             span.depthB = m_depthEqn.m_b.x;
+             span.depthC = m_depthEqn.m_c.x;
+             return span;
+         }
+     };
+    namespace detail
+    {
+        // raster spaceеbounding box, ص0
+        inline std::pair<Vec2i, Vec2i> boundingBox(const Vec2i points[3])
+        {
+            auto boxMin = points[0], boxMax = points[0];
+            for(auto i = 1; i < 3; ++i)
+            {
+                auto& pt = points[i];
+                if(boxMin.x > pt.x) boxMin.x = pt.x;
+                if(boxMax.x < pt.x) boxMax.x = pt.x;
+                if(boxMin.y > pt.y) boxMin.y = pt.y;
+                if(boxMax.y < pt.y) boxMax.y = pt.y;
+            }
+            boxMin.x = std::max(boxMin.x, 0);
+            boxMin.y = std::max(boxMin.y, 0);
+            boxMax.x = std::max(boxMax.x, 0);
+            boxMax.y = std::max(boxMax.y, 0);
+            return std::make_pair(boxMin, boxMax);
+        }
+        // εbounding boxзֳ32pixelspan, ÿεfn(x, y, count)
+        template<typename Fn>
+        void forEachSpan(const Vec2i points[3], Fn fn)
+        {
+            const auto box = boundingBox(points);
+            for(int y = box.first.y; y <= box.second.y; ++y)
+            {
+                for(int x = box.first.x; x <= box.second.x; x += 32)
+                    fn(x, y, uint32_t(std::min(box.second.x - x + 1, 32)));
+            }
+        }
+        // positionֵõ(ѳ1/linear_z)дPixelShader
+        inline void setupPixel(const TriangleEquation& triEqn, const Vec2& position, Float depth, Float invLinearDepth, const PSRegisters& attributes,
+                               PSRegisters& linearAttributes, PixelShader::SystemValue& sv)
+        {
+            sv = PixelShader::SystemValue();
+            {
+                sv.depth       = depth;
+                sv.position    = {position.x, position.y, sv.depth, 1.0f };
+                sv.targetIndex = 0;
+            }
+            for(int i = 0; i < lengthof(linearAttributes); ++i)
+                linearAttributes[i] = attributes[i] / invLinearDepth;
+            {
+                sv.varyings   = &linearAttributes;
+                sv.varyingsDx = &triEqn.m_attributesDx;
+                sv.varyingsDy = &triEqn.m_attributesDy;
+                sv.invDepth   = { invLinearDepth, triEqn.m_depthEqn.m_a.y, triEqn.m_depthEqn.m_b.y };
+            }
+        }
+        // sample, 1x1 shading rateʵ: Kernels::coverSpanEdge Test, ǵpixelֱֵԺ
+        // ܹPS_BATCH_SIZEshade(varyings, svs, mask)ִPixelShaderδmask, ٵmerge(coords, svs, passed, count)
+        // Pipeline::draw<VS, PS>shaderʵ, shadeеexecuteԱ
+        template<typename Shade, typename Merge>
+        void rasterizeSolid(const TriangleEquation& triEqn, const Vec2i points[3], Shade shade, Merge merge)
+        {
+            PixelShader::SystemValue svs[PS_BATCH_SIZE];
+            PSRegisters              batchVaryings[PS_BATCH_SIZE];
+            const PSRegisters*       batchVaryingPtrs[PS_BATCH_SIZE];
+            Vec2i                    batchCoords[PS_BATCH_SIZE];
+            uint32_t                 batchCount = 0;
+            auto flush = [&]()
+            {
+                const auto passed = shade(batchVaryingPtrs, svs, (1u << batchCount) - 1);
+                merge(batchCoords, svs, passed, batchCount);
+                batchCount = 0;
+            };
+            const auto span = triEqn.rasterSpan();
+            forEachSpan(points, [&](int x0, int y, uint32_t count)
+            {
+                const auto covered = kernels().coverSpan(span, x0, y, count);
+                for(uint32_t k = 0; k < count; ++k)
+                {
+                    if(!(covered & (1u << k)))
+                        continue;
+                    const auto x = x0 + int(k);
+                    PSRegisters attributes;
+                    for(uint32_t i = 0; i < lengthof<PSRegisters>(); ++i)
+                        attributes[i] = triEqn.m_attributeEqns[i].evaluate(x, y);
+                    const auto depth = triEqn.m_depthEqn.evaluate(x, y);
+                    setupPixel(triEqn, Vec2(x + 0.5f, y + 0.5f), depth.x, depth.y, attributes, batchVaryings[batchCount], svs[batchCount]);
+                    batchVaryingPtrs[batchCount] = &batchVaryings[batchCount];
+                    batchCoords[batchCount]      = Vec2i(x, y);
+                    if(++batchCount == PS_BATCH_SIZE)
+                        flush();
+                }
+            });
+            if(batchCount > 0)
+                flush();
+        }
+    }//ns detail
+}//ns rl
+#endif //RASLITE_RASTER_H
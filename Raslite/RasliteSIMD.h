@@ -1,25 +1,32 @@
 #ifndef RASLITE_SIMD_H
 #define RASLITE_SIMD_H
+#include <cassert>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <utility>
 
 #if defined(_MSC_VER)
 #define RL_FORCE_INLINE __forceinline
 #else
 #define RL_FORCE_INLINE inline __attribute__((always_inline))
 #endif
-namespace rl {
-
-    template <size_t N>
-    inline bool IsAligned(const void* p)
-    {
-        return (reinterpret_cast<uintptr_t>(p) & (N - 1)) == uintptr_t(0);
-    }
-}
 
 //#define  RL_SIMD_REF
 
 #if !defined(RL_SIMD_REF)
 
-#if defined(__AVX__)
+#if defined(__AVX512F__)
+#define RL_SIMD_AVX512
+#define RL_SIMD_AVX2
+#endif
+
+#if defined(__AVX2__) || defined(RL_SIMD_AVX2)
+#define RL_SIMD_AVX2
+#define RL_SIMD_AVX
+#endif
+
+#if defined(__AVX__) || defined(RL_SIMD_AVX)
 #include <immintrin.h> 
 #define RL_SIMD_AVX
 #define RL_SIMD_SSE4_2  
@@ -55,8 +62,43 @@ namespace rl {
 #endif
 #endif //RL_SIMD_REF
 
-namespace rl
-{
+// ͬһлԲָͬķ뵥Ԫ(RasliteKernels.h), 
+// ָinline namespace, ʹ汾/ͷŻͻ
+#if defined(RL_SIMD_REF)
+// ʵͬᱻ뵥Ԫ/archԶ, ԰Ŀָ
+#if defined(__AVX512F__)
+#define RL_SIMD_ABI simd_ref_avx512
+#elif defined(__AVX2__)
+#define RL_SIMD_ABI simd_ref_avx2
+#elif defined(__AVX__)
+#define RL_SIMD_ABI simd_ref_avx
+#elif defined(__SSE4_1__) || defined(RL_SIMD_SSE4_1)
+#define RL_SIMD_ABI simd_ref_sse41
+#else
+#define RL_SIMD_ABI simd_ref
+#endif
+#elif defined(RL_SIMD_AVX512)
+#define RL_SIMD_ABI simd_avx512
+#elif defined(RL_SIMD_AVX2)
+#define RL_SIMD_ABI simd_avx2
+#elif defined(RL_SIMD_AVX)
+#define RL_SIMD_ABI simd_avx
+#elif defined(RL_SIMD_SSE4_1)
+#define RL_SIMD_ABI simd_sse41
+#elif defined(RL_SIMD_SSEx)
+#define RL_SIMD_ABI simd_sse2
+#else
+#define RL_SIMD_ABI simd_ref
+#endif
+#define RL_SIMD_NAMESPACE_BEGIN namespace rl { inline namespace RL_SIMD_ABI {
+#define RL_SIMD_NAMESPACE_END   } }
+
+RL_SIMD_NAMESPACE_BEGIN
+    template <size_t N>
+    inline bool IsAligned(const void* p)
+    {
+        return (reinterpret_cast<uintptr_t>(p) & (N - 1)) == uintptr_t(0);
+    }
 #if defined(RL_SIMD_SSEx)
     using SIMDFloat4_t = __m128;
     using SIMDInt4_t   = __m128i;
@@ -83,9 +125,8 @@ namespace rl
     using SIMDFloat4P_t = const SIMDFloat4_t&;
     using SIMDInt4P_t   = const SIMDInt4_t&;
 #endif// RL_SIMD_SSEx
-}//ns rl
-namespace rl
-{
+RL_SIMD_NAMESPACE_END
+RL_SIMD_NAMESPACE_BEGIN
     struct SIMDFloat4
     {
         // (x:0,y:0,z:0,w:0)
@@ -123,6 +164,20 @@ namespace rl
         static SIMDFloat4_t loaduXY(const float* p);
         //(x:p[0],y:p[1],z:p[2],w:0)
         static SIMDFloat4_t loaduXYZ(const float* p);
+
+        // ѹĶʽ, pҪ
+        //(x:p[0]/255,y:p[1]/255,z:p[2]/255,w:p[3]/255)
+        static SIMDFloat4_t loaduUnorm8x4(const uint8_t* p);
+        //(x:p[0]/32767,y:p[1]/32767,z:0,w:0), -32768ضΪ-1
+        static SIMDFloat4_t loaduSnorm16x2(const int16_t* p);
+        //(x:p[0]/32767,y:p[1]/32767,z:p[2]/32767,w:p[3]/32767)
+        static SIMDFloat4_t loaduSnorm16x4(const int16_t* p);
+        // half float: (x:p[0],y:p[1],z:0,w:0)
+        static SIMDFloat4_t loaduHalf2(const uint16_t* p);
+        // half float: (x:p[0],y:p[1],z:p[2],w:p[3])
+        static SIMDFloat4_t loaduHalf4(const uint16_t* p);
+        // λ10:10:10:2 UNORM
+        static SIMDFloat4_t loaduUnorm10x3_2(const uint32_t* p);
     };
     //////////////////////////////////////////////////////////////////
     namespace simd
@@ -151,6 +206,34 @@ namespace rl
         SIMDFloat4_t splatY(SIMDFloat4P_t v);
         SIMDFloat4_t splatZ(SIMDFloat4P_t v);
         SIMDFloat4_t splatW(SIMDFloat4P_t v);
+
+        SIMDFloat4_t add(SIMDFloat4P_t a, SIMDFloat4P_t b);
+        SIMDFloat4_t sub(SIMDFloat4P_t a, SIMDFloat4P_t b);
+        SIMDFloat4_t mul(SIMDFloat4P_t a, SIMDFloat4P_t b);
+        SIMDFloat4_t mul(SIMDFloat4P_t a, float f);
+        SIMDFloat4_t div(SIMDFloat4P_t a, SIMDFloat4P_t b);
+        // a + (b - a) * t
+        SIMDFloat4_t lerp(SIMDFloat4P_t a, SIMDFloat4P_t b, float t);
+        // ÿԵt
+        SIMDFloat4_t lerp(SIMDFloat4P_t a, SIMDFloat4P_t b, SIMDFloat4P_t t);
+        // ȡ
+        SIMDFloat4_t floor(SIMDFloat4P_t v);
+        // (p[0]:int(x), p[1]:int(y), p[2]:int(z), p[3]:int(w)), 0ض
+        void storeuInt(SIMDFloat4P_t v, int32_t* p);
+        // Ƚ: Ϊ1.0f, Ϊ0.0f
+        SIMDFloat4_t less        (SIMDFloat4P_t a, SIMDFloat4P_t b);
+        SIMDFloat4_t lessEqual   (SIMDFloat4P_t a, SIMDFloat4P_t b);
+        SIMDFloat4_t greater     (SIMDFloat4P_t a, SIMDFloat4P_t b);
+        SIMDFloat4_t greaterEqual(SIMDFloat4P_t a, SIMDFloat4P_t b);
+        SIMDFloat4_t equal       (SIMDFloat4P_t a, SIMDFloat4P_t b);
+        SIMDFloat4_t notEqual    (SIMDFloat4P_t a, SIMDFloat4P_t b);
+        // x + y + z + w
+        float sum(SIMDFloat4P_t v);
+        // (x:a[X], y:a[Y], z:b[Z], w:b[W]), _mm_shuffle_psͬ
+        template <unsigned X, unsigned Y, unsigned Z, unsigned W>
+        SIMDFloat4_t shuffle(SIMDFloat4P_t a, SIMDFloat4P_t b);
+        // r0~r3Ϊ4x4, ԭת
+        void transpose(SIMDFloat4_t& r0, SIMDFloat4_t& r1, SIMDFloat4_t& r2, SIMDFloat4_t& r3);
     }
 
     //////////////////////////////////////////////////////////////////
@@ -165,10 +248,9 @@ namespace rl
     //{
     //    float getx(SIMDInt4P_t v);
     //}
-}//ns rl
+RL_SIMD_NAMESPACE_END
 #ifdef RL_SIMD_SSEx
-namespace rl
-{
+RL_SIMD_NAMESPACE_BEGIN
     //////////////////////////////////////////////////////////////////
     // Float4
     //////////////////////////////////////////////////////////////////
@@ -251,13 +333,66 @@ namespace rl
 	{
 		return _mm_shuffle_ps(v,v,_MM_SHUFFLE(i,i,i,i));
 	}
+    RL_FORCE_INLINE SIMDFloat4_t SIMDFloat4::loaduUnorm8x4(const uint8_t* p)
+    {
+        int32_t bits;
+        std::memcpy(&bits, p, sizeof(bits));
+        const auto zero = _mm_setzero_si128();
+        const auto i = _mm_unpacklo_epi16(_mm_unpacklo_epi8(_mm_cvtsi32_si128(bits), zero), zero);
+        return _mm_mul_ps(_mm_cvtepi32_ps(i), _mm_set1_ps(1.0f / 255.0f));
+    }
+    RL_FORCE_INLINE SIMDFloat4_t SIMDFloat4::loaduSnorm16x2(const int16_t* p)
+    {
+        int32_t bits;
+        std::memcpy(&bits, p, sizeof(bits));
+        auto i = _mm_cvtsi32_si128(bits);
+        // 16λint16, ɷչ
+        i = _mm_srai_epi32(_mm_unpacklo_epi16(i, i), 16);
+        return _mm_max_ps(_mm_mul_ps(_mm_cvtepi32_ps(i), _mm_set1_ps(1.0f / 32767.0f)), _mm_set1_ps(-1.0f));
+    }
+    RL_FORCE_INLINE SIMDFloat4_t SIMDFloat4::loaduSnorm16x4(const int16_t* p)
+    {
+        auto i = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(p));
+        i = _mm_srai_epi32(_mm_unpacklo_epi16(i, i), 16);
+        return _mm_max_ps(_mm_mul_ps(_mm_cvtepi32_ps(i), _mm_set1_ps(1.0f / 32767.0f)), _mm_set1_ps(-1.0f));
+    }
+    namespace simd_detail
+    {
+        // ÿ32λlaneĵ16λΪhalf: ָβ13λ2^112ɵõfloat(denormal); inf/nanָΪȫ1
+        RL_FORCE_INLINE SIMDFloat4_t halfToFloat(SIMDInt4P_t h)
+        {
+            const auto sign = _mm_slli_epi32(_mm_and_si128(h, _mm_set1_epi32(0x8000)), 16);
+            const auto em   = _mm_and_si128(h, _mm_set1_epi32(0x7fff));
+            const auto f    = _mm_mul_ps(_mm_castsi128_ps(_mm_slli_epi32(em, 13)), _mm_castsi128_ps(_mm_set1_epi32(0x77800000)));
+            const auto inf  = _mm_and_si128(_mm_cmpgt_epi32(em, _mm_set1_epi32(0x7bff)), _mm_set1_epi32(0x7f800000));
+            return _mm_or_ps(_mm_or_ps(f, _mm_castsi128_ps(inf)), _mm_castsi128_ps(sign));
+        }
+    }
+    RL_FORCE_INLINE SIMDFloat4_t SIMDFloat4::loaduHalf2(const uint16_t* p)
+    {
+        int32_t bits;
+        std::memcpy(&bits, p, sizeof(bits));
+        return simd_detail::halfToFloat(_mm_unpacklo_epi16(_mm_cvtsi32_si128(bits), _mm_setzero_si128()));
+    }
+    RL_FORCE_INLINE SIMDFloat4_t SIMDFloat4::loaduHalf4(const uint16_t* p)
+    {
+        return simd_detail::halfToFloat(_mm_unpacklo_epi16(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(p)), _mm_setzero_si128()));
+    }
+    RL_FORCE_INLINE SIMDFloat4_t SIMDFloat4::loaduUnorm10x3_2(const uint32_t* p)
+    {
+        uint32_t bits;
+        std::memcpy(&bits, p, sizeof(bits));
+        auto i = _mm_set_epi32(int32_t(bits >> 30), int32_t(bits >> 20), int32_t(bits >> 10), int32_t(bits));
+        i = _mm_and_si128(i, _mm_set_epi32(0x3, 0x3ff, 0x3ff, 0x3ff));
+        return _mm_mul_ps(_mm_cvtepi32_ps(i), _mm_set_ps(1.0f / 3.0f, 1.0f / 1023.0f, 1.0f / 1023.0f, 1.0f / 1023.0f));
+    }
     RL_FORCE_INLINE float simd::getX(SIMDFloat4P_t v)
     {
         return _mm_cvtss_f32(v);
     }
     RL_FORCE_INLINE float simd::getY(SIMDFloat4P_t v)
     {
-        return _mm_cvtss_f32(simd::splat(v,1));
+        return _mm_cvtss_f32(_mm_shuffle_ps(v, v, _MM_SHUFFLE(1, 1, 1, 1)));
     }
     RL_FORCE_INLINE float simd::getZ(SIMDFloat4P_t v)
     {
@@ -267,7 +402,7 @@ namespace rl
     }
     RL_FORCE_INLINE float simd::getW(SIMDFloat4P_t v)
     {
-        return _mm_cvtss_f32(simd::splat(v,3));
+        return _mm_cvtss_f32(_mm_shuffle_ps(v, v, _MM_SHUFFLE(3, 3, 3, 3)));
     }	
 
     RL_FORCE_INLINE SIMDFloat4_t simd::setX(SIMDFloat4P_t v, float f)
@@ -316,27 +451,842 @@ namespace rl
 
     RL_FORCE_INLINE SIMDFloat4_t simd::splatX(SIMDFloat4P_t v)
     {
-        return simd::splat(v, 0);
+        return _mm_shuffle_ps(v, v, _MM_SHUFFLE(0, 0, 0, 0));
     }
     RL_FORCE_INLINE SIMDFloat4_t simd::splatY(SIMDFloat4P_t v) 
     {
-        return simd::splat(v, 1);
+        return _mm_shuffle_ps(v, v, _MM_SHUFFLE(1, 1, 1, 1));
     }
     RL_FORCE_INLINE SIMDFloat4_t simd::splatZ(SIMDFloat4P_t v) 
     {
-        return simd::splat(v, 2);
+        return _mm_shuffle_ps(v, v, _MM_SHUFFLE(2, 2, 2, 2));
     }
     RL_FORCE_INLINE SIMDFloat4_t simd::splatW(SIMDFloat4P_t v) 
     {
-        return simd::splat(v, 3);
+        return _mm_shuffle_ps(v, v, _MM_SHUFFLE(3, 3, 3, 3));
+    }
+    RL_FORCE_INLINE SIMDFloat4_t simd::add(SIMDFloat4P_t a, SIMDFloat4P_t b)
+    {
+        return _mm_add_ps(a, b);
+    }
+    RL_FORCE_INLINE SIMDFloat4_t simd::sub(SIMDFloat4P_t a, SIMDFloat4P_t b)
+    {
+        return _mm_sub_ps(a, b);
+    }
+    RL_FORCE_INLINE SIMDFloat4_t simd::mul(SIMDFloat4P_t a, SIMDFloat4P_t b)
+    {
+        return _mm_mul_ps(a, b);
+    }
+    RL_FORCE_INLINE SIMDFloat4_t simd::mul(SIMDFloat4P_t a, float f)
+    {
+        return _mm_mul_ps(a, _mm_set1_ps(f));
+    }
+    RL_FORCE_INLINE SIMDFloat4_t simd::div(SIMDFloat4P_t a, SIMDFloat4P_t b)
+    {
+        return _mm_div_ps(a, b);
+    }
+    RL_FORCE_INLINE SIMDFloat4_t simd::lerp(SIMDFloat4P_t a, SIMDFloat4P_t b, float t)
+    {
+        return _mm_add_ps(a, _mm_mul_ps(_mm_sub_ps(b, a), _mm_set1_ps(t)));
+    }
+    RL_FORCE_INLINE SIMDFloat4_t simd::lerp(SIMDFloat4P_t a, SIMDFloat4P_t b, SIMDFloat4P_t t)
+    {
+        return _mm_add_ps(a, _mm_mul_ps(_mm_sub_ps(b, a), t));
+    }
+    RL_FORCE_INLINE SIMDFloat4_t simd::floor(SIMDFloat4P_t v)
+    {
+#if defined(RL_SIMD_SSE4_1)
+        return _mm_floor_ps(v);
+#else
+        // ضϺ, ԽضϽvķ(ķ)1
+        const auto t = _mm_cvtepi32_ps(_mm_cvttps_epi32(v));
+        return _mm_sub_ps(t, _mm_and_ps(_mm_cmpgt_ps(t, v), _mm_set1_ps(1.0f)));
+#endif
+    }
+    RL_FORCE_INLINE void simd::storeuInt(SIMDFloat4P_t v, int32_t* p)
+    {
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(p), _mm_cvttps_epi32(v));
+    }
+    RL_FORCE_INLINE SIMDFloat4_t simd::less(SIMDFloat4P_t a, SIMDFloat4P_t b)
+    {
+        return _mm_and_ps(_mm_cmplt_ps(a, b), _mm_set1_ps(1.0f));
+    }
+    RL_FORCE_INLINE SIMDFloat4_t simd::lessEqual(SIMDFloat4P_t a, SIMDFloat4P_t b)
+    {
+        return _mm_and_ps(_mm_cmple_ps(a, b), _mm_set1_ps(1.0f));
+    }
+    RL_FORCE_INLINE SIMDFloat4_t simd::greater(SIMDFloat4P_t a, SIMDFloat4P_t b)
+    {
+        return _mm_and_ps(_mm_cmpgt_ps(a, b), _mm_set1_ps(1.0f));
+    }
+    RL_FORCE_INLINE SIMDFloat4_t simd::greaterEqual(SIMDFloat4P_t a, SIMDFloat4P_t b)
+    {
+        return _mm_and_ps(_mm_cmpge_ps(a, b), _mm_set1_ps(1.0f));
+    }
+    RL_FORCE_INLINE SIMDFloat4_t simd::equal(SIMDFloat4P_t a, SIMDFloat4P_t b)
+    {
+        return _mm_and_ps(_mm_cmpeq_ps(a, b), _mm_set1_ps(1.0f));
+    }
+    RL_FORCE_INLINE SIMDFloat4_t simd::notEqual(SIMDFloat4P_t a, SIMDFloat4P_t b)
+    {
+        return _mm_and_ps(_mm_cmpneq_ps(a, b), _mm_set1_ps(1.0f));
+    }
+    RL_FORCE_INLINE float simd::sum(SIMDFloat4P_t v)
+    {
+        // (x+z, y+w, ...) -> (x+z)+(y+w)
+        const auto t = _mm_add_ps(v, _mm_movehl_ps(v, v));
+        return _mm_cvtss_f32(_mm_add_ss(t, _mm_shuffle_ps(t, t, _MM_SHUFFLE(1, 1, 1, 1))));
+    }
+    template <unsigned X, unsigned Y, unsigned Z, unsigned W>
+    RL_FORCE_INLINE SIMDFloat4_t simd::shuffle(SIMDFloat4P_t a, SIMDFloat4P_t b)
+    {
+        return _mm_shuffle_ps(a, b, _MM_SHUFFLE(W, Z, Y, X));
+    }
+    RL_FORCE_INLINE void simd::transpose(SIMDFloat4_t& r0, SIMDFloat4_t& r1, SIMDFloat4_t& r2, SIMDFloat4_t& r3)
+    {
+        _MM_TRANSPOSE4_PS(r0, r1, r2, r3);
     }
     //////////////////////////////////////////////////////////////////
     // Int4
     //////////////////////////////////////////////////////////////////
-}
+RL_SIMD_NAMESPACE_END
 
 #elif defined(RL_SIMD_REF)
+RL_SIMD_NAMESPACE_BEGIN
+    // ʵֲstd::floor/std::swap<cmath>/<utility>е: ǲRL_SIMD_ABI,
+    // Բͬ/archķ뵥Ԫһͬ, ѡиָһ
+    // ֻλCпеⲿ(::sqrt)
+    namespace simd_detail
+    {
+        inline uint32_t floatBits(float f)
+        {
+            uint32_t bits;
+            std::memcpy(&bits, &f, sizeof(bits));
+            return bits;
+        }
+        inline float bitsFloat(uint32_t bits)
+        {
+            float f;
+            std::memcpy(&f, &bits, sizeof(f));
+            return f;
+        }
+        inline float absRef(float f)
+        {
+            return bitsFloat(floatBits(f) & 0x7fffffff);
+        }
+        // |f| >= 2^23ʱ(NaN/Inf), ԭ; , -0.5õ-0
+        inline float truncRef(float f)
+        {
+            if(!(absRef(f) < 8388608.0f))
+                return f;
+            return bitsFloat(floatBits(float(int32_t(f))) | (floatBits(f) & 0x80000000));
+        }
+        inline float floorRef(float f)
+        {
+            const auto t = truncRef(f);
+            return t > f ? t - 1.0f : t;
+        }
+        // doublesqrt뵽floatΪȷĽ
+        inline float sqrtRef(float f)
+        {
+            return float(::sqrt(double(f)));
+        }
+        inline void swapRef(float& a, float& b)
+        {
+            const auto t = a;
+            a = b;
+            b = t;
+        }
+    }
+    //////////////////////////////////////////////////////////////////
+    // Float4: ʵ
+    //////////////////////////////////////////////////////////////////
+    inline SIMDFloat4_t SIMDFloat4::zero()
+    {
+        return { 0.0f, 0.0f, 0.0f, 0.0f };
+    }
+    inline SIMDFloat4_t SIMDFloat4::one()
+    {
+        return { 1.0f, 1.0f, 1.0f, 1.0f };
+    }
+    inline SIMDFloat4_t SIMDFloat4::unitX()
+    {
+        return { 1.0f, 0.0f, 0.0f, 0.0f };
+    }
+    inline SIMDFloat4_t SIMDFloat4::unitY()
+    {
+        return { 0.0f, 1.0f, 0.0f, 0.0f };
+    }
+    inline SIMDFloat4_t SIMDFloat4::unitZ()
+    {
+        return { 0.0f, 0.0f, 1.0f, 0.0f };
+    }
+    inline SIMDFloat4_t SIMDFloat4::unitW()
+    {
+        return { 0.0f, 0.0f, 0.0f, 1.0f };
+    }
+    inline SIMDFloat4_t SIMDFloat4::set(float x, float y, float z, float w)
+    {
+        return { x, y, z, w };
+    }
+    inline SIMDFloat4_t SIMDFloat4::set1(float v)
+    {
+        return { v, v, v, v };
+    }
+    inline SIMDFloat4_t SIMDFloat4::setX(float v)
+    {
+        return { v, 0.0f, 0.0f, 0.0f };
+    }
+    inline SIMDFloat4_t SIMDFloat4::load(const float* p)
+    {
+        assert(IsAligned<16>(p));
+        return { p[0], p[1], p[2], p[3] };
+    }
+    inline SIMDFloat4_t SIMDFloat4::loadX(const float* p)
+    {
+        assert(IsAligned<16>(p));
+        return { p[0], 0.0f, 0.0f, 0.0f };
+    }
+    inline SIMDFloat4_t SIMDFloat4::loadu(const float* p)
+    {
+        return { p[0], p[1], p[2], p[3] };
+    }
+    inline SIMDFloat4_t SIMDFloat4::loadu1(const float* p)
+    {
+        return { p[0], p[0], p[0], p[0] };
+    }
+    inline SIMDFloat4_t SIMDFloat4::loaduX(const float* p)
+    {
+        return { p[0], 0.0f, 0.0f, 0.0f };
+    }
+    inline SIMDFloat4_t SIMDFloat4::loaduXY(const float* p)
+    {
+        return { p[0], p[1], 0.0f, 0.0f };
+    }
+    inline SIMDFloat4_t SIMDFloat4::loaduXYZ(const float* p)
+    {
+        return { p[0], p[1], p[2], 0.0f };
+    }
+    //////////////////////////////////////////////////////////////////
+    inline SIMDFloat4_t SIMDFloat4::loaduUnorm8x4(const uint8_t* p)
+    {
+        const auto k = 1.0f / 255.0f;
+        return { p[0] * k, p[1] * k, p[2] * k, p[3] * k };
+    }
+    namespace simd_detail
+    {
+        inline float snorm16ToFloat(int16_t v)
+        {
+            return v == -32768 ? -1.0f : v * (1.0f / 32767.0f);
+        }
+        inline float halfToFloat(uint16_t h)
+        {
+            const uint32_t em = h & 0x7fff;
+            uint32_t bits = em << 13;
+            float f;
+            std::memcpy(&f, &bits, sizeof(f));
+            f *= bitsFloat(0x77800000); // 2^112
+            std::memcpy(&bits, &f, sizeof(f));
+            if(em > 0x7bff)
+                bits |= 0x7f800000;
+            bits |= uint32_t(h & 0x8000) << 16;
+            std::memcpy(&f, &bits, sizeof(f));
+            return f;
+        }
+    }
+    inline SIMDFloat4_t SIMDFloat4::loaduSnorm16x2(const int16_t* p)
+    {
+        return { simd_detail::snorm16ToFloat(p[0]), simd_detail::snorm16ToFloat(p[1]), 0.0f, 0.0f };
+    }
+    inline SIMDFloat4_t SIMDFloat4::loaduSnorm16x4(const int16_t* p)
+    {
+        return { simd_detail::snorm16ToFloat(p[0]), simd_detail::snorm16ToFloat(p[1]), simd_detail::snorm16ToFloat(p[2]), simd_detail::snorm16ToFloat(p[3]) };
+    }
+    inline SIMDFloat4_t SIMDFloat4::loaduHalf2(const uint16_t* p)
+    {
+        return { simd_detail::halfToFloat(p[0]), simd_detail::halfToFloat(p[1]), 0.0f, 0.0f };
+    }
+    inline SIMDFloat4_t SIMDFloat4::loaduHalf4(const uint16_t* p)
+    {
+        return { simd_detail::halfToFloat(p[0]), simd_detail::halfToFloat(p[1]), simd_detail::halfToFloat(p[2]), simd_detail::halfToFloat(p[3]) };
+    }
+    inline SIMDFloat4_t SIMDFloat4::loaduUnorm10x3_2(const uint32_t* p)
+    {
+        uint32_t bits;
+        std::memcpy(&bits, p, sizeof(bits));
+        const auto k = 1.0f / 1023.0f;
+        return { (bits & 0x3ff) * k, ((bits >> 10) & 0x3ff) * k, ((bits >> 20) & 0x3ff) * k, (bits >> 30) * (1.0f / 3.0f) };
+    }
+    inline float simd::getX(SIMDFloat4P_t v)
+    {
+        return v.x;
+    }
+    inline float simd::getY(SIMDFloat4P_t v)
+    {
+        return v.y;
+    }
+    inline float simd::getZ(SIMDFloat4P_t v)
+    {
+        return v.z;
+    }
+    inline float simd::getW(SIMDFloat4P_t v)
+    {
+        return v.w;
+    }
+    inline SIMDFloat4_t simd::splat(SIMDFloat4P_t v, unsigned int i)
+    {
+        const auto f = (&v.x)[i];
+        return { f, f, f, f };
+    }
+    inline SIMDFloat4_t simd::setX(SIMDFloat4P_t v, float f)
+    {
+        return { f, v.y, v.z, v.w };
+    }
+    inline SIMDFloat4_t simd::setY(SIMDFloat4P_t v, float f)
+    {
+        return { v.x, f, v.z, v.w };
+    }
+    inline SIMDFloat4_t simd::setZ(SIMDFloat4P_t v, float f)
+    {
+        return { v.x, v.y, f, v.w };
+    }
+    inline SIMDFloat4_t simd::setW(SIMDFloat4P_t v, float f)
+    {
+        return { v.x, v.y, v.z, f };
+    }
+    inline void simd::store(SIMDFloat4P_t v, float* p)
+    {
+        assert(IsAligned<16>(p));
+        p[0] = v.x; p[1] = v.y; p[2] = v.z; p[3] = v.w;
+    }
+    inline void simd::storeX(SIMDFloat4P_t v, float* p)
+    {
+        assert(IsAligned<16>(p));
+        p[0] = v.x;
+    }
+    inline void simd::storeu(SIMDFloat4P_t v, float* p)
+    {
+        p[0] = v.x; p[1] = v.y; p[2] = v.z; p[3] = v.w;
+    }
+    inline void simd::storeuX(SIMDFloat4P_t v, float* p)
+    {
+        p[0] = v.x;
+    }
+    inline SIMDFloat4_t simd::splatX(SIMDFloat4P_t v)
+    {
+        return simd::splat(v, 0);
+    }
+    inline SIMDFloat4_t simd::splatY(SIMDFloat4P_t v)
+    {
+        return simd::splat(v, 1);
+    }
+    inline SIMDFloat4_t simd::splatZ(SIMDFloat4P_t v)
+    {
+        return simd::splat(v, 2);
+    }
+    inline SIMDFloat4_t simd::splatW(SIMDFloat4P_t v)
+    {
+        return simd::splat(v, 3);
+    }
+    inline SIMDFloat4_t simd::add(SIMDFloat4P_t a, SIMDFloat4P_t b)
+    {
+        return { a.x + b.x, a.y + b.y, a.z + b.z, a.w + b.w };
+    }
+    inline SIMDFloat4_t simd::sub(SIMDFloat4P_t a, SIMDFloat4P_t b)
+    {
+        return { a.x - b.x, a.y - b.y, a.z - b.z, a.w - b.w };
+    }
+    inline SIMDFloat4_t simd::mul(SIMDFloat4P_t a, SIMDFloat4P_t b)
+    {
+        return { a.x * b.x, a.y * b.y, a.z * b.z, a.w * b.w };
+    }
+    inline SIMDFloat4_t simd::mul(SIMDFloat4P_t a, float f)
+    {
+        return { a.x * f, a.y * f, a.z * f, a.w * f };
+    }
+    inline SIMDFloat4_t simd::div(SIMDFloat4P_t a, SIMDFloat4P_t b)
+    {
+        return { a.x / b.x, a.y / b.y, a.z / b.z, a.w / b.w };
+    }
+    inline SIMDFloat4_t simd::lerp(SIMDFloat4P_t a, SIMDFloat4P_t b, float t)
+    {
+        return { a.x + (b.x - a.x) * t, a.y + (b.y - a.y) * t, a.z + (b.z - a.z) * t, a.w + (b.w - a.w) * t };
+    }
+    inline SIMDFloat4_t simd::lerp(SIMDFloat4P_t a, SIMDFloat4P_t b, SIMDFloat4P_t t)
+    {
+        return { a.x + (b.x - a.x) * t.x, a.y + (b.y - a.y) * t.y, a.z + (b.z - a.z) * t.z, a.w + (b.w - a.w) * t.w };
+    }
+    inline SIMDFloat4_t simd::floor(SIMDFloat4P_t v)
+    {
+        return { simd_detail::floorRef(v.x), simd_detail::floorRef(v.y), simd_detail::floorRef(v.z), simd_detail::floorRef(v.w) };
+    }
+    inline void simd::storeuInt(SIMDFloat4P_t v, int32_t* p)
+    {
+        p[0] = int32_t(v.x); p[1] = int32_t(v.y); p[2] = int32_t(v.z); p[3] = int32_t(v.w);
+    }
+    inline SIMDFloat4_t simd::less(SIMDFloat4P_t a, SIMDFloat4P_t b)
+    {
+        return { a.x < b.x ? 1.0f : 0.0f, a.y < b.y ? 1.0f : 0.0f, a.z < b.z ? 1.0f : 0.0f, a.w < b.w ? 1.0f : 0.0f };
+    }
+    inline SIMDFloat4_t simd::lessEqual(SIMDFloat4P_t a, SIMDFloat4P_t b)
+    {
+        return { a.x <= b.x ? 1.0f : 0.0f, a.y <= b.y ? 1.0f : 0.0f, a.z <= b.z ? 1.0f : 0.0f, a.w <= b.w ? 1.0f : 0.0f };
+    }
+    inline SIMDFloat4_t simd::greater(SIMDFloat4P_t a, SIMDFloat4P_t b)
+    {
+        return { a.x > b.x ? 1.0f : 0.0f, a.y > b.y ? 1.0f : 0.0f, a.z > b.z ? 1.0f : 0.0f, a.w > b.w ? 1.0f : 0.0f };
+    }
+    inline SIMDFloat4_t simd::greaterEqual(SIMDFloat4P_t a, SIMDFloat4P_t b)
+    {
+        return { a.x >= b.x ? 1.0f : 0.0f, a.y >= b.y ? 1.0f : 0.0f, a.z >= b.z ? 1.0f : 0.0f, a.w >= b.w ? 1.0f : 0.0f };
+    }
+    inline SIMDFloat4_t simd::equal(SIMDFloat4P_t a, SIMDFloat4P_t b)
+    {
+        return { a.x == b.x ? 1.0f : 0.0f, a.y == b.y ? 1.0f : 0.0f, a.z == b.z ? 1.0f : 0.0f, a.w == b.w ? 1.0f : 0.0f };
+    }
+    inline SIMDFloat4_t simd::notEqual(SIMDFloat4P_t a, SIMDFloat4P_t b)
+    {
+        return { a.x != b.x ? 1.0f : 0.0f, a.y != b.y ? 1.0f : 0.0f, a.z != b.z ? 1.0f : 0.0f, a.w != b.w ? 1.0f : 0.0f };
+    }
+    inline float simd::sum(SIMDFloat4P_t v)
+    {
+        return (v.x + v.z) + (v.y + v.w);
+    }
+    template <unsigned X, unsigned Y, unsigned Z, unsigned W>
+    inline SIMDFloat4_t simd::shuffle(SIMDFloat4P_t a, SIMDFloat4P_t b)
+    {
+        return { (&a.x)[X], (&a.x)[Y], (&b.x)[Z], (&b.x)[W] };
+    }
+    inline void simd::transpose(SIMDFloat4_t& r0, SIMDFloat4_t& r1, SIMDFloat4_t& r2, SIMDFloat4_t& r3)
+    {
+        using simd_detail::swapRef;
+        swapRef(r0.y, r1.x); swapRef(r0.z, r2.x); swapRef(r0.w, r3.x);
+        swapRef(r1.z, r2.y); swapRef(r1.w, r3.y); swapRef(r2.w, r3.z);
+    }
+RL_SIMD_NAMESPACE_END
 #else
 #error δ֪ SIMD ָ
 #endif
+//////////////////////////////////////////////////////////////////
+// SoA lane: floatNһδSIMD_LANE_COUNTvertex/pixelͬһ
+// AVX-512: 16 lane; AVX: 8 lane; SSE: 4 lane; RL_SIMD_REF: 4 lane
+//////////////////////////////////////////////////////////////////
+RL_SIMD_NAMESPACE_BEGIN
+#if defined(RL_SIMD_AVX512)
+    constexpr uint32_t SIMD_LANE_COUNT = 16;
+    using SIMDFloatN_t = __m512;
+    using SIMDMaskN_t  = __mmask16;
+#elif defined(RL_SIMD_AVX)
+    constexpr uint32_t SIMD_LANE_COUNT = 8;
+    using SIMDFloatN_t = __m256;
+    using SIMDMaskN_t  = __m256;
+#elif defined(RL_SIMD_SSEx)
+    constexpr uint32_t SIMD_LANE_COUNT = 4;
+    using SIMDFloatN_t = __m128;
+    using SIMDMaskN_t  = __m128;
+#else
+    constexpr uint32_t SIMD_LANE_COUNT = 4;
+    struct SIMDFloatN_t
+    {
+        float f[SIMD_LANE_COUNT];
+    };
+    struct SIMDMaskN_t
+    {
+        bool b[SIMD_LANE_COUNT];
+    };
+#endif
+    // ÿlaneһbool
+    struct maskN
+    {
+        SIMDMaskN_t v;
+
+        maskN() = default;
+        explicit maskN(SIMDMaskN_t rhs) : v(rhs) {}
+        // bit i -> lane i
+        static maskN fromBits(uint32_t bits);
+        // lane i -> bit i
+        uint32_t bits() const;
+    };
+    struct floatN
+    {
+        SIMDFloatN_t v;
+
+        floatN() = default;
+        floatN(float f); // 㲥lane
+        explicit floatN(SIMDFloatN_t rhs) : v(rhs) {}
+        // Ƕ
+        static floatN load(const float* p);
+        // lane i = p[i*stride]
+        static floatN gather(const float* p, uint32_t stride);
+        // lane i = p[indices[i]]
+        static floatN gatherIndexed(const float* p, const int32_t indices[SIMD_LANE_COUNT]);
+        void  store(float* p) const;
+        // 0ضΪint32д
+        void  storeInt(int32_t* p) const;
+        float lane(uint32_t i) const;
+        void  setLane(uint32_t i, float f);
+    };
+    floatN operator +(const floatN& a, const floatN& b);
+    floatN operator -(const floatN& a, const floatN& b);
+    floatN operator *(const floatN& a, const floatN& b);
+    floatN operator /(const floatN& a, const floatN& b);
+    floatN operator -(const floatN& a);
+    floatN& operator +=(floatN& a, const floatN& b);
+    floatN& operator -=(floatN& a, const floatN& b);
+    floatN& operator *=(floatN& a, const floatN& b);
+    floatN& operator /=(floatN& a, const floatN& b);
+
+    maskN operator < (const floatN& a, const floatN& b);
+    maskN operator <=(const floatN& a, const floatN& b);
+    maskN operator > (const floatN& a, const floatN& b);
+    maskN operator >=(const floatN& a, const floatN& b);
+    maskN operator ==(const floatN& a, const floatN& b);
+    maskN operator !=(const floatN& a, const floatN& b);
+
+    maskN operator &(const maskN& a, const maskN& b);
+    maskN operator |(const maskN& a, const maskN& b);
+    maskN operator ^(const maskN& a, const maskN& b);
+    maskN operator ~(const maskN& a);
+    bool  any(const maskN& m);
+    bool  all(const maskN& m);
+
+    // m ? a : b
+    floatN select(const maskN& m, const floatN& a, const floatN& b);
+    floatN min  (const floatN& a, const floatN& b);
+    floatN max  (const floatN& a, const floatN& b);
+    floatN abs  (const floatN& a);
+    floatN sqrt (const floatN& a);
+    // 0ȡ
+    floatN trunc(const floatN& a);
+    // ȡ
+    floatN floor(const floatN& a);
+RL_SIMD_NAMESPACE_END
+#if defined(RL_SIMD_AVX512)
+RL_SIMD_NAMESPACE_BEGIN
+    RL_FORCE_INLINE maskN maskN::fromBits(uint32_t bits)
+    {
+        return maskN(__mmask16(bits));
+    }
+    RL_FORCE_INLINE uint32_t maskN::bits() const
+    {
+        return uint32_t(v);
+    }
+    RL_FORCE_INLINE floatN::floatN(float f) : v(_mm512_set1_ps(f)) {}
+    RL_FORCE_INLINE floatN floatN::load(const float* p)
+    {
+        return floatN(_mm512_loadu_ps(p));
+    }
+    RL_FORCE_INLINE floatN floatN::gather(const float* p, uint32_t stride)
+    {
+        const auto index = _mm512_mullo_epi32(_mm512_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15), _mm512_set1_epi32(int32_t(stride)));
+        return floatN(_mm512_i32gather_ps(index, p, 4));
+    }
+    RL_FORCE_INLINE floatN floatN::gatherIndexed(const float* p, const int32_t indices[SIMD_LANE_COUNT])
+    {
+        return floatN(_mm512_i32gather_ps(_mm512_loadu_si512(indices), p, 4));
+    }
+    RL_FORCE_INLINE void floatN::store(float* p) const
+    {
+        _mm512_storeu_ps(p, v);
+    }
+    RL_FORCE_INLINE void floatN::storeInt(int32_t* p) const
+    {
+        _mm512_storeu_si512(p, _mm512_cvttps_epi32(v));
+    }
+    // ֻAVX512F: and/xorAVX512DQ, ָ
+    RL_FORCE_INLINE floatN operator +(const floatN& a, const floatN& b) { return floatN(_mm512_add_ps(a.v, b.v)); }
+    RL_FORCE_INLINE floatN operator -(const floatN& a, const floatN& b) { return floatN(_mm512_sub_ps(a.v, b.v)); }
+    RL_FORCE_INLINE floatN operator *(const floatN& a, const floatN& b) { return floatN(_mm512_mul_ps(a.v, b.v)); }
+    RL_FORCE_INLINE floatN operator /(const floatN& a, const floatN& b) { return floatN(_mm512_div_ps(a.v, b.v)); }
+    RL_FORCE_INLINE floatN operator -(const floatN& a) { return floatN(_mm512_castsi512_ps(_mm512_xor_si512(_mm512_castps_si512(a.v), _mm512_set1_epi32(int32_t(0x80000000u))))); }
+
+    RL_FORCE_INLINE maskN operator < (const floatN& a, const floatN& b) { return maskN(_mm512_cmp_ps_mask(a.v, b.v, _CMP_LT_OQ)); }
+    RL_FORCE_INLINE maskN operator <=(const floatN& a, const floatN& b) { return maskN(_mm512_cmp_ps_mask(a.v, b.v, _CMP_LE_OQ)); }
+    RL_FORCE_INLINE maskN operator > (const floatN& a, const floatN& b) { return maskN(_mm512_cmp_ps_mask(a.v, b.v, _CMP_GT_OQ)); }
+    RL_FORCE_INLINE maskN operator >=(const floatN& a, const floatN& b) { return maskN(_mm512_cmp_ps_mask(a.v, b.v, _CMP_GE_OQ)); }
+    RL_FORCE_INLINE maskN operator ==(const floatN& a, const floatN& b) { return maskN(_mm512_cmp_ps_mask(a.v, b.v, _CMP_EQ_OQ)); }
+    RL_FORCE_INLINE maskN operator !=(const floatN& a, const floatN& b) { return maskN(_mm512_cmp_ps_mask(a.v, b.v, _CMP_NEQ_UQ)); }
+
+    RL_FORCE_INLINE maskN operator &(const maskN& a, const maskN& b) { return maskN(__mmask16(a.v & b.v)); }
+    RL_FORCE_INLINE maskN operator |(const maskN& a, const maskN& b) { return maskN(__mmask16(a.v | b.v)); }
+    RL_FORCE_INLINE maskN operator ^(const maskN& a, const maskN& b) { return maskN(__mmask16(a.v ^ b.v)); }
+    RL_FORCE_INLINE maskN operator ~(const maskN& a) { return maskN(__mmask16(~a.v)); }
+
+    RL_FORCE_INLINE floatN select(const maskN& m, const floatN& a, const floatN& b) { return floatN(_mm512_mask_blend_ps(m.v, b.v, a.v)); }
+    RL_FORCE_INLINE floatN min  (const floatN& a, const floatN& b) { return floatN(_mm512_min_ps(a.v, b.v)); }
+    RL_FORCE_INLINE floatN max  (const floatN& a, const floatN& b) { return floatN(_mm512_max_ps(a.v, b.v)); }
+    RL_FORCE_INLINE floatN abs  (const floatN& a) { return floatN(_mm512_abs_ps(a.v)); }
+    RL_FORCE_INLINE floatN sqrt (const floatN& a) { return floatN(_mm512_sqrt_ps(a.v)); }
+    RL_FORCE_INLINE floatN trunc(const floatN& a) { return floatN(_mm512_roundscale_ps(a.v, _MM_FROUND_TO_ZERO | _MM_FROUND_NO_EXC)); }
+    RL_FORCE_INLINE floatN floor(const floatN& a) { return floatN(_mm512_roundscale_ps(a.v, _MM_FROUND_TO_NEG_INF | _MM_FROUND_NO_EXC)); }
+RL_SIMD_NAMESPACE_END
+#elif defined(RL_SIMD_AVX)
+RL_SIMD_NAMESPACE_BEGIN
+    RL_FORCE_INLINE maskN maskN::fromBits(uint32_t bits)
+    {
+        const auto lanes = _mm256_set_epi32(0x80, 0x40, 0x20, 0x10, 0x08, 0x04, 0x02, 0x01);
+        // AVX1û256λȽ, תfloatȽ
+        const auto test = _mm256_cvtepi32_ps(_mm256_castps_si256(_mm256_and_ps(_mm256_castsi256_ps(_mm256_set1_epi32(int32_t(bits))), _mm256_castsi256_ps(lanes))));
+        return maskN(_mm256_cmp_ps(test, _mm256_setzero_ps(), _CMP_NEQ_OQ));
+    }
+    RL_FORCE_INLINE uint32_t maskN::bits() const
+    {
+        return uint32_t(_mm256_movemask_ps(v));
+    }
+    RL_FORCE_INLINE floatN::floatN(float f) : v(_mm256_set1_ps(f)) {}
+    RL_FORCE_INLINE floatN floatN::load(const float* p)
+    {
+        return floatN(_mm256_loadu_ps(p));
+    }
+    RL_FORCE_INLINE floatN floatN::gather(const float* p, uint32_t stride)
+    {
+#if defined(RL_SIMD_AVX2)
+        const auto index = _mm256_mullo_epi32(_mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7), _mm256_set1_epi32(int32_t(stride)));
+        return floatN(_mm256_i32gather_ps(p, index, 4));
+#else
+        return floatN(_mm256_setr_ps(p[0], p[stride], p[2 * stride], p[3 * stride], p[4 * stride], p[5 * stride], p[6 * stride], p[7 * stride]));
+#endif
+    }
+    RL_FORCE_INLINE floatN floatN::gatherIndexed(const float* p, const int32_t indices[SIMD_LANE_COUNT])
+    {
+#if defined(RL_SIMD_AVX2)
+        return floatN(_mm256_i32gather_ps(p, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(indices)), 4));
+#else
+        return floatN(_mm256_setr_ps(p[indices[0]], p[indices[1]], p[indices[2]], p[indices[3]], p[indices[4]], p[indices[5]], p[indices[6]], p[indices[7]]));
+#endif
+    }
+    RL_FORCE_INLINE void floatN::store(float* p) const
+    {
+        _mm256_storeu_ps(p, v);
+    }
+    RL_FORCE_INLINE void floatN::storeInt(int32_t* p) const
+    {
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(p), _mm256_cvttps_epi32(v));
+    }
+    RL_FORCE_INLINE floatN operator +(const floatN& a, const floatN& b) { return floatN(_mm256_add_ps(a.v, b.v)); }
+    RL_FORCE_INLINE floatN operator -(const floatN& a, const floatN& b) { return floatN(_mm256_sub_ps(a.v, b.v)); }
+    RL_FORCE_INLINE floatN operator *(const floatN& a, const floatN& b) { return floatN(_mm256_mul_ps(a.v, b.v)); }
+    RL_FORCE_INLINE floatN operator /(const floatN& a, const floatN& b) { return floatN(_mm256_div_ps(a.v, b.v)); }
+    RL_FORCE_INLINE floatN operator -(const floatN& a) { return floatN(_mm256_xor_ps(a.v, _mm256_set1_ps(-0.0f))); }
+
+    RL_FORCE_INLINE maskN operator < (const floatN& a, const floatN& b) { return maskN(_mm256_cmp_ps(a.v, b.v, _CMP_LT_OQ)); }
+    RL_FORCE_INLINE maskN operator <=(const floatN& a, const floatN& b) { return maskN(_mm256_cmp_ps(a.v, b.v, _CMP_LE_OQ)); }
+    RL_FORCE_INLINE maskN operator > (const floatN& a, const floatN& b) { return maskN(_mm256_cmp_ps(a.v, b.v, _CMP_GT_OQ)); }
+    RL_FORCE_INLINE maskN operator >=(const floatN& a, const floatN& b) { return maskN(_mm256_cmp_ps(a.v, b.v, _CMP_GE_OQ)); }
+    RL_FORCE_INLINE maskN operator ==(const floatN& a, const floatN& b) { return maskN(_mm256_cmp_ps(a.v, b.v, _CMP_EQ_OQ)); }
+    RL_FORCE_INLINE maskN operator !=(const floatN& a, const floatN& b) { return maskN(_mm256_cmp_ps(a.v, b.v, _CMP_NEQ_UQ)); }
+
+    RL_FORCE_INLINE maskN operator &(const maskN& a, const maskN& b) { return maskN(_mm256_and_ps(a.v, b.v)); }
+    RL_FORCE_INLINE maskN operator |(const maskN& a, const maskN& b) { return maskN(_mm256_or_ps(a.v, b.v)); }
+    RL_FORCE_INLINE maskN operator ^(const maskN& a, const maskN& b) { return maskN(_mm256_xor_ps(a.v, b.v)); }
+    RL_FORCE_INLINE maskN operator ~(const maskN& a) { return maskN(_mm256_xor_ps(a.v, _mm256_castsi256_ps(_mm256_set1_epi32(-1)))); }
+
+    RL_FORCE_INLINE floatN select(const maskN& m, const floatN& a, const floatN& b) { return floatN(_mm256_blendv_ps(b.v, a.v, m.v)); }
+    RL_FORCE_INLINE floatN min (const floatN& a, const floatN& b) { return floatN(_mm256_min_ps(a.v, b.v)); }
+    RL_FORCE_INLINE floatN max (const floatN& a, const floatN& b) { return floatN(_mm256_max_ps(a.v, b.v)); }
+    RL_FORCE_INLINE floatN abs (const floatN& a) { return floatN(_mm256_andnot_ps(_mm256_set1_ps(-0.0f), a.v)); }
+    RL_FORCE_INLINE floatN sqrt(const floatN& a) { return floatN(_mm256_sqrt_ps(a.v)); }
+    RL_FORCE_INLINE floatN trunc(const floatN& a) { return floatN(_mm256_round_ps(a.v, _MM_FROUND_TO_ZERO | _MM_FROUND_NO_EXC)); }
+    RL_FORCE_INLINE floatN floor(const floatN& a) { return floatN(_mm256_round_ps(a.v, _MM_FROUND_TO_NEG_INF | _MM_FROUND_NO_EXC)); }
+RL_SIMD_NAMESPACE_END
+#elif defined(RL_SIMD_SSEx)
+RL_SIMD_NAMESPACE_BEGIN
+    RL_FORCE_INLINE maskN maskN::fromBits(uint32_t bits)
+    {
+        const auto lanes = _mm_set_epi32(0x8, 0x4, 0x2, 0x1);
+        const auto test  = _mm_and_si128(_mm_set1_epi32(int32_t(bits)), lanes);
+        return maskN(_mm_castsi128_ps(_mm_cmpeq_epi32(test, lanes)));
+    }
+    RL_FORCE_INLINE uint32_t maskN::bits() const
+    {
+        return uint32_t(_mm_movemask_ps(v));
+    }
+    RL_FORCE_INLINE floatN::floatN(float f) : v(_mm_set1_ps(f)) {}
+    RL_FORCE_INLINE floatN floatN::load(const float* p)
+    {
+        return floatN(_mm_loadu_ps(p));
+    }
+    RL_FORCE_INLINE floatN floatN::gather(const float* p, uint32_t stride)
+    {
+        return floatN(_mm_setr_ps(p[0], p[stride], p[2 * stride], p[3 * stride]));
+    }
+    RL_FORCE_INLINE floatN floatN::gatherIndexed(const float* p, const int32_t indices[SIMD_LANE_COUNT])
+    {
+        return floatN(_mm_setr_ps(p[indices[0]], p[indices[1]], p[indices[2]], p[indices[3]]));
+    }
+    RL_FORCE_INLINE void floatN::store(float* p) const
+    {
+        _mm_storeu_ps(p, v);
+    }
+    RL_FORCE_INLINE void floatN::storeInt(int32_t* p) const
+    {
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(p), _mm_cvttps_epi32(v));
+    }
+    RL_FORCE_INLINE floatN operator +(const floatN& a, const floatN& b) { return floatN(_mm_add_ps(a.v, b.v)); }
+    RL_FORCE_INLINE floatN operator -(const floatN& a, const floatN& b) { return floatN(_mm_sub_ps(a.v, b.v)); }
+    RL_FORCE_INLINE floatN operator *(const floatN& a, const floatN& b) { return floatN(_mm_mul_ps(a.v, b.v)); }
+    RL_FORCE_INLINE floatN operator /(const floatN& a, const floatN& b) { return floatN(_mm_div_ps(a.v, b.v)); }
+    RL_FORCE_INLINE floatN operator -(const floatN& a) { return floatN(_mm_xor_ps(a.v, _mm_set1_ps(-0.0f))); }
+
+    RL_FORCE_INLINE maskN operator < (const floatN& a, const floatN& b) { return maskN(_mm_cmplt_ps (a.v, b.v)); }
+    RL_FORCE_INLINE maskN operator <=(const floatN& a, const floatN& b) { return maskN(_mm_cmple_ps (a.v, b.v)); }
+    RL_FORCE_INLINE maskN operator > (const floatN& a, const floatN& b) { return maskN(_mm_cmpgt_ps (a.v, b.v)); }
+    RL_FORCE_INLINE maskN operator >=(const floatN& a, const floatN& b) { return maskN(_mm_cmpge_ps (a.v, b.v)); }
+    RL_FORCE_INLINE maskN operator ==(const floatN& a, const floatN& b) { return maskN(_mm_cmpeq_ps (a.v, b.v)); }
+    RL_FORCE_INLINE maskN operator !=(const floatN& a, const floatN& b) { return maskN(_mm_cmpneq_ps(a.v, b.v)); }
+
+    RL_FORCE_INLINE maskN operator &(const maskN& a, const maskN& b) { return maskN(_mm_and_ps(a.v, b.v)); }
+    RL_FORCE_INLINE maskN operator |(const maskN& a, const maskN& b) { return maskN(_mm_or_ps(a.v, b.v)); }
+    RL_FORCE_INLINE maskN operator ^(const maskN& a, const maskN& b) { return maskN(_mm_xor_ps(a.v, b.v)); }
+    RL_FORCE_INLINE maskN operator ~(const maskN& a) { return maskN(_mm_xor_ps(a.v, _mm_castsi128_ps(_mm_set1_epi32(-1)))); }
+
+    RL_FORCE_INLINE floatN select(const maskN& m, const floatN& a, const floatN& b)
+    {
+#if defined(RL_SIMD_SSE4_1)
+        return floatN(_mm_blendv_ps(b.v, a.v, m.v));
+#else
+        return floatN(_mm_or_ps(_mm_and_ps(m.v, a.v), _mm_andnot_ps(m.v, b.v)));
+#endif
+    }
+    RL_FORCE_INLINE floatN min (const floatN& a, const floatN& b) { return floatN(_mm_min_ps(a.v, b.v)); }
+    RL_FORCE_INLINE floatN max (const floatN& a, const floatN& b) { return floatN(_mm_max_ps(a.v, b.v)); }
+    RL_FORCE_INLINE floatN abs (const floatN& a) { return floatN(_mm_andnot_ps(_mm_set1_ps(-0.0f), a.v)); }
+    RL_FORCE_INLINE floatN sqrt(const floatN& a) { return floatN(_mm_sqrt_ps(a.v)); }
+    RL_FORCE_INLINE floatN trunc(const floatN& a)
+    {
+#if defined(RL_SIMD_SSE4_1)
+        return floatN(_mm_round_ps(a.v, _MM_FROUND_TO_ZERO | _MM_FROUND_NO_EXC));
+#else
+        // !(|a| < 2^23)ʱaNaN, ֱӱ(Ҳܿcvttpsint32)
+        const auto big = _mm_cmpnlt_ps(_mm_andnot_ps(_mm_set1_ps(-0.0f), a.v), _mm_set1_ps(8388608.0f));
+        const auto t   = _mm_cvtepi32_ps(_mm_cvttps_epi32(a.v));
+        return floatN(_mm_or_ps(_mm_and_ps(big, a.v), _mm_andnot_ps(big, t)));
+#endif
+    }
+    RL_FORCE_INLINE floatN floor(const floatN& a)
+    {
+#if defined(RL_SIMD_SSE4_1)
+        return floatN(_mm_round_ps(a.v, _MM_FROUND_TO_NEG_INF | _MM_FROUND_NO_EXC));
+#else
+        // ضϺalane(ķ)ټ1
+        const auto t = trunc(a);
+        return floatN(_mm_sub_ps(t.v, _mm_and_ps(_mm_cmpgt_ps(t.v, a.v), _mm_set1_ps(1.0f))));
+#endif
+    }
+RL_SIMD_NAMESPACE_END
+#else
+RL_SIMD_NAMESPACE_BEGIN
+    namespace simd_detail
+    {
+        template <typename F>
+        inline floatN laneMap(F f)
+        {
+            floatN r;
+            for(uint32_t i = 0; i < SIMD_LANE_COUNT; ++i)
+                r.v.f[i] = f(i);
+            return r;
+        }
+        template <typename F>
+        inline maskN laneTest(F f)
+        {
+            maskN r;
+            for(uint32_t i = 0; i < SIMD_LANE_COUNT; ++i)
+                r.v.b[i] = f(i);
+            return r;
+        }
+    }
+    inline maskN maskN::fromBits(uint32_t bits)
+    {
+        return simd_detail::laneTest([bits](uint32_t i) { return ((bits >> i) & 1) != 0; });
+    }
+    inline uint32_t maskN::bits() const
+    {
+        uint32_t r = 0;
+        for(uint32_t i = 0; i < SIMD_LANE_COUNT; ++i)
+            r |= uint32_t(v.b[i]) << i;
+        return r;
+    }
+    inline floatN::floatN(float f)
+    {
+        for(auto& e : v.f)
+            e = f;
+    }
+    inline floatN floatN::load(const float* p)
+    {
+        return simd_detail::laneMap([p](uint32_t i) { return p[i]; });
+    }
+    inline floatN floatN::gather(const float* p, uint32_t stride)
+    {
+        return simd_detail::laneMap([p, stride](uint32_t i) { return p[i * stride]; });
+    }
+    inline floatN floatN::gatherIndexed(const float* p, const int32_t indices[SIMD_LANE_COUNT])
+    {
+        return simd_detail::laneMap([p, indices](uint32_t i) { return p[indices[i]]; });
+    }
+    inline void floatN::store(float* p) const
+    {
+        std::memcpy(p, v.f, sizeof(v.f));
+    }
+    inline void floatN::storeInt(int32_t* p) const
+    {
+        for(uint32_t i = 0; i < SIMD_LANE_COUNT; ++i)
+            p[i] = int32_t(v.f[i]);
+    }
+    inline floatN operator +(const floatN& a, const floatN& b) { return simd_detail::laneMap([&](uint32_t i) { return a.v.f[i] + b.v.f[i]; }); }
+    inline floatN operator -(const floatN& a, const floatN& b) { return simd_detail::laneMap([&](uint32_t i) { return a.v.f[i] - b.v.f[i]; }); }
+    inline floatN operator *(const floatN& a, const floatN& b) { return simd_detail::laneMap([&](uint32_t i) { return a.v.f[i] * b.v.f[i]; }); }
+    inline floatN operator /(const floatN& a, const floatN& b) { return simd_detail::laneMap([&](uint32_t i) { return a.v.f[i] / b.v.f[i]; }); }
+    inline floatN operator -(const floatN& a) { return simd_detail::laneMap([&](uint32_t i) { return -a.v.f[i]; }); }
+
+    inline maskN operator < (const floatN& a, const floatN& b) { return simd_detail::laneTest([&](uint32_t i) { return a.v.f[i] <  b.v.f[i]; }); }
+    inline maskN operator <=(const floatN& a, const floatN& b) { return simd_detail::laneTest([&](uint32_t i) { return a.v.f[i] <= b.v.f[i]; }); }
+    inline maskN operator > (const floatN& a, const floatN& b) { return simd_detail::laneTest([&](uint32_t i) { return a.v.f[i] >  b.v.f[i]; }); }
+    inline maskN operator >=(const floatN& a, const floatN& b) { return simd_detail::laneTest([&](uint32_t i) { return a.v.f[i] >= b.v.f[i]; }); }
+    inline maskN operator ==(const floatN& a, const floatN& b) { return simd_detail::laneTest([&](uint32_t i) { return a.v.f[i] == b.v.f[i]; }); }
+    inline maskN operator !=(const floatN& a, const floatN& b) { return simd_detail::laneTest([&](uint32_t i) { return a.v.f[i] != b.v.f[i]; }); }
+
+    inline maskN operator &(const maskN& a, const maskN& b) { return simd_detail::laneTest([&](uint32_t i) { return a.v.b[i] && b.v.b[i]; }); }
+    inline maskN operator |(const maskN& a, const maskN& b) { return simd_detail::laneTest([&](uint32_t i) { return a.v.b[i] || b.v.b[i]; }); }
+    inline maskN operator ^(const maskN& a, const maskN& b) { return simd_detail::laneTest([&](uint32_t i) { return a.v.b[i] != b.v.b[i]; }); }
+    inline maskN operator ~(const maskN& a) { return simd_detail::laneTest([&](uint32_t i) { return !a.v.b[i]; }); }
+
+    inline floatN select(const maskN& m, const floatN& a, const floatN& b) { return simd_detail::laneMap([&](uint32_t i) { return m.v.b[i] ? a.v.f[i] : b.v.f[i]; }); }
+    inline floatN min (const floatN& a, const floatN& b) { return simd_detail::laneMap([&](uint32_t i) { return a.v.f[i] < b.v.f[i] ? a.v.f[i] : b.v.f[i]; }); }
+    inline floatN max (const floatN& a, const floatN& b) { return simd_detail::laneMap([&](uint32_t i) { return a.v.f[i] > b.v.f[i] ? a.v.f[i] : b.v.f[i]; }); }
+    inline floatN abs (const floatN& a) { return simd_detail::laneMap([&](uint32_t i) { return simd_detail::absRef(a.v.f[i]); }); }
+    inline floatN sqrt(const floatN& a) { return simd_detail::laneMap([&](uint32_t i) { return simd_detail::sqrtRef(a.v.f[i]); }); }
+    inline floatN trunc(const floatN& a) { return simd_detail::laneMap([&](uint32_t i) { return simd_detail::truncRef(a.v.f[i]); }); }
+    inline floatN floor(const floatN& a) { return simd_detail::laneMap([&](uint32_t i) { return simd_detail::floorRef(a.v.f[i]); }); }
+RL_SIMD_NAMESPACE_END
+#endif
+RL_SIMD_NAMESPACE_BEGIN
+    // ISA޹صĲ
+    inline float floatN::lane(uint32_t i) const
+    {
+        assert(i < SIMD_LANE_COUNT);
+        float lanes[SIMD_LANE_COUNT];
+        this->store(lanes);
+        return lanes[i];
+    }
+    inline void floatN::setLane(uint32_t i, float f)
+    {
+        assert(i < SIMD_LANE_COUNT);
+        float lanes[SIMD_LANE_COUNT];
+        this->store(lanes);
+        lanes[i] = f;
+        *this = floatN::load(lanes);
+    }
+    inline floatN& operator +=(floatN& a, const floatN& b) { return a = a + b; }
+    inline floatN& operator -=(floatN& a, const floatN& b) { return a = a - b; }
+    inline floatN& operator *=(floatN& a, const floatN& b) { return a = a * b; }
+    inline floatN& operator /=(floatN& a, const floatN& b) { return a = a / b; }
+    inline bool any(const maskN& m)
+    {
+        return m.bits() != 0;
+    }
+    inline bool all(const maskN& m)
+    {
+        return m.bits() == (1u << SIMD_LANE_COUNT) - 1;
+    }
+RL_SIMD_NAMESPACE_END
 #endif //RASLITE_SIMD_H
\ No newline at end of file
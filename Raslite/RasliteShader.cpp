@@ -1,107 +1,1006 @@
 #include "RasliteShader.h"
+#include "RasliteBC.h"
+#include "RasliteVirtualTexture.h"
+#include "RasliteSIMD.h"
+#include "RasliteKernels.h"
+#include <algorithm>
+#include <type_traits>
+#include <utility>
 
 namespace rl {
-    class Sampler
+    namespace detail 
     {
-    private:
-        static Float mapTextureCoordinate(AddressMode am, Float x)
+        // һmip levelֻͼ
+        struct MipView
+        {
+            const Float* data;
+            int32_t      width;
+            int32_t      height;
+            uint32_t     pitch;  // in Floats; ѹʽʱΪblock
+            uint32_t     version;
+        };
+        // VirtualTextureһmip level: texelpage tableȡ
+        struct VirtualMipView
+        {
+            const VirtualTexture* texture;
+            uint32_t              level;
+            int32_t               width;
+            int32_t               height;
+        };
+        // Formatչtexelȡ, ȱʡΪ(0,0,0,1)
+        template <uint32_t N> SIMDFloat4_t loadTexel(const Float* p);
+        template <> inline SIMDFloat4_t loadTexel<1>(const Float* p) { return simd::setW(SIMDFloat4::loaduX(p), 1.0f); }
+        template <> inline SIMDFloat4_t loadTexel<2>(const Float* p) { return simd::setW(SIMDFloat4::loaduXY(p), 1.0f); }
+        template <> inline SIMDFloat4_t loadTexel<3>(const Float* p) { return simd::setW(SIMDFloat4::loaduXYZ(p), 1.0f); }
+        template <> inline SIMDFloat4_t loadTexel<4>(const Float* p) { return SIMDFloat4::loadu(p); }
+        template <uint32_t N> struct LinearTexelFetch
+        {
+            static SIMDFloat4_t load(const MipView& mip, int32_t x, int32_t y)
+            {
+                return loadTexel<N>(mip.data + y * mip.pitch + x * N);
+            }
+            static SIMDFloat4_t load(const VirtualMipView& mip, int32_t x, int32_t y)
+            {
+                return loadTexel<N>(mip.texture->getTexel(mip.level, x, y));
+            }
+        };
+        template <Format F> struct TexelFetch;
+        template <> struct TexelFetch<Format::R32_FLOAT>:          LinearTexelFetch<1> {};
+        template <> struct TexelFetch<Format::R32G32_FLOAT>:       LinearTexelFetch<2> {};
+        template <> struct TexelFetch<Format::R32G32B32_FLOAT>:    LinearTexelFetch<3> {};
+        template <> struct TexelFetch<Format::R32G32B32A32_FLOAT>: LinearTexelFetch<4> {};
+        // floatʽķ; ʽΪ0, ܽKernels::sampleFloat
+        template <Format F>
+        constexpr uint32_t floatChannels()
+        {
+            return F == Format::R32_FLOAT          ? 1 :
+                   F == Format::R32G32_FLOAT       ? 2 :
+                   F == Format::R32G32B32_FLOAT    ? 3 :
+                   F == Format::R32G32B32A32_FLOAT ? 4 : 0;
+        }
+        // ѹʽ: texelڵblock, ÿ̵߳DecodedBlockCache
+        template <Format F, uint32_t BLOCK_BYTES> struct BlockTexelFetch
+        {
+            static SIMDFloat4_t load(const MipView& mip, int32_t x, int32_t y)
+            {
+                const auto block  = reinterpret_cast<const uint8_t*>(mip.data + (y >> 2) * mip.pitch) + (x >> 2) * BLOCK_BYTES;
+                const auto texels = DecodedBlockCache::local().fetch(F, block, mip.version);
+                return SIMDFloat4::loadu(&texels[(y & 3) * 4 + (x & 3)].x);
+            }
+        };
+        template <> struct TexelFetch<Format::BC1_UNORM>: BlockTexelFetch<Format::BC1_UNORM, 8>  {};
+        template <> struct TexelFetch<Format::BC3_UNORM>: BlockTexelFetch<Format::BC3_UNORM, 16> {};
+        template <> struct TexelFetch<Format::BC7_UNORM>: BlockTexelFetch<Format::BC7_UNORM, 16> {};
+        // 8-bit UNORM: ȡʱתΪFloatٲfilter; sRGBrgbɲұתԿռ
+        template <uint32_t N, bool SRGB> struct Unorm8TexelFetch
+        {
+            static SIMDFloat4_t load(const MipView& mip, int32_t x, int32_t y)
+            {
+                const auto p = reinterpret_cast<const uint8_t*>(mip.data + y * mip.pitch) + x * N;
+                const auto k = Float(1) / Float(255);
+                if constexpr(SRGB)
+                {
+                    const auto lut = srgb_to_linear_table();
+                    return SIMDFloat4::set(lut[p[0]], lut[p[1]], lut[p[2]], p[3] * k);
+                }
+                else if constexpr(N == 4)
+                    return simd::mul(SIMDFloat4::set(p[0], p[1], p[2], p[3]), k);
+                else if constexpr(N == 2)
+                    return SIMDFloat4::set(p[0] * k, p[1] * k, 0, 1);
+                else
+                    return SIMDFloat4::set(p[0] * k, 0, 0, 1);
+            }
+        };
+        template <> struct TexelFetch<Format::R8_UNORM>:            Unorm8TexelFetch<1, false> {};
+        template <> struct TexelFetch<Format::R8G8_UNORM>:          Unorm8TexelFetch<2, false> {};
+        template <> struct TexelFetch<Format::R8G8B8A8_UNORM>:      Unorm8TexelFetch<4, false> {};
+        template <> struct TexelFetch<Format::R8G8B8A8_UNORM_SRGB>: Unorm8TexelFetch<4, true>  {};
+        // texelѰַ, -1ʾBORDER֮
+        template <AddressMode AM>
+        inline int32_t addressTexel(int32_t i, int32_t size)
+        {
+            if(0 <= i && i < size)
+                return i;
+            if constexpr(AM == AddressMode::WRAP)
+            {
+                i %= size;
+                return i < 0 ? i + size : i;
+            }
+            else if constexpr(AM == AddressMode::MIRROR)
+            {
+                const auto period = size * 2;
+                i %= period;
+                if(i < 0)
+                    i += period;
+                return i < size ? i : period - 1 - i;
+            }
+            else if constexpr(AM == AddressMode::CLAMP)
+                return i < 0 ? 0 : size - 1;
+            else if constexpr(AM == AddressMode::BORDER)
+                return -1;
+            else
+            {
+                static_assert(AM == AddressMode::MIRROR_ONCE, "ǷAddressMode!");
+                if(i < 0)
+                    i = -1 - i;
+                return std::min(i, size - 1);
+            }
+        }
+        inline int32_t addressTexel(AddressMode am, int32_t i, int32_t size)
         {
-            assert(x >= 0);
             switch(am)
             {
             case AddressMode::WRAP:
-                return x - floori(x);
-                break;
+                return addressTexel<AddressMode::WRAP>(i, size);
+            case AddressMode::MIRROR:
+                return addressTexel<AddressMode::MIRROR>(i, size);
             case AddressMode::CLAMP:
-                return saturate(x);
-                break;
+                return addressTexel<AddressMode::CLAMP>(i, size);
+            case AddressMode::BORDER:
+                return addressTexel<AddressMode::BORDER>(i, size);
+            case AddressMode::MIRROR_ONCE:
+                return addressTexel<AddressMode::MIRROR_ONCE>(i, size);
             default:
-                assert(false);
+                assert(false && "ǷAddressMode!");
+                return 0;
             }
-            return Float(0);
         }
-    public:
-        static Vec4 load(const Texture2D& tex,uint32_t location, int offset, int sampleIndex)
+        // Ѱַ: addressUaddressVͬʱڱȷ, ʱSamplerStateѰַ
+        template <AddressMode AM> struct FixedAddress
         {
-            return Vec4::zero();
+            static constexpr bool HAS_BORDER = AM == AddressMode::BORDER;
+            static int32_t u(const SamplerState&, int32_t i, int32_t size) { return addressTexel<AM>(i, size); }
+            static int32_t v(const SamplerState&, int32_t i, int32_t size) { return addressTexel<AM>(i, size); }
+        };
+        struct DynamicAddress
+        {
+            static constexpr bool HAS_BORDER = true;
+            static int32_t u(const SamplerState& ss, int32_t i, int32_t size) { return addressTexel(ss.addressU, i, size); }
+            static int32_t v(const SamplerState& ss, int32_t i, int32_t size) { return addressTexel(ss.addressV, i, size); }
+        };
+        // 0: DynamicAddress; ΪAddressModeֵ
+        template <uint32_t K>
+        using AddressPolicy = std::conditional_t<K == 0, DynamicAddress, FixedAddress<AddressMode(K == 0 ? 1 : K)>>;
+        // Ƚϲ: ref OP texelΪ1, Ϊ0 (D3Dһ, ref)
+        template <CmpFunc CMP>
+        inline SIMDFloat4_t compare(SIMDFloat4P_t ref, SIMDFloat4P_t texels)
+        {
+            if constexpr(CMP == CmpFunc::NEVER)
+                return SIMDFloat4::zero();
+            else if constexpr(CMP == CmpFunc::LESS)
+                return simd::less(ref, texels);
+            else if constexpr(CMP == CmpFunc::EQUAL)
+                return simd::equal(ref, texels);
+            else if constexpr(CMP == CmpFunc::LESS_EQUAL)
+                return simd::lessEqual(ref, texels);
+            else if constexpr(CMP == CmpFunc::GREATER)
+                return simd::greater(ref, texels);
+            else if constexpr(CMP == CmpFunc::NOT_EQUAL)
+                return simd::notEqual(ref, texels);
+            else if constexpr(CMP == CmpFunc::GREATER_EQUAL)
+                return simd::greaterEqual(ref, texels);
+            else
+                return SIMDFloat4::one();
         }
-        static Vec4 sample(const Texture2D& tex,const SamplerState& ss, const Vec2& location, const Vec2i& offset)
+        inline Vec4 toVec4(SIMDFloat4P_t v)
         {
-            // Normalized Texture CoordinateתΪTexel Coordinate
-            auto texelU = Sampler::mapTextureCoordinate(ss.addressU, location.u) * tex.getWidth();
-            auto texelV = Sampler::mapTextureCoordinate(ss.addressV, location.v) * tex.getHeight();
-            //
-            switch(ss.filter)
+            Vec4 r;
+            simd::storeu(v, &r.x);
+            return r;
+        }
+    }
+    // setSamplerStateʱSamplerStateõ: filteraddress modeػĲ, TextureͺFormat
+    struct CompiledSamplerState
+    {
+        static constexpr uint32_t FORMAT_SLOT_COUNT = uint32_t(Format::R8G8B8A8_UNORM_SRGB) + 1;
+        // lod: δSamplerState::mipLodBias, δclamp
+        using SampleFn  = Vec4 (*)(const Texture& tex, const SamplerState& ss, const Vec2& location, Float lod, const Vec2i& offset);
+        // 4/8 lane汾: maskĵiλΪ0lane
+        using SampleFn4 = void (*)(const Texture& tex, const SamplerState& ss, const Vec2 locations[4], const Float lods[4], const Vec2i& offset, uint32_t mask, Vec4 out[4]);
+        using SampleFn8 = void (*)(const Texture& tex, const SamplerState& ss, const Vec2 locations[8], const Float lods[8], const Vec2i& offset, uint32_t mask, Vec4 out[8]);
+
+        SampleFn  texture2D      [FORMAT_SLOT_COUNT];
+        SampleFn  virtualTexture [FORMAT_SLOT_COUNT];
+        SampleFn4 texture2D4     [FORMAT_SLOT_COUNT];
+        SampleFn4 virtualTexture4[FORMAT_SLOT_COUNT];
+        SampleFn8 texture2D8     [FORMAT_SLOT_COUNT];
+        SampleFn8 virtualTexture8[FORMAT_SLOT_COUNT];
+
+        SampleFn get(const Texture& tex) const
+        {
+            if(tex.getType() == TextureType::VIRTUAL_TEXTURE_2D)
+                return virtualTexture[uint32_t(static_cast<const VirtualTexture&>(tex).getFormat())];
+            return texture2D[uint32_t(static_cast<const Texture2D&>(tex).getFormat())];
+        }
+        SampleFn4 get4(const Texture& tex) const
+        {
+            if(tex.getType() == TextureType::VIRTUAL_TEXTURE_2D)
+                return virtualTexture4[uint32_t(static_cast<const VirtualTexture&>(tex).getFormat())];
+            return texture2D4[uint32_t(static_cast<const Texture2D&>(tex).getFormat())];
+        }
+        SampleFn8 get8(const Texture& tex) const
+        {
+            if(tex.getType() == TextureType::VIRTUAL_TEXTURE_2D)
+                return virtualTexture8[uint32_t(static_cast<const VirtualTexture&>(tex).getFormat())];
+            return texture2D8[uint32_t(static_cast<const Texture2D&>(tex).getFormat())];
+        }
+        // L: 48; ˻Ϊָ, SampleFn4SampleFn8ͬһ
+        template <uint32_t L>
+        SampleFn4 getN(const Texture& tex) const
+        {
+            static_assert(std::is_same<SampleFn4, SampleFn8>::value, "");
+            static_assert(L == 4 || L == 8, "ֻ4/8 lane汾!");
+            return L == 4 ? this->get4(tex) : this->get8(tex);
+        }
+    };
+    class Sampler
+    {
+    private:
+        // View: detail::MipViewdetail::VirtualMipView; A: detail::FixedAddressdetail::DynamicAddress
+        template <Format F, typename A, typename View>
+        static SIMDFloat4_t fetch(const View& mip, const SamplerState& ss, int32_t x, int32_t y)
+        {
+            const auto ax = A::u(ss, x, mip.width);
+            const auto ay = A::v(ss, y, mip.height);
+            if(A::HAS_BORDER && (ax | ay) < 0)
+                return SIMDFloat4::loadu(&ss.borderColor.x);
+            return detail::TexelFetch<F>::load(mip, ax, ay);
+        }
+        template <Format F, typename A, typename View>
+        static SIMDFloat4_t samplePoint(const View& mip, const SamplerState& ss, const Vec2& location, const Vec2i& offset)
+        {
+            const auto x = int32_t(std::floor(location.u * mip.width))  + offset.x;
+            const auto y = int32_t(std::floor(location.v * mip.height)) + offset.y;
+            return Sampler::fetch<F, A>(mip, ss, x, y);
+        }
+        template <Format F, typename A, typename View>
+        static SIMDFloat4_t sampleBilinear(const View& mip, const SamplerState& ss, const Vec2& location, const Vec2i& offset)
+        {
+            // texelλ+0.5
+            const auto x  = location.u * mip.width  - Float(0.5);
+            const auto y  = location.v * mip.height - Float(0.5);
+            const auto xf = std::floor(x), yf = std::floor(y);
+            const auto fx = x - xf, fy = y - yf;
+            const auto x0 = int32_t(xf) + offset.x, y0 = int32_t(yf) + offset.y;
+
+            const auto top    = simd::lerp(Sampler::fetch<F, A>(mip, ss, x0, y0),     Sampler::fetch<F, A>(mip, ss, x0 + 1, y0),     fx);
+            const auto bottom = simd::lerp(Sampler::fetch<F, A>(mip, ss, x0, y0 + 1), Sampler::fetch<F, A>(mip, ss, x0 + 1, y0 + 1), fx);
+            return simd::lerp(top, bottom, fy);
+        }
+        static detail::MipView mipView(const Texture2D& tex, uint32_t level)
+        {
+            const auto surf = tex.getMipSurface(level);
+            return { surf->getData(), int32_t(surf->getWidth()), int32_t(surf->getHeight()), surf->getPitch(), surf->getVersion() };
+        }
+        static detail::VirtualMipView mipView(const VirtualTexture& tex, uint32_t level)
+        {
+            return { &tex, level, int32_t(tex.getWidth(level)), int32_t(tex.getHeight(level)) };
+        }
+        template <Format F, typename A, bool LINEAR, typename Tex>
+        static SIMDFloat4_t sampleMip(const Tex& tex, const SamplerState& ss, uint32_t level, const Vec2& location, const Vec2i& offset)
+        {
+            const auto mip = Sampler::mipView(tex, level);
+            if constexpr(LINEAR)
+                return Sampler::sampleBilinear<F, A>(mip, ss, location, offset);
+            else
+                return Sampler::samplePoint<F, A>(mip, ss, location, offset);
+        }
+        // FILTER: MAG_LINEAR(4) | MIN_LINEAR(2) | MIP_LINEAR(1)
+        // lod: δbias, δclamp; Tex: Texture2DVirtualTexture
+        template <Format F, typename A, uint32_t FILTER, typename Tex>
+        static Vec4 sampleLod(const Tex& tex, const SamplerState& ss, const Vec2& location, Float lod, const Vec2i& offset)
+        {
+            constexpr bool MAG_LINEAR = (FILTER & 4) != 0, MIN_LINEAR = (FILTER & 2) != 0, MIP_LINEAR = (FILTER & 1) != 0;
+            lod = clamp(lod + ss.mipLodBias, ss.minLod, ss.maxLod);
+            // Ŵ: ֻlevel 0
+            if(!(lod > Float(0)))
+                return detail::toVec4(Sampler::sampleMip<F, A, MAG_LINEAR>(tex, ss, 0, location, offset));
+
+            const auto maxLevel = tex.getMipLevel() - 1;
+            lod = std::min(lod, Float(maxLevel));
+            if constexpr(!MIP_LINEAR)
+            {
+                const auto level = std::min(uint32_t(lod + Float(0.5)), maxLevel);
+                return detail::toVec4(Sampler::sampleMip<F, A, MIN_LINEAR>(tex, ss, level, location, offset));
+            }
+            else
+            {
+                // : mipֵ֮
+                const auto level0 = uint32_t(lod);
+                const auto t      = lod - Float(level0);
+                const auto c0     = Sampler::sampleMip<F, A, MIN_LINEAR>(tex, ss, level0, location, offset);
+                if(level0 >= maxLevel || t == Float(0))
+                    return detail::toVec4(c0);
+                const auto c1 = Sampler::sampleMip<F, A, MIN_LINEAR>(tex, ss, level0 + 1, location, offset);
+                return detail::toVec4(simd::lerp(c0, c1, t));
+            }
+        }
+        // floatʽTexture2D, Чlanelevelfilterͬʱ()Kernels::sampleFloat:
+        // floatNһδlane, texelgatherȡ; falseʾ, ɵlane
+        template <uint32_t L, Format F>
+        static bool sampleMipKernel(const Texture2D& tex, const SamplerState& ss, const uint32_t levels[L], uint32_t linearMask,
+                                    const Vec2 locations[L], const Vec2i& offset, uint32_t mask, SIMDFloat4_t out[L])
+        {
+            if(!mask)
+                return false;
+            uint32_t first = 0;
+            while(!(mask & (1u << first)))
+                ++first;
+            const bool linear = (linearMask & (1u << first)) != 0;
+            Float u[L], v[L];
+            for(uint32_t i = 0; i < L; ++i)
+            {
+                if(!(mask & (1u << i)))
+                {
+                    u[i] = v[i] = 0; // Чlaneδʼ
+                    continue;
+                }
+                if(levels[i] != levels[first] || ((linearMask & (1u << i)) != 0) != linear)
+                    return false;
+                u[i] = locations[i].u;
+                v[i] = locations[i].v;
+            }
+            const auto view = Sampler::mipView(tex, levels[first]);
+            SampleMip mip;
+            {
+                mip.data     = view.data;
+                mip.width    = view.width;
+                mip.height   = view.height;
+                mip.pitch    = view.pitch;
+                mip.channels = detail::floatChannels<F>();
+                mip.addressU = uint32_t(ss.addressU);
+                mip.addressV = uint32_t(ss.addressV);
+                mip.offsetX  = offset.x;
+                mip.offsetY  = offset.y;
+                ss.borderColor.copyTo(mip.borderColor, 4);
+            }
+            Float texels[4 * L]; // SoA
+            kernels().sampleFloat(mip, u, v, L, linear, texels);
+            for(uint32_t i = 0; i < L; ++i)
+            {
+                if(mask & (1u << i))
+                    out[i] = SIMDFloat4::set(texels[i], texels[L + i], texels[2 * L + i], texels[3 * L + i]);
+            }
+            return true;
+        }
+        // 4 laneڸԵlevelϲ: ȨذSoAһ, texellaneȡ
+        // linearMaskĵiλ: lane ibilinear, point; AͬsampleLod
+        template <Format F, typename A, typename Tex>
+        static void sampleMip4(const Tex& tex, const SamplerState& ss, const uint32_t levels[4], uint32_t linearMask,
+                               const Vec2 locations[4], const Vec2i& offset, uint32_t mask, SIMDFloat4_t out[4])
+        {
+            using View = decltype(Sampler::mipView(tex, 0));
+            // ͬһlaneͨͬһmip, ֻlevel仯ʱȡview
+            View views[4];
+            View view = {};
+            auto viewLevel = ~0u;
+            alignas(16) Float sizes[2][4], halves[4];
+            for(uint32_t i = 0; i < 4; ++i)
+            {
+                if((mask & (1u << i)) && levels[i] != viewLevel)
+                {
+                    view      = Sampler::mipView(tex, levels[i]);
+                    viewLevel = levels[i];
+                }
+                views[i] = view; // Чlaneǰһview, ᱻȡ
+                sizes[0][i] = Float(views[i].width);
+                sizes[1][i] = Float(views[i].height);
+                halves[i]   = (linearMask & (1u << i)) ? Float(0.5) : Float(0); // bilinearʱtexelλ+0.5
+            }
+            const auto half = SIMDFloat4::load(halves);
+            const auto x  = simd::sub(simd::mul(SIMDFloat4::set(locations[0].u, locations[1].u, locations[2].u, locations[3].u), SIMDFloat4::load(sizes[0])), half);
+            const auto y  = simd::sub(simd::mul(SIMDFloat4::set(locations[0].v, locations[1].v, locations[2].v, locations[3].v), SIMDFloat4::load(sizes[1])), half);
+            const auto xf = simd::floor(x), yf = simd::floor(y);
+            alignas(16) int32_t xi[4], yi[4];
+            alignas(16) Float   fx[4], fy[4];
+            simd::storeuInt(xf, xi);
+            simd::storeuInt(yf, yi);
+            simd::store(simd::sub(x, xf), fx);
+            simd::store(simd::sub(y, yf), fy);
+            for(uint32_t i = 0; i < 4; ++i)
             {
-            case FilterType::MIN_MAG_MIP_POINT:
+                if(!(mask & (1u << i)))
+                    continue;
+                const auto x0 = xi[i] + offset.x, y0 = yi[i] + offset.y;
+                if(!(linearMask & (1u << i)))
                 {
-                    auto addrU = clamp<uint32_t>(floorui(texelU) + offset.u, 0, tex.getWidth()  - 1);
-                    auto addrV = clamp<uint32_t>(floorui(texelV) + offset.v, 0, tex.getHeight() - 1);
-                    return tex.getMipSurface(0)->getElement(addrU, addrV);
+                    out[i] = Sampler::fetch<F, A>(views[i], ss, x0, y0);
+                    continue;
                 }
-                break;
-            case FilterType::MIN_MAG_POINT_MIP_LINEAR:
-                assert(false&&"ʵ");
-                break;
-            case FilterType::MIN_POINT_MAG_LINEAR_MIP_POINT:
-                assert(false&&"ʵ");
-                break;
-            case FilterType::MIN_POINT_MAG_MIP_LINEAR:
-                assert(false&&"ʵ");
-                break;
-            case FilterType::MIN_LINEAR_MAG_MIP_POINT:
-                assert(false&&"ʵ");
-                break;
-            case FilterType::MIN_LINEAR_MAG_POINT_MIP_LINEAR:
-                assert(false&&"ʵ");
-                break;
-            case FilterType::MIN_MAG_LINEAR_MIP_POINT:
-                assert(false&&"ʵ");
-                break;
-            case FilterType::MIN_MAG_MIP_LINEAR:
-                assert(false&&"ʵ");
-                break;
-            case FilterType::ANISOTROPIC:
-                assert(false&&"ʵ");
-                break;
+                const auto top    = simd::lerp(Sampler::fetch<F, A>(views[i], ss, x0, y0),     Sampler::fetch<F, A>(views[i], ss, x0 + 1, y0),     fx[i]);
+                const auto bottom = simd::lerp(Sampler::fetch<F, A>(views[i], ss, x0, y0 + 1), Sampler::fetch<F, A>(views[i], ss, x0 + 1, y0 + 1), fx[i]);
+                out[i] = simd::lerp(top, bottom, fy[i]);
             }
+        }
+        // L(48) laneڸԵlevelϲ: ܽKernels::sampleFloatʱһδȫlane, ÿ4lanesampleMip4
+        template <uint32_t L, Format F, typename A, typename Tex>
+        static void sampleMipN(const Tex& tex, const SamplerState& ss, const uint32_t levels[L], uint32_t linearMask,
+                               const Vec2 locations[L], const Vec2i& offset, uint32_t mask, SIMDFloat4_t out[L])
+        {
+            static_assert(L % 4 == 0, "laneΪ4ı!");
+            if constexpr(std::is_same<Tex, Texture2D>::value && detail::floatChannels<F>() > 0)
+            {
+                if(Sampler::sampleMipKernel<L, F>(tex, ss, levels, linearMask, locations, offset, mask, out))
+                    return;
+            }
+            for(uint32_t g = 0; g < L; g += 4)
+            {
+                const auto groupMask = (mask >> g) & 0xF;
+                if(groupMask)
+                    Sampler::sampleMip4<F, A>(tex, ss, levels + g, linearMask >> g, locations + g, offset, groupMask, out + g);
+            }
+        }
+        // sampleLodL lane汾: FILTERlodͬ, Llaneһη
+        template <uint32_t L, Format F, typename A, uint32_t FILTER, typename Tex>
+        static void sampleLodN(const Tex& tex, const SamplerState& ss, const Vec2 locations[L], const Float lods[L], const Vec2i& offset, uint32_t mask, Vec4 out[L])
+        {
+            constexpr bool MAG_LINEAR = (FILTER & 4) != 0, MIN_LINEAR = (FILTER & 2) != 0, MIP_LINEAR = (FILTER & 1) != 0;
+            const auto maxLevel = tex.getMipLevel() - 1;
 
-            return Vec4::zero();
+            uint32_t levels0[L] = { 0 }, levels1[L] = { 0 };
+            alignas(16) Float t[L] = { 0 };
+            uint32_t linearMask = 0, trilinearMask = 0;
+            for(uint32_t i = 0; i < L; ++i)
+            {
+                if(!(mask & (1u << i)))
+                    continue;
+                auto lod = clamp(lods[i] + ss.mipLodBias, ss.minLod, ss.maxLod);
+                if(!(lod > Float(0)))
+                {
+                    linearMask |= MAG_LINEAR ? (1u << i) : 0;
+                    continue;
+                }
+                linearMask |= MIN_LINEAR ? (1u << i) : 0;
+                lod = std::min(lod, Float(maxLevel));
+                if constexpr(!MIP_LINEAR)
+                {
+                    levels0[i] = std::min(uint32_t(lod + Float(0.5)), maxLevel);
+                    continue;
+                }
+                levels0[i] = uint32_t(lod);
+                t[i]       = lod - Float(levels0[i]);
+                if(levels0[i] < maxLevel && t[i] != Float(0))
+                {
+                    levels1[i] = levels0[i] + 1;
+                    trilinearMask |= 1u << i;
+                }
+            }
+            SIMDFloat4_t c0[L], c1[L];
+            Sampler::sampleMipN<L, F, A>(tex, ss, levels0, linearMask, locations, offset, mask, c0);
+            if(trilinearMask)
+                Sampler::sampleMipN<L, F, A>(tex, ss, levels1, linearMask, locations, offset, trilinearMask, c1);
+            for(uint32_t i = 0; i < L; ++i)
+            {
+                if(mask & (1u << i))
+                    out[i] = detail::toVec4((trilinearMask & (1u << i)) ? simd::lerp(c0[i], c1[i], t[i]) : c0[i]);
+            }
         }
-        static Vec4 sampleGrad(const Texture2D& tex,const SamplerState& ss, const Vec2& location, Float ddx, Float ddy, const Vec2i& offset)
+        // TextureͺFormatֻһ, ֮filter·ػ
+        // fn(tex, std::integral_constant<Format, F>()), texΪTexture2DVirtualTexture
+        template <typename Fn>
+        static void dispatch(const Texture& texture, Fn&& fn)
         {
-            return Vec4::zero();
+            if(texture.getType() == TextureType::VIRTUAL_TEXTURE_2D)
+            {
+                auto& tex = static_cast<const VirtualTexture&>(texture);
+                switch(tex.getFormat())
+                {
+                case Format::R32_FLOAT:
+                    return fn(tex, std::integral_constant<Format, Format::R32_FLOAT>());
+                case Format::R32G32_FLOAT:
+                    return fn(tex, std::integral_constant<Format, Format::R32G32_FLOAT>());
+                case Format::R32G32B32_FLOAT:
+                    return fn(tex, std::integral_constant<Format, Format::R32G32B32_FLOAT>());
+                case Format::R32G32B32A32_FLOAT:
+                    return fn(tex, std::integral_constant<Format, Format::R32G32B32A32_FLOAT>());
+                default:
+                    assert(false && "֧!");
+                    return;
+                }
+            }
+            assert(texture.getType() == TextureType::TEXTURE_2D && "֧!");
+            auto& tex = static_cast<const Texture2D&>(texture);
+            switch(tex.getFormat())
+            {
+            case Format::R32_FLOAT:
+                return fn(tex, std::integral_constant<Format, Format::R32_FLOAT>());
+            case Format::R32G32_FLOAT:
+                return fn(tex, std::integral_constant<Format, Format::R32G32_FLOAT>());
+            case Format::R32G32B32_FLOAT:
+                return fn(tex, std::integral_constant<Format, Format::R32G32B32_FLOAT>());
+            case Format::R32G32B32A32_FLOAT:
+                return fn(tex, std::integral_constant<Format, Format::R32G32B32A32_FLOAT>());
+            case Format::BC1_UNORM:
+                return fn(tex, std::integral_constant<Format, Format::BC1_UNORM>());
+            case Format::BC3_UNORM:
+                return fn(tex, std::integral_constant<Format, Format::BC3_UNORM>());
+            case Format::BC7_UNORM:
+                return fn(tex, std::integral_constant<Format, Format::BC7_UNORM>());
+            case Format::R8_UNORM:
+                return fn(tex, std::integral_constant<Format, Format::R8_UNORM>());
+            case Format::R8G8_UNORM:
+                return fn(tex, std::integral_constant<Format, Format::R8G8_UNORM>());
+            case Format::R8G8B8A8_UNORM:
+                return fn(tex, std::integral_constant<Format, Format::R8G8B8A8_UNORM>());
+            case Format::R8G8B8A8_UNORM_SRGB:
+                return fn(tex, std::integral_constant<Format, Format::R8G8B8A8_UNORM_SRGB>());
+            default:
+                assert(false && "֧!");
+                return;
+            }
+        }
+        template <Format F, typename Tex, typename A, uint32_t FILTER>
+        static Vec4 sampleCompiled(const Texture& tex, const SamplerState& ss, const Vec2& location, Float lod, const Vec2i& offset)
+        {
+            return Sampler::sampleLod<F, A, FILTER>(static_cast<const Tex&>(tex), ss, location, lod, offset);
+        }
+        template <uint32_t L, Format F, typename Tex, typename A, uint32_t FILTER>
+        static void sampleCompiledN(const Texture& tex, const SamplerState& ss, const Vec2 locations[L], const Float lods[L], const Vec2i& offset, uint32_t mask, Vec4 out[L])
+        {
+            Sampler::sampleLodN<L, F, A, FILTER>(static_cast<const Tex&>(tex), ss, locations, lods, offset, mask, out);
         }
-        static Vec4 sampleBias(const Texture2D& tex,const SamplerState& ss, const Vec2& location, Float lod, const Vec2i& offset)
+        static Vec4 sampleUnsupported(const Texture& tex, const SamplerState& ss, const Vec2& location, Float lod, const Vec2i& offset)
         {
+            assert(false && "֧!");
             return Vec4::zero();
         }
-        static Vec4 sampleCmp(const Texture2D& tex,const SamplerState& ss, const Vec2& location, Float cmpValue, const Vec2i& offset)
+        template <uint32_t L>
+        static void sampleUnsupportedN(const Texture& tex, const SamplerState& ss, const Vec2 locations[L], const Float lods[L], const Vec2i& offset, uint32_t mask, Vec4 out[L])
+        {
+            assert(false && "֧!");
+        }
+        // һ(Ѱַ, FILTER)ϵĺ, Formatֵ
+        template <typename A, uint32_t FILTER>
+        static const CompiledSamplerState* compiledTable()
+        {
+            static_assert(uint32_t(Format::R8G8B8A8_UNORM_SRGB) + 1 == CompiledSamplerState::FORMAT_SLOT_COUNT, "Formatıͬ˱!");
+            static const CompiledSamplerState table =
+            {
+                {
+                    &Sampler::sampleCompiled<Format::R32_FLOAT,          Texture2D, A, FILTER>,
+                    &Sampler::sampleCompiled<Format::R32G32_FLOAT,       Texture2D, A, FILTER>,
+                    &Sampler::sampleCompiled<Format::R32G32B32_FLOAT,    Texture2D, A, FILTER>,
+                    &Sampler::sampleCompiled<Format::R32G32B32A32_FLOAT, Texture2D, A, FILTER>,
+                    &Sampler::sampleUnsupported, // R16_UINT
+                    &Sampler::sampleUnsupported, // R16_SINT
+                    &Sampler::sampleUnsupported, // R32_UINT
+                    &Sampler::sampleUnsupported, // R32_SINT
+                    &Sampler::sampleCompiled<Format::BC1_UNORM, Texture2D, A, FILTER>,
+                    &Sampler::sampleCompiled<Format::BC3_UNORM, Texture2D, A, FILTER>,
+                    &Sampler::sampleCompiled<Format::BC7_UNORM, Texture2D, A, FILTER>,
+                    &Sampler::sampleCompiled<Format::R8_UNORM,            Texture2D, A, FILTER>,
+                    &Sampler::sampleCompiled<Format::R8G8_UNORM,          Texture2D, A, FILTER>,
+                    &Sampler::sampleCompiled<Format::R8G8B8A8_UNORM,      Texture2D, A, FILTER>,
+                    &Sampler::sampleCompiled<Format::R8G8B8A8_UNORM_SRGB, Texture2D, A, FILTER>,
+                },
+                {
+                    &Sampler::sampleCompiled<Format::R32_FLOAT,          VirtualTexture, A, FILTER>,
+                    &Sampler::sampleCompiled<Format::R32G32_FLOAT,       VirtualTexture, A, FILTER>,
+                    &Sampler::sampleCompiled<Format::R32G32B32_FLOAT,    VirtualTexture, A, FILTER>,
+                    &Sampler::sampleCompiled<Format::R32G32B32A32_FLOAT, VirtualTexture, A, FILTER>,
+                    &Sampler::sampleUnsupported, &Sampler::sampleUnsupported, &Sampler::sampleUnsupported, &Sampler::sampleUnsupported,
+                    &Sampler::sampleUnsupported, &Sampler::sampleUnsupported, &Sampler::sampleUnsupported,
+                    &Sampler::sampleUnsupported, &Sampler::sampleUnsupported, &Sampler::sampleUnsupported, &Sampler::sampleUnsupported,
+                },
+                {
+                    &Sampler::sampleCompiledN<4, Format::R32_FLOAT,          Texture2D, A, FILTER>,
+                    &Sampler::sampleCompiledN<4, Format::R32G32_FLOAT,       Texture2D, A, FILTER>,
+                    &Sampler::sampleCompiledN<4, Format::R32G32B32_FLOAT,    Texture2D, A, FILTER>,
+                    &Sampler::sampleCompiledN<4, Format::R32G32B32A32_FLOAT, Texture2D, A, FILTER>,
+                    &Sampler::sampleUnsupportedN<4>, // R16_UINT
+                    &Sampler::sampleUnsupportedN<4>, // R16_SINT
+                    &Sampler::sampleUnsupportedN<4>, // R32_UINT
+                    &Sampler::sampleUnsupportedN<4>, // R32_SINT
+                    &Sampler::sampleCompiledN<4, Format::BC1_UNORM, Texture2D, A, FILTER>,
+                    &Sampler::sampleCompiledN<4, Format::BC3_UNORM, Texture2D, A, FILTER>,
+                    &Sampler::sampleCompiledN<4, Format::BC7_UNORM, Texture2D, A, FILTER>,
+                    &Sampler::sampleCompiledN<4, Format::R8_UNORM,            Texture2D, A, FILTER>,
+                    &Sampler::sampleCompiledN<4, Format::R8G8_UNORM,          Texture2D, A, FILTER>,
+                    &Sampler::sampleCompiledN<4, Format::R8G8B8A8_UNORM,      Texture2D, A, FILTER>,
+                    &Sampler::sampleCompiledN<4, Format::R8G8B8A8_UNORM_SRGB, Texture2D, A, FILTER>,
+                },
+                {
+                    &Sampler::sampleCompiledN<4, Format::R32_FLOAT,          VirtualTexture, A, FILTER>,
+                    &Sampler::sampleCompiledN<4, Format::R32G32_FLOAT,       VirtualTexture, A, FILTER>,
+                    &Sampler::sampleCompiledN<4, Format::R32G32B32_FLOAT,    VirtualTexture, A, FILTER>,
+                    &Sampler::sampleCompiledN<4, Format::R32G32B32A32_FLOAT, VirtualTexture, A, FILTER>,
+                    &Sampler::sampleUnsupportedN<4>, &Sampler::sampleUnsupportedN<4>, &Sampler::sampleUnsupportedN<4>, &Sampler::sampleUnsupportedN<4>,
+                    &Sampler::sampleUnsupportedN<4>, &Sampler::sampleUnsupportedN<4>, &Sampler::sampleUnsupportedN<4>,
+                    &Sampler::sampleUnsupportedN<4>, &Sampler::sampleUnsupportedN<4>, &Sampler::sampleUnsupportedN<4>, &Sampler::sampleUnsupportedN<4>,
+                },
+                {
+                    &Sampler::sampleCompiledN<8, Format::R32_FLOAT,          Texture2D, A, FILTER>,
+                    &Sampler::sampleCompiledN<8, Format::R32G32_FLOAT,       Texture2D, A, FILTER>,
+                    &Sampler::sampleCompiledN<8, Format::R32G32B32_FLOAT,    Texture2D, A, FILTER>,
+                    &Sampler::sampleCompiledN<8, Format::R32G32B32A32_FLOAT, Texture2D, A, FILTER>,
+                    &Sampler::sampleUnsupportedN<8>, // R16_UINT
+                    &Sampler::sampleUnsupportedN<8>, // R16_SINT
+                    &Sampler::sampleUnsupportedN<8>, // R32_UINT
+                    &Sampler::sampleUnsupportedN<8>, // R32_SINT
+                    &Sampler::sampleCompiledN<8, Format::BC1_UNORM, Texture2D, A, FILTER>,
+                    &Sampler::sampleCompiledN<8, Format::BC3_UNORM, Texture2D, A, FILTER>,
+                    &Sampler::sampleCompiledN<8, Format::BC7_UNORM, Texture2D, A, FILTER>,
+                    &Sampler::sampleCompiledN<8, Format::R8_UNORM,            Texture2D, A, FILTER>,
+                    &Sampler::sampleCompiledN<8, Format::R8G8_UNORM,          Texture2D, A, FILTER>,
+                    &Sampler::sampleCompiledN<8, Format::R8G8B8A8_UNORM,      Texture2D, A, FILTER>,
+                    &Sampler::sampleCompiledN<8, Format::R8G8B8A8_UNORM_SRGB, Texture2D, A, FILTER>,
+                },
+                {
+                    &Sampler::sampleCompiledN<8, Format::R32_FLOAT,          VirtualTexture, A, FILTER>,
+                    &Sampler::sampleCompiledN<8, Format::R32G32_FLOAT,       VirtualTexture, A, FILTER>,
+                    &Sampler::sampleCompiledN<8, Format::R32G32B32_FLOAT,    VirtualTexture, A, FILTER>,
+                    &Sampler::sampleCompiledN<8, Format::R32G32B32A32_FLOAT, VirtualTexture, A, FILTER>,
+                    &Sampler::sampleUnsupportedN<8>, &Sampler::sampleUnsupportedN<8>, &Sampler::sampleUnsupportedN<8>, &Sampler::sampleUnsupportedN<8>,
+                    &Sampler::sampleUnsupportedN<8>, &Sampler::sampleUnsupportedN<8>, &Sampler::sampleUnsupportedN<8>,
+                    &Sampler::sampleUnsupportedN<8>, &Sampler::sampleUnsupportedN<8>, &Sampler::sampleUnsupportedN<8>, &Sampler::sampleUnsupportedN<8>,
+                },
+            };
+            return &table;
+        }
+        // ±: AddressPolicyK * 8 + FILTER
+        template <size_t... I>
+        static const CompiledSamplerState* compiledTable(size_t index, std::index_sequence<I...>)
+        {
+            static const CompiledSamplerState* const tables[] = { Sampler::compiledTable<detail::AddressPolicy<uint32_t(I / 8)>, uint32_t(I % 8)>()... };
+            return tables[index];
+        }
+
+        // ddx/ddyΪnormalized texture coordinateĻռƫ
+        static Float computeLod(const Texture& tex, const Vec2& ddx, const Vec2& ddy)
+        {
+            Float w, h;
+            if(tex.getType() == TextureType::VIRTUAL_TEXTURE_2D)
+            {
+                auto& vt = static_cast<const VirtualTexture&>(tex);
+                w = Float(vt.getWidth());
+                h = Float(vt.getHeight());
+            }
+            else
+            {
+                auto& t2d = static_cast<const Texture2D&>(tex);
+                w = Float(t2d.getWidth());
+                h = Float(t2d.getHeight());
+            }
+            const auto dx = Vec2(ddx.x * w, ddx.y * h);
+            const auto dy = Vec2(ddy.x * w, ddy.y * h);
+            const auto rhoSq = std::max(dot(dx, dx), dot(dy, dy));
+            // log2(sqrt(rhoSq))
+            return rhoSq > Float(0) ? Float(0.5) * std::log2(rhoSq) : -FLT_MAX;
+        }
+        // ȽϲֻȡR32_FLOATdepth texel
+        template <typename View>
+        static Float fetchDepth(const View& mip, const SamplerState& ss, int32_t x, int32_t y)
+        {
+            return simd::getX(Sampler::fetch<Format::R32_FLOAT, detail::DynamicAddress>(mip, ss, x, y));
+        }
+        // (x,y), (x+1,y), (x,y+1), (x+1,y+1)
+        static SIMDFloat4_t loadDepthQuad(const detail::MipView& mip, const SamplerState& ss, int32_t x, int32_t y)
+        {
+            // ȫڷΧʱֱӶȡ, Ѱַ
+            if(0 <= x && x + 1 < mip.width && 0 <= y && y + 1 < mip.height)
+            {
+                const auto p = mip.data + y * mip.pitch + x;
+                return SIMDFloat4::set(p[0], p[1], p[mip.pitch], p[mip.pitch + 1]);
+            }
+            return SIMDFloat4::set(Sampler::fetchDepth(mip, ss, x, y),     Sampler::fetchDepth(mip, ss, x + 1, y),
+                                   Sampler::fetchDepth(mip, ss, x, y + 1), Sampler::fetchDepth(mip, ss, x + 1, y + 1));
+        }
+        static SIMDFloat4_t loadDepthQuad(const detail::VirtualMipView& mip, const SamplerState& ss, int32_t x, int32_t y)
+        {
+            return SIMDFloat4::set(Sampler::fetchDepth(mip, ss, x, y),     Sampler::fetchDepth(mip, ss, x + 1, y),
+                                   Sampler::fetchDepth(mip, ss, x, y + 1), Sampler::fetchDepth(mip, ss, x + 1, y + 1));
+        }
+        // һе(x..x+3, y)
+        static SIMDFloat4_t loadDepthRow(const detail::MipView& mip, const SamplerState& ss, int32_t x, int32_t y)
+        {
+            if(0 <= x && x + 4 <= mip.width && 0 <= y && y < mip.height)
+                return SIMDFloat4::loadu(mip.data + y * mip.pitch + x);
+            return SIMDFloat4::set(Sampler::fetchDepth(mip, ss, x, y),     Sampler::fetchDepth(mip, ss, x + 1, y),
+                                   Sampler::fetchDepth(mip, ss, x + 2, y), Sampler::fetchDepth(mip, ss, x + 3, y));
+        }
+        static SIMDFloat4_t loadDepthRow(const detail::VirtualMipView& mip, const SamplerState& ss, int32_t x, int32_t y)
+        {
+            return SIMDFloat4::set(Sampler::fetchDepth(mip, ss, x, y),     Sampler::fetchDepth(mip, ss, x + 1, y),
+                                   Sampler::fetchDepth(mip, ss, x + 2, y), Sampler::fetchDepth(mip, ss, x + 3, y));
+        }
+        // kernelSize = 0: һtexel; 1: 2x2bilinear PCF;
+        // N > 1: NxNbilinearȽϵƽ, ȼ(N+1)x(N+1)texeltentȨؼȨ, ÿ4texelһȽ
+        template <CmpFunc CMP, typename View>
+        static Float samplePCF(const View& mip, const SamplerState& ss, const Vec2& location, Float cmpValue, uint32_t kernelSize, const Vec2i& offset)
+        {
+            const auto ref = SIMDFloat4::set1(cmpValue);
+            if(kernelSize == 0)
+            {
+                const auto x = int32_t(std::floor(location.u * mip.width))  + offset.x;
+                const auto y = int32_t(std::floor(location.v * mip.height)) + offset.y;
+                return simd::getX(detail::compare<CMP>(ref, SIMDFloat4::set1(Sampler::fetchDepth(mip, ss, x, y))));
+            }
+            // footprintp - N/2ʼ
+            const auto half = Float(0.5) * Float(kernelSize);
+            const auto x  = location.u * mip.width  - half;
+            const auto y  = location.v * mip.height - half;
+            const auto xf = std::floor(x), yf = std::floor(y);
+            const auto fx = x - xf, fy = y - yf;
+            const auto x0 = int32_t(xf) + offset.x, y0 = int32_t(yf) + offset.y;
+            if(kernelSize == 1)
+            {
+                const auto weights = SIMDFloat4::set((1 - fx) * (1 - fy), fx * (1 - fy), (1 - fx) * fy, fx * fy);
+                return simd::sum(simd::mul(detail::compare<CMP>(ref, Sampler::loadDepthQuad(mip, ss, x0, y0)), weights));
+            }
+            auto acc = SIMDFloat4::zero();
+            for(uint32_t i = 0; i <= kernelSize; i += 4)
+            {
+                // Ȩ: 1-fx, ĩfx, мΪ1, footprintΪ0
+                alignas(16) Float wx[4];
+                for(uint32_t k = 0; k < 4; ++k)
+                {
+                    const auto c = i + k;
+                    wx[k] = c == 0 ? 1 - fx : (c < kernelSize ? Float(1) : (c == kernelSize ? fx : Float(0)));
+                }
+                const auto columnWeights = SIMDFloat4::load(wx);
+                for(uint32_t j = 0; j <= kernelSize; ++j)
+                {
+                    const auto wy = j == 0 ? 1 - fy : (j < kernelSize ? Float(1) : fy);
+                    const auto passed = detail::compare<CMP>(ref, Sampler::loadDepthRow(mip, ss, x0 + int32_t(i), y0 + int32_t(j)));
+                    acc = simd::add(acc, simd::mul(passed, simd::mul(columnWeights, wy)));
+                }
+            }
+            return simd::sum(acc) / Float(kernelSize * kernelSize);
+        }
+        template <typename View>
+        static Float samplePCF(const View& mip, const SamplerState& ss, const Vec2& location, Float cmpValue, uint32_t kernelSize, const Vec2i& offset)
+        {
+            switch(ss.cmpFunc)
+            {
+            case CmpFunc::NEVER:
+                return Sampler::samplePCF<CmpFunc::NEVER>(mip, ss, location, cmpValue, kernelSize, offset);
+            case CmpFunc::LESS:
+                return Sampler::samplePCF<CmpFunc::LESS>(mip, ss, location, cmpValue, kernelSize, offset);
+            case CmpFunc::EQUAL:
+                return Sampler::samplePCF<CmpFunc::EQUAL>(mip, ss, location, cmpValue, kernelSize, offset);
+            case CmpFunc::LESS_EQUAL:
+                return Sampler::samplePCF<CmpFunc::LESS_EQUAL>(mip, ss, location, cmpValue, kernelSize, offset);
+            case CmpFunc::GREATER:
+                return Sampler::samplePCF<CmpFunc::GREATER>(mip, ss, location, cmpValue, kernelSize, offset);
+            case CmpFunc::NOT_EQUAL:
+                return Sampler::samplePCF<CmpFunc::NOT_EQUAL>(mip, ss, location, cmpValue, kernelSize, offset);
+            case CmpFunc::GREATER_EQUAL:
+                return Sampler::samplePCF<CmpFunc::GREATER_EQUAL>(mip, ss, location, cmpValue, kernelSize, offset);
+            case CmpFunc::ALWAYS:
+                return Sampler::samplePCF<CmpFunc::ALWAYS>(mip, ss, location, cmpValue, kernelSize, offset);
+            default:
+                assert(false && "ǷCmpFunc!");
+                return Float(0);
+            }
+        }
+        // level 0ϱȽ(ͬD3DSampleCmpLevelZero)
+        static Float sampleCmpLevelZero(const Texture& tex, const SamplerState& ss, const Vec2& location, Float cmpValue, uint32_t kernelSize, const Vec2i& offset)
+        {
+            auto result = Float(0);
+            Sampler::dispatch(tex, [&](const auto& t, auto fmt)
+            {
+                if constexpr(decltype(fmt)::value == Format::R32_FLOAT)
+                    result = Sampler::samplePCF(Sampler::mipView(t, 0), ss, location, cmpValue, kernelSize, offset);
+                else
+                    assert(false && "Ƚϲֻ֧R32_FLOAT!");
+            });
+            return result;
+        }
+    public:
+        // filteraddress modeΪػĲ, Shader::setSamplerState
+        static const CompiledSamplerState* compile(const SamplerState& ss)
+        {
+            // ʵָfilter: ANISOTROPICԲ
+            auto filter = ss.filter;
+            if(filter == FilterType::ANISOTROPIC || filter == FilterType::COMPARISON_ANISOTROPIC)
+                filter = FilterType::MIN_MAG_MIP_LINEAR;
+            const auto filterBits = (is_mag_linear(filter) ? 4u : 0u) | (is_min_linear(filter) ? 2u : 0u) | (is_mip_linear(filter) ? 1u : 0u);
+            const auto addressK   = ss.addressU == ss.addressV ? uint32_t(ss.addressU) : 0u;
+            assert(addressK <= uint32_t(AddressMode::MIRROR_ONCE) && "ǷAddressMode!");
+            return Sampler::compiledTable(addressK * 8 + filterBits, std::make_index_sequence<(uint32_t(AddressMode::MIRROR_ONCE) + 1) * 8>());
+        }
+        static Vec4 load(const Texture& tex,uint32_t location, int offset, int sampleIndex)
         {
             return Vec4::zero();
         }
+        // ûƫϢ, lod 0
+        static Vec4 sample(const Texture& tex, const SamplerState& ss, const CompiledSamplerState& cs, const Vec2& location, const Vec2i& offset)
+        {
+            return cs.get(tex)(tex, ss, location, Float(0), offset);
+        }
+        static Vec4 sampleGrad(const Texture& tex, const SamplerState& ss, const CompiledSamplerState& cs, const Vec2& location, const Vec2& ddx, const Vec2& ddy, const Vec2i& offset)
+        {
+            return cs.get(tex)(tex, ss, location, Sampler::computeLod(tex, ddx, ddy), offset);
+        }
+        static Vec4 sampleBias(const Texture& tex, const SamplerState& ss, const CompiledSamplerState& cs, const Vec2& location, Float bias, const Vec2i& offset)
+        {
+            return cs.get(tex)(tex, ss, location, bias, offset);
+        }
+        static Vec4 sampleLevel(const Texture& tex, const SamplerState& ss, const CompiledSamplerState& cs, const Vec2& location, Float lod, const Vec2i& offset)
+        {
+            return cs.get(tex)(tex, ss, location, lod, offset);
+        }
+        // COMPARISON_*filter: ʱΪ2x2bilinear PCF, ֻȽtexel
+        static Float sampleCmp(const Texture& tex, const SamplerState& ss, const Vec2& location, Float cmpValue, const Vec2i& offset)
+        {
+            assert(is_comparison(ss.filter) && "ҪCOMPARISON_*filter!");
+            const auto linear = ss.filter == FilterType::COMPARISON_ANISOTROPIC || is_mag_linear(ss.filter);
+            return Sampler::sampleCmpLevelZero(tex, ss, location, cmpValue, linear ? 1 : 0, offset);
+        }
+        static Float sampleCmpPCF(const Texture& tex, const SamplerState& ss, const Vec2& location, Float cmpValue, uint32_t kernelSize, const Vec2i& offset)
+        {
+            assert(kernelSize >= 1);
+            return Sampler::sampleCmpLevelZero(tex, ss, location, cmpValue, kernelSize, offset);
+        }
+        // L lane, L: 48
+        template <uint32_t L>
+        static void sampleN(const Texture& tex, const SamplerState& ss, const CompiledSamplerState& cs, const Vec2 locations[L], const Vec2i& offset, uint32_t mask, Vec4 out[L])
+        {
+            const Float lods[L] = { 0 };
+            cs.getN<L>(tex)(tex, ss, locations, lods, offset, mask, out);
+        }
+        template <uint32_t L>
+        static void sampleGradN(const Texture& tex, const SamplerState& ss, const CompiledSamplerState& cs, const Vec2 locations[L], const Vec2 ddx[L], const Vec2 ddy[L], const Vec2i& offset, uint32_t mask, Vec4 out[L])
+        {
+            Float lods[L] = { 0 };
+            for(uint32_t i = 0; i < L; ++i)
+            {
+                if(mask & (1u << i))
+                    lods[i] = Sampler::computeLod(tex, ddx[i], ddy[i]);
+            }
+            cs.getN<L>(tex)(tex, ss, locations, lods, offset, mask, out);
+        }
+        template <uint32_t L>
+        static void sampleLevelN(const Texture& tex, const SamplerState& ss, const CompiledSamplerState& cs, const Vec2 locations[L], const Float lods[L], const Vec2i& offset, uint32_t mask, Vec4 out[L])
+        {
+            cs.getN<L>(tex)(tex, ss, locations, lods, offset, mask, out);
+        }
     };
     //////////////////////////////////////////////////////////////////////////////////////////////////////////
+    Shader::Shader()
+    {
+        for(auto& cs : m_compiledStates)
+            cs = Sampler::compile(SamplerState());
+    }
+    void Shader::snapshotConstants()
+    {
+        for(uint32_t i = 0; i < SHADER_CONSTANT_BUFFER_COUNT; ++i)
+        {
+            m_constantSnapshots[i] = m_constantBuffers[i] ? m_constantBuffers[i]->snapshot() : nullptr;
+            m_constants[i]         = m_constantSnapshots[i] ? m_constantSnapshots[i]->data() : nullptr;
+        }
+    }
+    void Shader::saveState(State& state) const
+    {
+        std::copy(std::begin(m_floats),   std::end(m_floats),   std::begin(state.floats));
+        std::copy(std::begin(m_vectors),  std::end(m_vectors),  std::begin(state.vectors));
+        std::copy(std::begin(m_matrices), std::end(m_matrices), std::begin(state.matrices));
+        std::copy(std::begin(m_samplerStates),  std::end(m_samplerStates),  std::begin(state.samplerStates));
+        std::copy(std::begin(m_compiledStates), std::end(m_compiledStates), std::begin(state.compiledStates));
+        std::copy(std::begin(m_resources),      std::end(m_resources),      std::begin(state.resources));
+        std::copy(std::begin(m_constantBuffers),   std::end(m_constantBuffers),   std::begin(state.constantBuffers));
+        std::copy(std::begin(m_constantSnapshots), std::end(m_constantSnapshots), std::begin(state.constantSnapshots));
+    }
+    void Shader::restoreState(const State& state)
+    {
+        std::copy(std::begin(state.floats),   std::end(state.floats),   std::begin(m_floats));
+        std::copy(std::begin(state.vectors),  std::end(state.vectors),  std::begin(m_vectors));
+        std::copy(std::begin(state.matrices), std::end(state.matrices), std::begin(m_matrices));
+        std::copy(std::begin(state.samplerStates),  std::end(state.samplerStates),  std::begin(m_samplerStates));
+        std::copy(std::begin(state.compiledStates), std::end(state.compiledStates), std::begin(m_compiledStates));
+        std::copy(std::begin(state.resources),      std::end(state.resources),      std::begin(m_resources));
+        std::copy(std::begin(state.constantBuffers),   std::end(state.constantBuffers),   std::begin(m_constantBuffers));
+        std::copy(std::begin(state.constantSnapshots), std::end(state.constantSnapshots), std::begin(m_constantSnapshots));
+        for(uint32_t i = 0; i < SHADER_CONSTANT_BUFFER_COUNT; ++i)
+            m_constants[i] = m_constantSnapshots[i] ? m_constantSnapshots[i]->data() : nullptr;
+    }
+    void Shader::releaseConstants()
+    {
+        for(uint32_t i = 0; i < SHADER_CONSTANT_BUFFER_COUNT; ++i)
+        {
+            m_constantSnapshots[i].reset();
+            m_constants[i] = nullptr;
+        }
+    }
+    void Shader::setSamplerState(uint8_t sloti, const SamplerState& ss)
+    {
+        assert(sloti < SHADER_SAMPLER_COUNT);
+        m_samplerStates[sloti]  = ss;
+        m_compiledStates[sloti] = Sampler::compile(ss);
+    }
+    //////////////////////////////////////////////////////////////////////////////////////////////////////////
     Vec4 Shader::Tex2D::load(int location, int offset, int sampleIndex)
     {
         return Sampler::load(*m_texture, location, offset, sampleIndex);
     }
+    const SamplerState& Shader::Tex2D::state(uint8_t samplerslot) const
+    {
+        assert(samplerslot < SHADER_SAMPLER_COUNT && "Ƿsampler slot!");
+        return m_states[samplerslot];
+    }
+    const CompiledSamplerState& Shader::Tex2D::compiledState(uint8_t samplerslot) const
+    {
+        assert(samplerslot < SHADER_SAMPLER_COUNT && "Ƿsampler slot!");
+        return *m_compiledStates[samplerslot];
+    }
     Vec4 Shader::Tex2D::sample(uint8_t samplerslot, const Vec2& location, const Vec2i& offset)
     {
-        return Sampler::sample(*m_texture, m_states[samplerslot],location, offset);
+        return Sampler::sample(*m_texture, state(samplerslot), compiledState(samplerslot), location, offset);
     }
-    Vec4 Shader::Tex2D::sampleGrad(uint8_t samplerslot, const Vec2& location, Float ddx, Float ddy, const Vec2i& offset)
+    Vec4 Shader::Tex2D::sampleGrad(uint8_t samplerslot, const Vec2& location, const Vec2& ddx, const Vec2& ddy, const Vec2i& offset)
     {
-        return Sampler::sampleGrad(*m_texture, m_states[samplerslot],location, ddx,ddy,offset);
+        return Sampler::sampleGrad(*m_texture, state(samplerslot), compiledState(samplerslot), location, ddx,ddy,offset);
     }
-    Vec4 Shader::Tex2D::sampleBias(uint8_t samplerslot, const Vec2& location, Float lod, const Vec2i& offset)
+    Vec4 Shader::Tex2D::sampleBias(uint8_t samplerslot, const Vec2& location, Float bias, const Vec2i& offset)
     {
-        return Sampler::sampleBias(*m_texture, m_states[samplerslot],location, lod,offset);
+        return Sampler::sampleBias(*m_texture, state(samplerslot), compiledState(samplerslot), location, bias,offset);
     }
-    Vec4 Shader::Tex2D::sampleCmp(uint8_t samplerslot, const Vec2& location, Float cmpValue, const Vec2i& offset)
+    Vec4 Shader::Tex2D::sampleLevel(uint8_t samplerslot, const Vec2& location, Float lod, const Vec2i& offset)
     {
-        return Sampler::sampleCmp(*m_texture, m_states[samplerslot],location, cmpValue,offset);
+        return Sampler::sampleLevel(*m_texture, state(samplerslot), compiledState(samplerslot), location, lod,offset);
+    }
+    Float Shader::Tex2D::sampleCmp(uint8_t samplerslot, const Vec2& location, Float cmpValue, const Vec2i& offset)
+    {
+        return Sampler::sampleCmp(*m_texture, state(samplerslot),location, cmpValue,offset);
+    }
+    Float Shader::Tex2D::sampleCmpPCF(uint8_t samplerslot, const Vec2& location, Float cmpValue, uint32_t kernelSize, const Vec2i& offset)
+    {
+        return Sampler::sampleCmpPCF(*m_texture, state(samplerslot), location, cmpValue, kernelSize, offset);
+    }
+    void Shader::Tex2D::sample4(uint8_t samplerslot, const Vec2 locations[4], Vec4 out[4], uint32_t mask, const Vec2i& offset)
+    {
+        Sampler::sampleN<4>(*m_texture, state(samplerslot), compiledState(samplerslot), locations, offset, mask, out);
+    }
+    void Shader::Tex2D::sampleGrad4(uint8_t samplerslot, const Vec2 locations[4], const Vec2 ddx[4], const Vec2 ddy[4], Vec4 out[4], uint32_t mask, const Vec2i& offset)
+    {
+        Sampler::sampleGradN<4>(*m_texture, state(samplerslot), compiledState(samplerslot), locations, ddx, ddy, offset, mask, out);
+    }
+    void Shader::Tex2D::sampleLevel4(uint8_t samplerslot, const Vec2 locations[4], const Float lods[4], Vec4 out[4], uint32_t mask, const Vec2i& offset)
+    {
+        Sampler::sampleLevelN<4>(*m_texture, state(samplerslot), compiledState(samplerslot), locations, lods, offset, mask, out);
+    }
+    void Shader::Tex2D::sample8(uint8_t samplerslot, const Vec2 locations[8], Vec4 out[8], uint32_t mask, const Vec2i& offset)
+    {
+        Sampler::sampleN<8>(*m_texture, state(samplerslot), compiledState(samplerslot), locations, offset, mask, out);
+    }
+    void Shader::Tex2D::sampleGrad8(uint8_t samplerslot, const Vec2 locations[8], const Vec2 ddx[8], const Vec2 ddy[8], Vec4 out[8], uint32_t mask, const Vec2i& offset)
+    {
+        Sampler::sampleGradN<8>(*m_texture, state(samplerslot), compiledState(samplerslot), locations, ddx, ddy, offset, mask, out);
+    }
+    void Shader::Tex2D::sampleLevel8(uint8_t samplerslot, const Vec2 locations[8], const Float lods[8], Vec4 out[8], uint32_t mask, const Vec2i& offset)
+    {
+        Sampler::sampleLevelN<8>(*m_texture, state(samplerslot), compiledState(samplerslot), locations, lods, offset, mask, out);
+    }
+    //////////////////////////////////////////////////////////////////////////////////////////////////////////
+    void VertexShader::executeBatch(const VSRegisters* const inputs[VS_BATCH_SIZE], PSRegisters* const outputs[VS_BATCH_SIZE], SystemValue sv[VS_BATCH_SIZE], uint32_t mask)
+    {
+        for(uint32_t i = 0; i < VS_BATCH_SIZE; ++i)
+        {
+            if(mask & (1u << i))
+                this->execute(*inputs[i], *outputs[i], sv[i]);
+        }
+    }
+    uint32_t PixelShader::executeBatch(const PSRegisters* const varyings[PS_BATCH_SIZE], SystemValue sv[PS_BATCH_SIZE], uint32_t mask)
+    {
+        uint32_t passed = 0;
+        for(uint32_t i = 0; i < PS_BATCH_SIZE; ++i)
+        {
+            if((mask & (1u << i)) && this->execute(*varyings[i], sv[i]))
+                passed |= 1u << i;
+        }
+        return passed;
+    }
+    //////////////////////////////////////////////////////////////////////////////////////////////////////////
+    // ͸У: attr = P/Q, d(attr)/dx = (dP/dx - attr * dQ/dx) / Q
+    Vec4 PixelShader::SystemValue::ddx(uint32_t regi) const
+    {
+        assert(varyings && varyingsDx && "δRasterizerд!");
+        return ((*varyingsDx)[regi] - (*varyings)[regi] * invDepth.y) / invDepth.x;
+    }
+    Vec4 PixelShader::SystemValue::ddy(uint32_t regi) const
+    {
+        assert(varyings && varyingsDy && "δRasterizerд!");
+        return ((*varyingsDy)[regi] - (*varyings)[regi] * invDepth.z) / invDepth.x;
     }
 
-
-}// ns rl
\ No newline at end of file
+}// ns rl
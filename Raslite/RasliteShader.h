@@ -23,6 +23,7 @@ namespace rl {
         Float       minLod        = -FLT_MAX;
         Float       maxLod        = FLT_MAX;
     };
+    struct CompiledSamplerState;
     /////////////////////////////////////////////////////////////////
     //Shader
     class Shader
@@ -40,16 +41,48 @@ namespace rl {
         class TexCube;
         class TexCubeArray;
     public:
+        Shader();
         template <typename T> 
         void uniform(uint32_t idx, const T& val);
+        // ͬʱssΪػĲ, ʱٰfilteraddress mode֧
         void setSamplerState (uint8_t sloti, const SamplerState& ss);
         void setInputResource(uint8_t sloti, Texture* surf);
         Texture*            getInputResource(uint8_t sloti) const;
         const SamplerState& getSamplerState(uint8_t sloti)  const;
+        // ͬһConstantBuffer԰󶨵Shader
+        void            setConstantBuffer(uint8_t sloti, ConstantBuffer* cb);
+        ConstantBuffer* getConstantBuffer(uint8_t sloti) const;
+        // Pipelinedrawʼʱ(preamble֮ǰ): ȡð󶨵ConstantBuffersnapshot, drawڼconstant()ȡĶsnapshot
+        void snapshotConstants();
+        // Pipelinedrawʱ: ͷsnapshot
+        void releaseConstants();
+        // Pipelineÿdrawʼʱ(κexecute֮ǰ)һ: uniformĳ(WVP)дuniform,
+        // executeֱӶȡ, ضÿvertex/pixelظ
+        virtual void preamble() {}
+        // drawʱShaderȫ״̬: uniform, sampler, ԴConstantBuffersnapshot
+        // ӳɫ(VisibilityBuffer)beginDrawʱ, resolveʱdrawָ; ͬһShaderڶdraw
+        struct State
+        {
+            Float floats  [SHADER_CONSTANT_COUNT];
+            Vec4  vectors [SHADER_CONSTANT_COUNT];
+            Mat4  matrices[SHADER_CONSTANT_COUNT];
+
+            SamplerState                samplerStates [SHADER_SAMPLER_COUNT];
+            const CompiledSamplerState* compiledStates[SHADER_SAMPLER_COUNT];
+            Texture*                    resources[SHADER_INPUT_RESOURCE_COUNT];
+
+            ConstantBuffer*          constantBuffers  [SHADER_CONSTANT_BUFFER_COUNT];
+            ConstantBuffer::Snapshot constantSnapshots[SHADER_CONSTANT_BUFFER_COUNT];
+        };
+        void saveState(State& state) const;
+        void restoreState(const State& state);
     protected:
         template <typename T> 
         const T& uniform(uint32_t idx) const;
         Tex2D tex2D(uint8_t sloti) const;
+        // ȡslotiConstantBuffer(snapshot)дӵoffsetVec4ʼĳ
+        template <typename T>
+        const T& constant(uint8_t sloti, uint32_t offset) const;
     public:// Write Uniform
         template<> void uniform<Float>(uint32_t idx, const Float& val);
         template<> void uniform<Vec2>(uint32_t idx, const Vec2&  val);
@@ -65,23 +98,47 @@ namespace rl {
         Vec4  m_vectors [SHADER_CONSTANT_COUNT];
         Mat4  m_matrices[SHADER_CONSTANT_COUNT];
 
-        SamplerState m_samplerStates [SAMPLER_STATE_COUNT];
+        SamplerState                m_samplerStates [SHADER_SAMPLER_COUNT];
+        const CompiledSamplerState* m_compiledStates[SHADER_SAMPLER_COUNT];
         Texture*     m_resources[SHADER_INPUT_RESOURCE_COUNT] = { nullptr };
+
+        ConstantBuffer*          m_constantBuffers  [SHADER_CONSTANT_BUFFER_COUNT] = { nullptr };
+        ConstantBuffer::Snapshot m_constantSnapshots[SHADER_CONSTANT_BUFFER_COUNT];
+        const Vec4*              m_constants        [SHADER_CONSTANT_BUFFER_COUNT] = { nullptr }; // m_constantSnapshots
     };
     class Shader::Tex2D 
     {
     public:
-        Tex2D(const Texture2D* texture, const SamplerState* states);
+        Tex2D(const Texture* texture, const SamplerState* states, const CompiledSamplerState* const* compiledStates);
 
         Vec4 load(int location, int offset, int sampleIndex);
 
-        Vec4 sample    (uint8_t samplerslot, const Vec2& location,                       const Vec2i& offset = Vec2i::zero());
-        Vec4 sampleGrad(uint8_t samplerslot, const Vec2& location, Float ddx, Float ddy, const Vec2i& offset = Vec2i::zero());
-        Vec4 sampleBias(uint8_t samplerslot, const Vec2& location, Float lod,            const Vec2i& offset = Vec2i::zero());
-        Vec4 sampleCmp (uint8_t samplerslot, const Vec2& location, Float cmpValue,       const Vec2i& offset = Vec2i::zero());
+        // ûʽƫ, samplelod 0; ҪmipѡʱsampleGrad(PixelShader::SystemValue::ddx/ddy)
+        Vec4 sample     (uint8_t samplerslot, const Vec2& location,                                 const Vec2i& offset = Vec2i::zero());
+        Vec4 sampleGrad (uint8_t samplerslot, const Vec2& location, const Vec2& ddx, const Vec2& ddy, const Vec2i& offset = Vec2i::zero());
+        Vec4 sampleBias (uint8_t samplerslot, const Vec2& location, Float bias,                     const Vec2i& offset = Vec2i::zero());
+        Vec4 sampleLevel(uint8_t samplerslot, const Vec2& location, Float lod,                      const Vec2i& offset = Vec2i::zero());
+        // Ƚϲ(R32_FLOAT, COMPARISON_*filter), level 0Ͻ: cmpValue OP texelı
+        Float sampleCmp   (uint8_t samplerslot, const Vec2& location, Float cmpValue,                      const Vec2i& offset = Vec2i::zero());
+        // kernelSize x kernelSizebilinearȽϵPCF; 1ʱͬfiltersampleCmp
+        Float sampleCmpPCF(uint8_t samplerslot, const Vec2& location, Float cmpValue, uint32_t kernelSize, const Vec2i& offset = Vec2i::zero());
+
+        // 4/8 lane: ״̬ÿεֻһ; maskĵiλΪ0lane, out[i]ֲ
+        // floatʽTexture2Dڸlanemip levelͬʱfloatN(AVX2Ϊ8 lane)һμ, texelgatherȡ
+        void sample4     (uint8_t samplerslot, const Vec2 locations[4],                                     Vec4 out[4], uint32_t mask = 0xF, const Vec2i& offset = Vec2i::zero());
+        void sampleGrad4 (uint8_t samplerslot, const Vec2 locations[4], const Vec2 ddx[4], const Vec2 ddy[4], Vec4 out[4], uint32_t mask = 0xF, const Vec2i& offset = Vec2i::zero());
+        void sampleLevel4(uint8_t samplerslot, const Vec2 locations[4], const Float lods[4],                 Vec4 out[4], uint32_t mask = 0xF, const Vec2i& offset = Vec2i::zero());
+        void sample8     (uint8_t samplerslot, const Vec2 locations[8],                                     Vec4 out[8], uint32_t mask = 0xFF, const Vec2i& offset = Vec2i::zero());
+        void sampleGrad8 (uint8_t samplerslot, const Vec2 locations[8], const Vec2 ddx[8], const Vec2 ddy[8], Vec4 out[8], uint32_t mask = 0xFF, const Vec2i& offset = Vec2i::zero());
+        void sampleLevel8(uint8_t samplerslot, const Vec2 locations[8], const Float lods[8],                 Vec4 out[8], uint32_t mask = 0xFF, const Vec2i& offset = Vec2i::zero());
     private:
-        const Texture2D*    m_texture = nullptr;
+        // samplerslot < SHADER_SAMPLER_COUNT
+        const SamplerState&         state        (uint8_t samplerslot) const;
+        const CompiledSamplerState& compiledState(uint8_t samplerslot) const;
+
+        const Texture*      m_texture = nullptr;    // Texture2DVirtualTexture
         const SamplerState* m_states  = nullptr;
+        const CompiledSamplerState* const* m_compiledStates = nullptr;
     };
     /////////////////////////////////////////////////////////////////
     class VertexShader: public Shader
@@ -91,6 +148,9 @@ namespace rl {
     public:
         VertexShader();
         virtual void execute(const VSRegisters& input, PSRegisters& output,SystemValue& sv) = 0;
+        // һִһvertex(VS_BATCH_SIZE), maskĵiλʾivertexЧ
+        // ȱʡexecute; غVec4xNÿμSIMD_LANE_COUNTvertex
+        virtual void executeBatch(const VSRegisters* const inputs[VS_BATCH_SIZE], PSRegisters* const outputs[VS_BATCH_SIZE], SystemValue sv[VS_BATCH_SIZE], uint32_t mask);
     };
     struct VertexShader::SystemValue
     {
@@ -107,6 +167,28 @@ namespace rl {
         struct SystemValue;
     public:
         virtual bool execute(const PSRegisters& varyings, SystemValue& sv) = 0;
+        // һִһpixel(PS_BATCH_SIZE), maskĵiλʾipixelЧ
+        // δpixelmask; ȱʡexecute, غTex2D::sample8һβ
+        virtual uint32_t executeBatch(const PSRegisters* const varyings[PS_BATCH_SIZE], SystemValue sv[PS_BATCH_SIZE], uint32_t mask);
+    };
+    // CRTP: class MyPS: public PixelShaderT<MyPS>, MyPS::executeҪΪpublic
+    // executeBatchֱ()Derived::execute, executeԱbatchѭ, ÿbatchֻһ麯;
+    // ͨPixelShader*̬executeķʽ
+    template <typename Derived>
+    class PixelShaderT: public PixelShader
+    {
+    public:
+        uint32_t executeBatch(const PSRegisters* const varyings[PS_BATCH_SIZE], SystemValue sv[PS_BATCH_SIZE], uint32_t mask) override
+        {
+            auto self = static_cast<Derived*>(this);
+            uint32_t passed = 0;
+            for(uint32_t i = 0; i < PS_BATCH_SIZE; ++i)
+            {
+                if((mask & (1u << i)) && self->Derived::execute(*varyings[i], sv[i]))
+                    passed |= 1u << i;
+            }
+            return passed;
+        }
     };
     struct PixelShader::SystemValue
     {
@@ -124,6 +206,16 @@ namespace rl {
         uint32_t coverage;
         //input
         uint32_t sampleIndex;
+
+        //Input: ddx/ddy, Rasterizerд
+        const PSRegisters* varyings   = nullptr;
+        const PSRegisters* varyingsDx = nullptr; // d(varying/w)/dx, ÿΪ
+        const PSRegisters* varyingsDy = nullptr; // d(varying/w)/dy
+        Vec3               invDepth;             // (1/w, d(1/w)/dx, d(1/w)/dy)
+
+        // varyings[regi]Ļռƫ
+        Vec4 ddx(uint32_t regi) const;
+        Vec4 ddy(uint32_t regi) const;
     };
 }//ns 
 /////////////////////////////////////////////////////////////////
@@ -131,14 +223,10 @@ namespace rl {
 /////////////////////////////////////////////////////////////////
 namespace rl {
     /////////////////////////////////////////////////////////////////
-    inline void Shader::setSamplerState(uint8_t sloti, const SamplerState& ss)
-    {
-        assert(sloti < SHADER_INPUT_RESOURCE_COUNT);
-        m_samplerStates[sloti] = ss;
-    }
+
     inline const SamplerState& Shader::getSamplerState(uint8_t sloti) const
     {
-        assert(sloti < SAMPLER_STATE_COUNT);
+        assert(sloti < SHADER_SAMPLER_COUNT);
         return m_samplerStates[sloti];
     }
     inline void Shader::setInputResource(uint8_t sloti, Texture* surf)
@@ -151,6 +239,23 @@ namespace rl {
         assert(sloti < SHADER_INPUT_RESOURCE_COUNT);
         return m_resources[sloti];
     }
+    inline void Shader::setConstantBuffer(uint8_t sloti, ConstantBuffer* cb)
+    {
+        assert(sloti < SHADER_CONSTANT_BUFFER_COUNT);
+        m_constantBuffers[sloti] = cb;
+    }
+    inline ConstantBuffer* Shader::getConstantBuffer(uint8_t sloti) const
+    {
+        assert(sloti < SHADER_CONSTANT_BUFFER_COUNT);
+        return m_constantBuffers[sloti];
+    }
+    template <typename T>
+    inline const T& Shader::constant(uint8_t sloti, uint32_t offset) const
+    {
+        assert(sloti < SHADER_CONSTANT_BUFFER_COUNT && m_constants[sloti] && "ConstantBufferûа!");
+        assert((offset * sizeof(Vec4) + sizeof(T) + sizeof(Vec4) - 1) / sizeof(Vec4) <= m_constantSnapshots[sloti]->size());
+        return *reinterpret_cast<const T*>(m_constants[sloti] + offset);
+    }
     template<>
     inline void Shader::uniform<Float>(uint32_t idx, const Float& val)
     {
@@ -192,14 +297,15 @@ namespace rl {
         return m_matrices[idx];
     }
     //
-    inline Shader::Tex2D::Tex2D(const Texture2D* texture, const SamplerState* states)
+    inline Shader::Tex2D::Tex2D(const Texture* texture, const SamplerState* states, const CompiledSamplerState* const* compiledStates)
         : m_texture(texture)
         , m_states(states)
+        , m_compiledStates(compiledStates)
     {
     }
     inline Shader::Tex2D Shader::tex2D(uint8_t texslot) const
     {
-        return Tex2D(static_cast<const Texture2D*>(m_resources[texslot]), m_samplerStates);
+        return Tex2D(static_cast<const Texture*>(m_resources[texslot]), m_samplerStates, m_compiledStates);
     }
     /////////////////////////////////////////////////////////////////
     inline VertexShader::VertexShader()
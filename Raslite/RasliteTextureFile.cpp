@@ -0,0 +1,150 @@
+#include "RasliteTextureFile.h"
+#include "RasliteData.h"
+#include <fstream>
+#include <vector>
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+namespace rl {
+    namespace detail {
+        static inline uint64_t alignUp(uint64_t offset, uint64_t alignment)
+        {
+            return (offset + alignment - 1) / alignment * alignment;
+        }
+        static inline bool isSupportedFormat(uint32_t fmt)
+        {
+            return fmt <= uint32_t(Format::R32G32B32A32_FLOAT) || is_block_compressed(Format(fmt)) || is_unorm8(Format(fmt));
+        }
+    }//ns detail
+    TextureFile::~TextureFile()
+    {
+        this->_unmap();
+    }
+    std::shared_ptr<TextureFile> TextureFile::open(const char* path)
+    {
+        std::shared_ptr<TextureFile> file(new TextureFile());
+        if(!file->_map(path) || file->m_size < sizeof(Header))
+            return nullptr;
+        // Уheader͸mipķΧ, ֮ķʲټ
+        const auto& header = *reinterpret_cast<const Header*>(file->m_base);
+        if(header.magic != MAGIC || header.version != VERSION || !detail::isSupportedFormat(header.format))
+            return nullptr;
+        if(header.mipLevels == 0 || header.mipLevels > MAX_MIP_LEVEL)
+            return nullptr;
+        if((header.width >> (header.mipLevels - 1)) == 0 || (header.height >> (header.mipLevels - 1)) == 0)
+            return nullptr;
+        for(uint32_t lvl = 0; lvl < header.mipLevels; ++lvl)
+        {
+            const auto offset = header.mipOffsets[lvl];
+            const auto size   = uint64_t(surface_float_count(header.width >> lvl, header.height >> lvl, Format(header.format))) * sizeof(Float);
+            if(offset % MIP_ALIGNMENT != 0 || offset < sizeof(Header) || offset > file->m_size || size > file->m_size - offset)
+                return nullptr;
+        }
+        file->m_header = &header;
+        return file;
+    }
+    bool TextureFile::save(const char* path, const Texture2D& tex)
+    {
+        Header header = {};
+        header.magic     = MAGIC;
+        header.version   = VERSION;
+        header.format    = uint32_t(tex.getFormat());
+        header.width     = tex.getWidth();
+        header.height    = tex.getHeight();
+        header.mipLevels = tex.getMipLevel();
+        assert(header.mipLevels <= MAX_MIP_LEVEL);
+
+        auto offset = detail::alignUp(sizeof(Header), MIP_ALIGNMENT);
+        for(uint32_t lvl = 0; lvl < header.mipLevels; ++lvl)
+        {
+            header.mipOffsets[lvl] = offset;
+            const auto surface = tex.getMipSurface(lvl);
+            offset = detail::alignUp(offset + surface_float_count(surface->getWidth(), surface->getHeight(), surface->getFormat()) * sizeof(Float), MIP_ALIGNMENT);
+        }
+
+        std::ofstream stream(path, std::ios::binary | std::ios::trunc);
+        if(!stream)
+            return false;
+        stream.write(reinterpret_cast<const char*>(&header), sizeof(Header));
+        const std::vector<char> padding(MIP_ALIGNMENT, 0);
+        uint64_t written = sizeof(Header);
+        for(uint32_t lvl = 0; lvl < header.mipLevels; ++lvl)
+        {
+            stream.write(padding.data(), std::streamsize(header.mipOffsets[lvl] - written));
+            // SurfaceĴ洢, һд
+            const auto surface = tex.getMipSurface(lvl);
+            const auto size    = surface_float_count(surface->getWidth(), surface->getHeight(), surface->getFormat()) * sizeof(Float);
+            auto locked = surface->lock(nullptr, LockMode::READ_ONLY);
+            stream.write(reinterpret_cast<const char*>(locked.data), std::streamsize(size));
+            surface->unlock(locked);
+            written = header.mipOffsets[lvl] + size;
+        }
+        return bool(stream);
+    }
+#ifdef _WIN32
+    bool TextureFile::_map(const char* path)
+    {
+        m_fileHandle = ::CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+        if(m_fileHandle == INVALID_HANDLE_VALUE)
+        {
+            m_fileHandle = nullptr;
+            return false;
+        }
+        LARGE_INTEGER size;
+        if(!::GetFileSizeEx(m_fileHandle, &size) || size.QuadPart == 0)
+            return false;
+        m_size = uint64_t(size.QuadPart);
+        // PAGE_WRITECOPY: дʱŸƸҳ, ļֲ
+        m_mappingHandle = ::CreateFileMappingA(m_fileHandle, nullptr, PAGE_WRITECOPY, 0, 0, nullptr);
+        if(!m_mappingHandle)
+            return false;
+        m_base = static_cast<uint8_t*>(::MapViewOfFile(m_mappingHandle, FILE_MAP_COPY, 0, 0, 0));
+        return m_base != nullptr;
+    }
+    void TextureFile::_unmap()
+    {
+        if(m_base)
+            ::UnmapViewOfFile(m_base);
+        if(m_mappingHandle)
+            ::CloseHandle(m_mappingHandle);
+        if(m_fileHandle)
+            ::CloseHandle(m_fileHandle);
+        m_base = nullptr;
+        m_mappingHandle = m_fileHandle = nullptr;
+    }
+#else
+    bool TextureFile::_map(const char* path)
+    {
+        const auto fd = ::open(path, O_RDONLY);
+        if(fd < 0)
+            return false;
+        struct stat st;
+        if(::fstat(fd, &st) != 0 || st.st_size == 0)
+        {
+            ::close(fd);
+            return false;
+        }
+        // MAP_PRIVATE: дʱŸƸҳ, ļֲ
+        auto base = ::mmap(nullptr, size_t(st.st_size), PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+        ::close(fd);
+        if(base == MAP_FAILED)
+            return false;
+        m_base = static_cast<uint8_t*>(base);
+        m_size = uint64_t(st.st_size);
+        return true;
+    }
+    void TextureFile::_unmap()
+    {
+        if(m_base)
+            ::munmap(m_base, size_t(m_size));
+        m_base = nullptr;
+    }
+#endif
+}//ns rl
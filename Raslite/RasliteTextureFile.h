@@ -0,0 +1,88 @@
+#ifndef RASLITE_TEXTURE_FILE_H
+#define RASLITE_TEXTURE_FILE_H
+#include "RasliteCommon.h"
+#include <memory>
+namespace rl {
+    class Texture2D;
+    ///////////////////////////////////////////////////////////
+    // TextureFile: Rasliteеtextureļ(.rltex)
+    //  - mipѰSurfaceĲֺFormat, ʱmip
+    //  - open()ļcopy-on-writeʽӳڴ, Texture2Dֱʹӳڴ
+    //  ļ: Header | mip 0 | mip 1 | ..., ÿmipʼλðMIP_ALIGNMENT
+    ///////////////////////////////////////////////////////////
+    class TextureFile
+    {
+    public:
+        static constexpr uint32_t MAGIC         = 0x58544C52; // "RLTX"
+        static constexpr uint32_t VERSION       = 1;
+        static constexpr uint32_t MAX_MIP_LEVEL = 32;
+        static constexpr uint32_t MIP_ALIGNMENT = 64;
+        struct Header
+        {
+            uint32_t magic;
+            uint32_t version;
+            uint32_t format;    // Formatֵ; ıFormat˳ʱVERSION
+            uint32_t width;
+            uint32_t height;
+            uint32_t mipLevels; // Texture2Dһ, iΪ(width >> i) x (height >> i)
+            uint32_t reserved[2];
+            uint64_t mipOffsets[MAX_MIP_LEVEL]; // ļͷ, in bytes
+        };
+    public:
+        ~TextureFile();
+        TextureFile(const TextureFile&) = delete;
+        TextureFile& operator=(const TextureFile&) = delete;
+        // ļڻʽʱnullptr
+        static std::shared_ptr<TextureFile> open(const char* path);
+        // texmipдpath; ʧܷfalse
+        static bool save(const char* path, const Texture2D& tex);
+    public:
+        Format   getFormat  ()                      const;
+        uint32_t getWidth   (uint32_t mipLevel = 0) const;
+        uint32_t getHeight  (uint32_t mipLevel = 0) const;
+        uint32_t getMipLevel()                      const;
+        // ӳڴиümip; дֻı䱾ڵĸ, дļ
+        Float*   getMipData (uint32_t mipLevel)     const;
+    private:
+        TextureFile() = default;
+        bool _map(const char* path);
+        void _unmap();
+    private:
+        const Header* m_header = nullptr;
+        uint8_t*      m_base   = nullptr;
+        uint64_t      m_size   = 0;
+#ifdef _WIN32
+        void*         m_fileHandle    = nullptr;
+        void*         m_mappingHandle = nullptr;
+#endif
+    };
+}//ns rl
+/////////////////////////////////////////////////////////////////
+// 
+/////////////////////////////////////////////////////////////////
+namespace rl {
+    inline Format TextureFile::getFormat() const
+    {
+        return Format(m_header->format);
+    }
+    inline uint32_t TextureFile::getWidth(uint32_t mipLevel) const
+    {
+        assert(mipLevel < m_header->mipLevels);
+        return m_header->width >> mipLevel;
+    }
+    inline uint32_t TextureFile::getHeight(uint32_t mipLevel) const
+    {
+        assert(mipLevel < m_header->mipLevels);
+        return m_header->height >> mipLevel;
+    }
+    inline uint32_t TextureFile::getMipLevel() const
+    {
+        return m_header->mipLevels;
+    }
+    inline Float* TextureFile::getMipData(uint32_t mipLevel) const
+    {
+        assert(mipLevel < m_header->mipLevels);
+        return reinterpret_cast<Float*>(m_base + m_header->mipOffsets[mipLevel]);
+    }
+}//ns rl
+#endif //RASLITE_TEXTURE_FILE_H
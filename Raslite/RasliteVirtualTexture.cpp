@@ -0,0 +1,196 @@
+#include "RasliteVirtualTexture.h"
+#include <cstring>
+
+namespace rl {
+    VirtualTexture::VirtualTexture(const Desc& desc)
+        : Texture(TextureType::VIRTUAL_TEXTURE_2D)
+        , m_format(desc.format)
+        , m_floatCount(float_count(desc.format))
+        , m_pageSize(desc.pageSize)
+        , m_pageShift(0)
+        , m_pageFloats(desc.pageSize * desc.pageSize * float_count(desc.format))
+        , m_loader(desc.loader)
+    {
+        assert(desc.width > 0 && desc.height > 0);
+        assert(Format::R32_FLOAT <= desc.format && desc.format <= Format::R32G32B32A32_FLOAT);
+        assert(desc.pageSize > 0 && (desc.pageSize & (desc.pageSize - 1)) == 0 && "pageSizeΪ2!");
+        assert(m_loader);
+        while((1u << m_pageShift) < m_pageSize)
+            ++m_pageShift;
+        // Texture2Dһ: ߼0ʱֹͣ
+        {
+            auto w = desc.width, h = desc.height;
+            do
+            {
+                Level level;
+                level.width  = w;
+                level.height = h;
+                level.pagesX = (w + m_pageSize - 1) >> m_pageShift;
+                level.pagesY = (h + m_pageSize - 1) >> m_pageShift;
+                level.pages.reset(new PageEntry[level.pagesX * level.pagesY]);
+                m_levels.push_back(std::move(level));
+                if(m_levels.size() == desc.mipLevels)
+                    break;
+                w >>= 1; h >>= 1;
+            } while(w && h);
+        }
+        m_pool.reset(new Float[size_t(desc.cacheCapacity) * m_pageFloats]);
+        m_slots.resize(desc.cacheCapacity);
+        // ֵһͬزפ
+        {
+            const auto lvl = uint32_t(m_levels.size() - 1);
+            const auto& level = m_levels[lvl];
+            assert(level.pagesX * level.pagesY < desc.cacheCapacity && "cacheCapacity̫С!");
+            std::unique_ptr<Float[]> data(new Float[m_pageFloats]);
+            for(uint32_t y = 0; y < level.pagesY; ++y)
+            {
+                for(uint32_t x = 0; x < level.pagesX; ++x)
+                {
+                    const PageKey key = { lvl, x, y };
+                    this->_loadPage(key, data.get());
+                    this->_commit(key, data.get(), true);
+                }
+            }
+        }
+        m_loaderThread = std::thread(&VirtualTexture::_loaderMain, this);
+    }
+    VirtualTexture::~VirtualTexture()
+    {
+        {
+            std::lock_guard<std::mutex> guard(m_loaderMutex);
+            m_quit = true;
+        }
+        m_loaderCond.notify_all();
+        m_loaderThread.join();
+    }
+    ColorValue VirtualTexture::sample(Float u, Float v, Float w/*δʹ*/, const Vec4 *xGradient, const Vec4 *yGradient, const uint32_t* samplerStates)
+    {
+        return ColorValue::BLACK;
+    }
+    void VirtualTexture::update()
+    {
+        // 1. ύѼصpage
+        std::vector<LoadedPage> loaded;
+        {
+            std::lock_guard<std::mutex> guard(m_loaderMutex);
+            loaded.swap(m_loadedPages);
+        }
+        for(auto& page : loaded)
+        {
+            this->_commit(page.key, page.data.get(), false);
+            --m_pendingCount;
+        }
+        // 2. µ󽻸loader߳: ֵmip, Ա㾡п˻ص
+        std::vector<PageKey> requests;
+        {
+            std::lock_guard<std::mutex> guard(m_requestMutex);
+            requests.swap(m_requests);
+        }
+        if(!requests.empty())
+        {
+            std::stable_sort(requests.begin(), requests.end(), [](const PageKey& lhs, const PageKey& rhs)
+            {
+                return lhs.level > rhs.level;
+            });
+            {
+                std::lock_guard<std::mutex> guard(m_loaderMutex);
+                m_loadQueue.insert(m_loadQueue.end(), requests.begin(), requests.end());
+            }
+            m_loaderCond.notify_one();
+        }
+        ++m_frame;
+    }
+    void VirtualTexture::_request(const PageKey& key) const
+    {
+        auto expected = uint8_t(NON_RESIDENT);
+        // ֻеһ߸
+        if(!this->_page(key).state.compare_exchange_strong(expected, uint8_t(REQUESTED)))
+            return;
+        std::lock_guard<std::mutex> guard(m_requestMutex);
+        m_requests.push_back(key);
+        ++m_pendingCount;
+    }
+    void VirtualTexture::_loadPage(const PageKey& key, Float* dataOut) const
+    {
+        const auto& level = m_levels[key.level];
+        const auto left = key.x << m_pageShift, top = key.y << m_pageShift;
+        const Rect rect(left, top, std::min(level.width, left + m_pageSize), std::min(level.height, top + m_pageSize));
+        m_loader(key.level, rect, dataOut, m_pageSize * m_floatCount);
+    }
+    int32_t VirtualTexture::_allocateSlot()
+    {
+        // LRU: ȿslot, ̭δķǳפslot
+        // ֡pageڵǰĹ, ̭: һֻ֡, cache߼ػ뻻
+        const auto frame = m_frame.load(std::memory_order_relaxed);
+        int32_t victim = -1;
+        uint32_t oldest = ~0u;
+        for(uint32_t i = 0; i < m_slots.size(); ++i)
+        {
+            const auto& slot = m_slots[i];
+            if(!slot.used)
+                return int32_t(i);
+            if(slot.pinned)
+                continue;
+            const auto lastUsed = this->_page(slot.key).lastUsed.load(std::memory_order_relaxed);
+            if(lastUsed >= frame)
+                continue;
+            if(lastUsed < oldest)
+            {
+                oldest = lastUsed;
+                victim = int32_t(i);
+            }
+        }
+        if(victim >= 0)
+        {
+            auto& page = this->_page(m_slots[victim].key);
+            page.state.store(NON_RESIDENT, std::memory_order_release);
+            page.slot = -1;
+            m_slots[victim].used = false;
+            --m_residentCount;
+        }
+        return victim;
+    }
+    void VirtualTexture::_commit(const PageKey& key, const Float* data, bool pinned)
+    {
+        auto& page = this->_page(key);
+        const auto sloti = this->_allocateSlot();
+        assert((sloti >= 0 || !pinned) && "cacheCapacity̫С!");
+        if(sloti < 0)
+        {// ֡Ĺռcache: , ֮ٱʱ
+            page.state.store(NON_RESIDENT, std::memory_order_release);
+            return;
+        }
+        std::memcpy(&m_pool[size_t(sloti) * m_pageFloats], data, sizeof(Float) * m_pageFloats);
+        m_slots[sloti].key    = key;
+        m_slots[sloti].used   = true;
+        m_slots[sloti].pinned = pinned;
+        ++m_residentCount;
+
+        page.slot = sloti;
+        page.lastUsed.store(m_frame.load(), std::memory_order_relaxed);
+        page.state.store(RESIDENT, std::memory_order_release);
+    }
+    void VirtualTexture::_loaderMain()
+    {
+        for(;;)
+        {
+            PageKey key;
+            {
+                std::unique_lock<std::mutex> lock(m_loaderMutex);
+                m_loaderCond.wait(lock, [this] { return m_quit || !m_loadQueue.empty(); });
+                if(m_quit)
+                    return;
+                key = m_loadQueue.front();
+                m_loadQueue.pop_front();
+            }
+            LoadedPage page;
+            page.key = key;
+            page.data.reset(new Float[m_pageFloats]);
+            this->_loadPage(key, page.data.get());
+            {
+                std::lock_guard<std::mutex> guard(m_loaderMutex);
+                m_loadedPages.push_back(std::move(page));
+            }
+        }
+    }
+}//ns rl
@@ -0,0 +1,188 @@
+#ifndef RASLITE_VIRTUAL_TEXTURE_H
+#define RASLITE_VIRTUAL_TEXTURE_H
+#include "RasliteData.h"
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+namespace rl {
+    ///////////////////////////////////////////////////////////
+    // VirtualTexture: ÿmipзΪpageSize x pageSizepage, ֻбpageųפڴ
+    //  - ʱpageפ, ¼˻صĳפĽϴmip
+    //  - loader̵߳Desc::loaderpage
+    //  - update()аѼغõpage̶LRU cache; ֡pageᱻ̭
+    //  ֵһmipǳפ, ֤п˻ص
+    ///////////////////////////////////////////////////////////
+    class VirtualTexture: public Texture
+    {
+    public:
+        // mipLevelrectΧtexelдdataOut, мpitchFloat; loader߳е
+        using PageLoader = std::function<void(uint32_t mipLevel, const Rect& rect, Float* dataOut, uint32_t pitch)>;
+        struct Desc
+        {
+            uint32_t   width;
+            uint32_t   height;
+            uint32_t   mipLevels     = 0;   // 0: ȫmip
+            Format     format;
+            uint32_t   pageSize      = 128; // Ϊ2
+            uint32_t   cacheCapacity = 256; // ೣפpage
+            PageLoader loader;
+        };
+    public:
+        VirtualTexture(const Desc& desc);
+        virtual ~VirtualTexture();
+        virtual ColorValue sample(Float u, Float v, Float w, const Vec4 *xGradient, const Vec4 *yGradient, const uint32_t* samplerStates) override;
+    public:
+        // ֡(draw)֮, ͬʱ:
+        // ύѼصpage, µpage(ֵmip)loader߳
+        void update();
+        // Ƿδפpage
+        bool hasPendingPages() const;
+        // (x,y)texel; pageפʱ¼, ؽϴmipжӦtexel
+        const Float* getTexel(uint32_t mipLevel, int32_t x, int32_t y) const;
+
+        uint32_t getMipLevel  ()                      const;
+        Format   getFormat    ()                      const;
+        uint32_t getWidth     (uint32_t mipLevel = 0) const;
+        uint32_t getHeight    (uint32_t mipLevel = 0) const;
+        uint32_t getPageSize  ()                      const;
+        uint32_t getResidentPageCount()               const;
+    private:
+        enum PageState: uint8_t
+        {
+            NON_RESIDENT,
+            REQUESTED,
+            RESIDENT,
+        };
+        struct PageEntry
+        {
+            std::atomic<uint8_t>  state    { NON_RESIDENT };
+            std::atomic<uint32_t> lastUsed { 0 };  // һα֡
+            int32_t               slot = -1;
+        };
+        struct Level
+        {
+            uint32_t width, height;
+            uint32_t pagesX, pagesY;
+            std::unique_ptr<PageEntry[]> pages;
+        };
+        struct PageKey
+        {
+            uint32_t level, x, y;
+        };
+        struct Slot
+        {
+            PageKey key;
+            bool    used   = false;
+            bool    pinned = false;
+        };
+        struct LoadedPage
+        {
+            PageKey                  key;
+            std::unique_ptr<Float[]> data;
+        };
+    private:
+        PageEntry& _page(const PageKey& key) const;
+        void       _request(const PageKey& key) const;
+        void       _loadPage(const PageKey& key, Float* dataOut) const;
+        int32_t    _allocateSlot();
+        void       _commit(const PageKey& key, const Float* data, bool pinned);
+        void       _loaderMain();
+    private:
+        Format             m_format;
+        uint32_t           m_floatCount;
+        uint32_t           m_pageSize;
+        uint32_t           m_pageShift;
+        uint32_t           m_pageFloats;
+        PageLoader         m_loader;
+        std::vector<Level> m_levels;
+
+        // page cache: cacheCapacitypageĴ洢
+        std::unique_ptr<Float[]> m_pool;
+        std::vector<Slot>        m_slots;
+        uint32_t                 m_residentCount = 0;
+        std::atomic<uint32_t>    m_frame { 1 };
+        mutable std::atomic<uint32_t> m_pendingCount { 0 };
+
+        // ̼߳¼
+        mutable std::mutex           m_requestMutex;
+        mutable std::vector<PageKey> m_requests;
+        // loader߳
+        std::mutex              m_loaderMutex;
+        std::condition_variable m_loaderCond;
+        std::deque<PageKey>     m_loadQueue;
+        std::vector<LoadedPage> m_loadedPages;
+        bool                    m_quit = false;
+        std::thread             m_loaderThread;
+    };
+}//ns rl
+/////////////////////////////////////////////////////////////////
+// 
+/////////////////////////////////////////////////////////////////
+namespace rl {
+    inline uint32_t VirtualTexture::getMipLevel() const
+    {
+        return uint32_t(m_levels.size());
+    }
+    inline Format VirtualTexture::getFormat() const
+    {
+        return m_format;
+    }
+    inline uint32_t VirtualTexture::getWidth(uint32_t mipLevel) const
+    {
+        assert(mipLevel < m_levels.size());
+        return m_levels[mipLevel].width;
+    }
+    inline uint32_t VirtualTexture::getHeight(uint32_t mipLevel) const
+    {
+        assert(mipLevel < m_levels.size());
+        return m_levels[mipLevel].height;
+    }
+    inline uint32_t VirtualTexture::getPageSize() const
+    {
+        return m_pageSize;
+    }
+    inline uint32_t VirtualTexture::getResidentPageCount() const
+    {
+        return m_residentCount;
+    }
+    inline bool VirtualTexture::hasPendingPages() const
+    {
+        return m_pendingCount.load() != 0;
+    }
+    inline VirtualTexture::PageEntry& VirtualTexture::_page(const PageKey& key) const
+    {
+        auto& level = m_levels[key.level];
+        return level.pages[key.y * level.pagesX + key.x];
+    }
+    inline const Float* VirtualTexture::getTexel(uint32_t mipLevel, int32_t x, int32_t y) const
+    {
+        assert(mipLevel < m_levels.size());
+        const auto frame = m_frame.load(std::memory_order_relaxed);
+        for(auto lvl = mipLevel; ; ++lvl, x >>= 1, y >>= 1)
+        {
+            assert(lvl < m_levels.size() && "ֵmip볣פ!");
+            const auto& level = m_levels[lvl];
+            // ߴʱ, ϴmipԽ
+            x = std::min(x, int32_t(level.width)  - 1);
+            y = std::min(y, int32_t(level.height) - 1);
+            const PageKey key = { lvl, uint32_t(x) >> m_pageShift, uint32_t(y) >> m_pageShift };
+            auto& page = this->_page(key);
+            const auto state = page.state.load(std::memory_order_acquire);
+            if(state == RESIDENT)
+            {
+                if(page.lastUsed.load(std::memory_order_relaxed) != frame)
+                    page.lastUsed.store(frame, std::memory_order_relaxed);
+                const auto mask = int32_t(m_pageSize - 1);
+                return &m_pool[page.slot * m_pageFloats + ((y & mask) * m_pageSize + (x & mask)) * m_floatCount];
+            }
+            if(state == NON_RESIDENT)
+                this->_request(key);
+        }
+    }
+}//ns rl
+#endif //RASLITE_VIRTUAL_TEXTURE_H